@@ -42,7 +42,7 @@ static void PrintTime(uint64 t, const TimeScale &timeScale)
 }
 
 //Constructor
-Prober::Prober(const FileSystem::Path &path) : path(path), input(path)
+Prober::Prober(const FileSystem::Path &path, bool memoryMapped) : path(path), input(OpenInputStream(path, memoryMapped))
 {
 	this->packetCounter = 0;
 	this->totalFrameCounter = 0;
@@ -396,7 +396,7 @@ void Prober::PrintStreamInfo()
 void Prober::ProcessPacket()
 {
 	stdOut << "Packet #" << this->packetCounter << endl
-		   << "Input byte offset: " << this->input.QueryCurrentOffset() << " / " << this->input.QuerySize() << endl
+		   << "Input byte offset: " << this->input->QueryCurrentOffset() << " / " << this->input->QuerySize() << endl
 		   << endl;
 
 	DecoderContext *const& refpDecoder = this->demuxer->GetStream(this->currentPacket->GetStreamIndex())->GetDecoderContext();
@@ -410,7 +410,7 @@ void Prober::ProcessPacket()
 void Prober::Probe(bool headerOnly)
 {
 	//first find format
-	this->format = FormatRegistry::Instance().ProbeFormat(this->input);
+	this->format = FormatRegistry::Instance().ProbeFormat(*this->input);
 	if(!this->format)
 	{
 		//second try by extension
@@ -431,7 +431,7 @@ void Prober::Probe(bool headerOnly)
 		   << "Container format: " << this->format->GetName() << endl;
 
 	//get demuxer
-	this->demuxer = this->format->CreateDemuxer(this->input);
+	this->demuxer = this->format->CreateDemuxer(*this->input);
 	if(this->demuxer.IsNull())
 	{
 		stdErr << "No demuxer is available for the input format." << endl;
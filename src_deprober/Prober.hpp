@@ -18,6 +18,8 @@
  */
 #pragma once
 #include <StdXX.hpp>
+//Local
+#include "../src_transcoder/MappedFileInputStream.hpp"
 //Namespaces
 using namespace StdXX;
 using namespace StdXX::Multimedia;
@@ -45,7 +47,7 @@ class Prober
 {
 public:
 	//Constructor
-	Prober(const FileSystem::Path &refPath);
+	Prober(const FileSystem::Path &refPath, bool memoryMapped);
 
 	//Methods
 	void Probe(bool headerOnly);
@@ -53,7 +55,7 @@ public:
 private:
 	//Members
 	const FileSystem::Path &path;
-	FileInputStream input;
+	UniquePointer<SeekableInputStream> input;
 	const ContainerFormat *format;
 	UniquePointer<Demuxer> demuxer;
 	UniquePointer<IPacket> currentPacket;
@@ -18,47 +18,110 @@
  */
 //Local
 #include "Prober.hpp"
+#include <chrono>
+
+//Local functions
+static bool ReadAllPackets(const FileSystem::Path& path, bool memoryMapped, uint64& nPackets, uint64& nBytes)
+{
+	UniquePointer<SeekableInputStream> input = OpenInputStream(path, memoryMapped);
+	const ContainerFormat* format = FormatRegistry::Instance().ProbeFormat(*input);
+	if(!format)
+		format = FormatRegistry::Instance().FindFormatByFileExtension(path.GetFileExtension());
+	if(!format)
+		return false;
+	UniquePointer<Demuxer> demuxer = format->CreateDemuxer(*input);
+	if(demuxer.IsNull())
+		return false;
+
+	demuxer->ReadHeader();
+
+	nPackets = 0;
+	nBytes = 0;
+	while(true)
+	{
+		UniquePointer<IPacket> packet = demuxer->ReadFrame();
+		if(packet.IsNull())
+			break;
+		nPackets++;
+		nBytes += packet->GetSize();
+	}
+
+	return true;
+}
+
+static bool BenchmarkPacketReading(const FileSystem::Path& path)
+{
+	uint64 nPackets, nBytes;
+	//warm up the page cache so that both streams read from memory
+	if(!ReadAllPackets(path, false, nPackets, nBytes))
+	{
+		stdErr << u8"Input file can't be demuxed." << endl;
+		return false;
+	}
+
+	for(bool memoryMapped : {false, true})
+	{
+		auto start = std::chrono::steady_clock::now();
+		ReadAllPackets(path, memoryMapped, nPackets, nBytes);
+		float64 seconds = std::chrono::duration<float64>(std::chrono::steady_clock::now() - start).count();
+
+		stdOut << (memoryMapped ? u8"MappedFileInputStream: " : u8"FileInputStream: ") << nPackets << u8" packets, " << nBytes << u8" bytes in "
+			<< seconds << u8" s (" << String::FormatBinaryPrefixed(uint64(nBytes / seconds), u8"B") << u8"/s)" << endl;
+	}
+
+	return true;
+}
 
 int32 Main(const String &programName, const FixedArray<String> &args)
 {
 	bool headerOnly = false;
+	bool memoryMapped = false;
+	bool readBenchmark = false;
+
+	for(uint32 i = 0; i + 1 < args.GetNumberOfElements(); i++)
+	{
+		if(args[i] == u8"-header")
+			headerOnly = true;
+		else if(args[i] == u8"-mmap")
+			memoryMapped = true;
+		else if(args[i] == u8"-readbench")
+			readBenchmark = true;
+		else
+			NOT_IMPLEMENTED_ERROR;
+	}
 
-	switch(args.GetNumberOfElements())
+	if(args.GetNumberOfElements() >= 1)
 	{
-		case 2:
-			if(args[0] == u8"-header")
-				headerOnly = true;
-			else
-				NOT_IMPLEMENTED_ERROR;
-			//fall through
-		case 1:
+		FileSystem::Path path = FileSystem::FileSystemsManager::Instance().OSFileSystem().FromNativePath(args[args.GetNumberOfElements()-1]);
+		FileSystem::File file(path);
+
+		if(!file.Exists())
+		{
+			stdErr << u8"Input file doesn't exist." << endl;
+			return EXIT_FAILURE;
+		}
+		if(file.Type() == FileSystem::FileType::Directory)
 		{
-			FileSystem::Path path = FileSystem::FileSystemsManager::Instance().OSFileSystem().FromNativePath(args[args.GetNumberOfElements()-1]);
-			FileSystem::File file(path);
-
-			if(!file.Exists())
-			{
-				stdErr << u8"Input file doesn't exist." << endl;
-				return EXIT_FAILURE;
-			}
-			if(file.Type() == FileSystem::FileType::Directory)
-			{
-				stdErr << u8"Input file is a directory." << endl;
-				return EXIT_FAILURE;
-			}
-
-			Prober prober(path);
-
-			prober.Probe(headerOnly);
-			return EXIT_SUCCESS;
+			stdErr << u8"Input file is a directory." << endl;
+			return EXIT_FAILURE;
 		}
+
+		if(readBenchmark)
+			return BenchmarkPacketReading(path) ? EXIT_SUCCESS : EXIT_FAILURE;
+
+		Prober prober(path, memoryMapped);
+
+		prober.Probe(headerOnly);
+		return EXIT_SUCCESS;
 	}
 
 	stdOut << u8"deprober is a tool for testing demuxing and decoding using Std++." << endl
 		   << u8"It is not designed to do anything useful but aid in debugging." << endl << endl
 		   << u8"usage: deprober [options] container" << endl
 			<< u8"options can be:" << endl
-			<< u8"-header\t\tdisplay header info only. Skip payload..." << endl;
+			<< u8"-header\t\tdisplay header info only. Skip payload..." << endl
+			<< u8"-mmap\t\tread the container through a memory mapping" << endl
+			<< u8"-readbench\tcompare the packet read throughput of regular and memory mapped reads. Nothing is decoded" << endl;
 
 	return EXIT_SUCCESS;
 }
\ No newline at end of file
@@ -0,0 +1,281 @@
+/*
+ * Copyright (c) 2023-2024 Amir Czwink (amir130@hotmail.de)
+ *
+ * This file is part of AVTools.
+ *
+ * AVTools is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * AVTools is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with AVTools.  If not, see <http://www.gnu.org/licenses/>.
+ */
+//Class Header
+#include "AudioRemixNode.hpp"
+//Local
+#include "AudioSampleKernels.hpp"
+
+//Constants
+static const float32 c_minus3dB = 0.70710678f;
+
+//Local functions
+static bool FindChannel(const AudioSampleFormat& format, SpeakerPosition speaker, uint8& index)
+{
+    for(uint8 i = 0; i < format.nChannels; i++)
+    {
+        if(format.channels[i].speaker == speaker)
+        {
+            index = i;
+            return true;
+        }
+    }
+    return false;
+}
+
+//Constructor
+AudioRemixNode::AudioRemixNode(const DecodingParameters& sourceParameters, const AudioSampleFormat& targetFormat, const DynamicArray<float32>& matrix)
+    : sourceParameters(sourceParameters), targetFormat(targetFormat.nChannels, AudioSampleType::Float, true), matrix(matrix)
+{
+    this->outputPorts.Resize(1);
+
+    const AudioSampleFormat sourceFormat = *sourceParameters.audio.sampleFormat;
+    this->sourceParameters.audio.sampleFormat = AudioSampleFormat(sourceFormat.nChannels, AudioSampleType::Float, true);
+
+    if(this->matrix.IsEmpty())
+    {
+        this->matrix.Resize(targetFormat.nChannels * sourceFormat.nChannels);
+        for(uint32 i = 0; i < this->matrix.GetNumberOfElements(); i++)
+            this->matrix[i] = 0;
+
+        this->ComputeDefaultMatrix(sourceFormat, targetFormat);
+        this->Normalize();
+    }
+    ASSERT_EQUALS(targetFormat.nChannels * sourceFormat.nChannels, this->matrix.GetNumberOfElements());
+}
+
+//Public methods
+bool AudioRemixNode::CanProcess() const
+{
+    return this->IsDataAvailable();
+}
+
+Node* AudioRemixNode::Fuse(const Node& next) const
+{
+    const AudioRemixNode* nextRemixer = dynamic_cast<const AudioRemixNode*>(&next);
+    if(nextRemixer == nullptr)
+        return nullptr;
+
+    /*
+     * Mixing twice is the same as mixing once with the product of both matrices, but rounds differently unless the second mix only selects
+     * channels. Then every fused row is a row of this matrix and is computed with exactly the same operations.
+     */
+    if(!nextRemixer->IsSelection())
+        return nullptr;
+
+    const uint8 nInputChannels = this->sourceParameters.audio.sampleFormat->nChannels;
+    const uint8 nIntermediateChannels = this->targetFormat.nChannels;
+    const uint8 nOutputChannels = nextRemixer->targetFormat.nChannels;
+
+    DynamicArray<float32> matrix;
+    matrix.Resize(uint32(nOutputChannels) * nInputChannels);
+    for(uint8 o = 0; o < nOutputChannels; o++)
+    {
+        for(uint8 i = 0; i < nInputChannels; i++)
+        {
+            float32 weight = 0;
+            for(uint8 k = 0; k < nIntermediateChannels; k++)
+                weight += nextRemixer->matrix[o * nIntermediateChannels + k] * this->matrix[k * nInputChannels + i];
+            matrix[o * nInputChannels + i] = weight;
+        }
+    }
+
+    return new AudioRemixNode(this->sourceParameters, nextRemixer->targetFormat, matrix);
+}
+
+String AudioRemixNode::GetName() const
+{
+    return u8"AudioRemixNode";
+}
+
+PortFormat AudioRemixNode::GetInputFormat(uint32 inputPortNumber) const
+{
+    return {
+        .packetsOrFrames = false,
+        .frameParameters = this->sourceParameters,
+    };
+}
+
+PortFormat AudioRemixNode::GetOutputFormat(uint32 outputPortNumber) const
+{
+    DecodingParameters codingParameters = this->sourceParameters;
+    codingParameters.audio.sampleFormat = this->targetFormat;
+    return {
+        .packetsOrFrames = false,
+        .frameParameters = codingParameters,
+    };
+}
+
+bool AudioRemixNode::IsIdentity() const
+{
+    const uint8 nChannels = this->targetFormat.nChannels;
+    if(!(*this->sourceParameters.audio.sampleFormat == this->targetFormat))
+        return false;
+
+    for(uint8 o = 0; o < nChannels; o++)
+    {
+        for(uint8 i = 0; i < nChannels; i++)
+        {
+            if(this->matrix[o * nChannels + i] != ((o == i) ? 1 : 0))
+                return false;
+        }
+    }
+    return true;
+}
+
+void AudioRemixNode::ProcessNextEntity()
+{
+    NodeData data = this->GetNextData();
+    const AudioBuffer* sourceBuffer = data.GetFrame().GetAudioBuffer();
+    const uint32 nSamples = sourceBuffer->GetNumberOfSamplesPerChannel();
+    const uint8 nInputChannels = this->sourceParameters.audio.sampleFormat->nChannels;
+
+    FramePool& framePool = this->Context().framePool;
+    NodeData outputData;
+    framePool.AcquireAudioFrame(outputData, this->targetFormat, nSamples);
+    outputData.frame->pts = data.GetFrame().pts;
+
+    //one vectorized pass over the frame per nonzero weight
+    const auto multiplyAccumulate = AudioSampleKernels::Get().multiplyAccumulate;
+    AudioBuffer* targetBuffer = outputData.frame->GetAudioBuffer();
+    for(uint8 o = 0; o < this->targetFormat.nChannels; o++)
+    {
+        float32* target = static_cast<float32*>(targetBuffer->GetPlane(o));
+        MemZero(target, nSamples * sizeof(float32));
+
+        for(uint8 i = 0; i < nInputChannels; i++)
+        {
+            float32 weight = this->Weight(o, i);
+            if(weight != 0)
+                multiplyAccumulate(static_cast<const float32*>(sourceBuffer->GetPlane(i)), weight, target, nSamples);
+        }
+    }
+
+    this->Emit(0, Move(outputData));
+}
+
+//Private methods
+bool AudioRemixNode::IsSelection() const
+{
+    const uint8 nInputChannels = this->sourceParameters.audio.sampleFormat->nChannels;
+    for(uint8 o = 0; o < this->targetFormat.nChannels; o++)
+    {
+        uint8 nNonZero = 0;
+        for(uint8 i = 0; i < nInputChannels; i++)
+        {
+            const float32 weight = this->matrix[o * nInputChannels + i];
+            if(weight == 0)
+                continue;
+            if((weight != 1) || (++nNonZero > 1))
+                return false;
+        }
+    }
+    return true;
+}
+
+void AudioRemixNode::ComputeDefaultMatrix(const AudioSampleFormat& sourceFormat, const AudioSampleFormat& targetFormat)
+{
+    uint8 frontLeft, frontRight, frontCenter;
+    const bool hasStereoPair = FindChannel(targetFormat, SpeakerPosition::Front_Left, frontLeft) && FindChannel(targetFormat, SpeakerPosition::Front_Right, frontRight);
+    const bool hasFrontCenter = FindChannel(targetFormat, SpeakerPosition::Front_Center, frontCenter);
+
+    bool anyMapped = false;
+    for(uint8 i = 0; i < sourceFormat.nChannels; i++)
+    {
+        const SpeakerPosition speaker = sourceFormat.channels[i].speaker;
+
+        uint8 o;
+        if(FindChannel(targetFormat, speaker, o))
+        {
+            this->Weight(o, i) = 1;
+            anyMapped = true;
+            continue;
+        }
+
+        switch(speaker)
+        {
+            case SpeakerPosition::Front_Center:
+                if(hasStereoPair)
+                {
+                    this->Weight(frontLeft, i) = c_minus3dB;
+                    this->Weight(frontRight, i) = c_minus3dB;
+                }
+                break;
+            case SpeakerPosition::Front_Left:
+            case SpeakerPosition::Front_Right:
+                //down to mono
+                if(hasFrontCenter)
+                    this->Weight(frontCenter, i) = c_minus3dB;
+                break;
+            case SpeakerPosition::Side_Left:
+            case SpeakerPosition::Back_Left:
+                if(hasStereoPair)
+                    this->Weight(frontLeft, i) = c_minus3dB;
+                else if(hasFrontCenter)
+                    this->Weight(frontCenter, i) = 0.5f;
+                break;
+            case SpeakerPosition::Side_Right:
+            case SpeakerPosition::Back_Right:
+                if(hasStereoPair)
+                    this->Weight(frontRight, i) = c_minus3dB;
+                else if(hasFrontCenter)
+                    this->Weight(frontCenter, i) = 0.5f;
+                break;
+            case SpeakerPosition::LowFrequency:
+                break; //dropped, as most downmixes do
+            default:
+                //no rule for this position, spread it over the front
+                if(hasStereoPair)
+                {
+                    this->Weight(frontLeft, i) = 0.5f;
+                    this->Weight(frontRight, i) = 0.5f;
+                }
+                else if(hasFrontCenter)
+                    this->Weight(frontCenter, i) = c_minus3dB;
+        }
+        anyMapped |= hasStereoPair || hasFrontCenter;
+    }
+
+    if(!anyMapped)
+    {
+        //the layouts have no known positions in common, map the channels by index
+        for(uint8 i = 0; i < Math::Min(sourceFormat.nChannels, targetFormat.nChannels); i++)
+            this->Weight(i, i) = 1;
+    }
+}
+
+void AudioRemixNode::Normalize()
+{
+    const uint8 nInputChannels = this->sourceParameters.audio.sampleFormat->nChannels;
+
+    float32 maxSum = 0;
+    for(uint8 o = 0; o < this->targetFormat.nChannels; o++)
+    {
+        float32 sum = 0;
+        for(uint8 i = 0; i < nInputChannels; i++)
+            sum += this->Weight(o, i);
+        maxSum = Math::Max(maxSum, sum);
+    }
+
+    //full scale on all inputs must not clip any output
+    if(maxSum > 1)
+    {
+        for(uint32 i = 0; i < this->matrix.GetNumberOfElements(); i++)
+            this->matrix[i] /= maxSum;
+    }
+}
\ No newline at end of file
@@ -0,0 +1,65 @@
+/*
+ * Copyright (c) 2023-2024 Amir Czwink (amir130@hotmail.de)
+ *
+ * This file is part of AVTools.
+ *
+ * AVTools is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * AVTools is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with AVTools.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#pragma once
+//Local
+#include "Node.hpp"
+
+/**
+ * Mixes the channels of planar float frames into a different channel layout, e.g. 5.1 down to stereo.
+ * Every output channel is a weighted sum of the input channels. The weights either come from the user or are derived from the speaker
+ * positions of both layouts (ITU-R BS.775 style downmix, rescaled so that no output channel can exceed the input range).
+ */
+class AudioRemixNode : public Node
+{
+public:
+    //Constructor
+    /**
+     * @param matrix nOutputChannels rows with one weight per input channel each. If empty, the default matrix for the speaker positions is used.
+     */
+    AudioRemixNode(const DecodingParameters& sourceParameters, const AudioSampleFormat& targetFormat, const DynamicArray<float32>& matrix);
+
+    //Methods
+    bool CanProcess() const override;
+    Node* Fuse(const Node& next) const override;
+    String GetName() const override;
+    PortFormat GetInputFormat(uint32 inputPortNumber) const override;
+    PortFormat GetOutputFormat(uint32 outputPortNumber) const override;
+    bool IsIdentity() const override;
+    void ProcessNextEntity() override;
+
+private:
+    //Members
+    DecodingParameters sourceParameters;
+    AudioSampleFormat targetFormat;
+    DynamicArray<float32> matrix;
+
+    //Methods
+    /**
+     * Whether every output channel is either silent or a copy of exactly one input channel.
+     */
+    bool IsSelection() const;
+    void ComputeDefaultMatrix(const AudioSampleFormat& sourceFormat, const AudioSampleFormat& targetFormat);
+    void Normalize();
+
+    //Inline
+    inline float32& Weight(uint8 outputChannel, uint8 inputChannel)
+    {
+        return this->matrix[outputChannel * this->sourceParameters.audio.sampleFormat->nChannels + inputChannel];
+    }
+};
\ No newline at end of file
@@ -18,6 +18,7 @@
  */
 //Local
 #include "Node.hpp"
+#include "AudioSampleConverter.hpp"
 
 class AudioResampleNode : public Node
 {
@@ -27,7 +28,6 @@ public:
 			sourceParameters(sourceParameters), targetFormat(targetFormat)
 	{
 		this->outputPorts.Resize(1);
-		this->outputPorts[0] = nullptr;
 	}
 
 	bool CanProcess() const override
@@ -35,6 +35,33 @@ public:
 		return this->IsDataAvailable();
 	}
 
+	Node* Fuse(const Node& next) const override
+	{
+		const AudioResampleNode* nextResampler = dynamic_cast<const AudioResampleNode*>(&next);
+		if(nextResampler == nullptr)
+			return nullptr;
+
+		/*
+		 * Converting in one step gives the same samples only if the intermediate format neither rounds nor clips, i.e. it has the source or
+		 * target sample type anyway (then one of the steps only changes the layout) or it widens 16 bit integers exactly.
+		 */
+		const AudioSampleFormat& sourceFormat = *this->sourceParameters.audio.sampleFormat;
+		const AudioSampleFormat& targetFormat = nextResampler->targetFormat;
+		if(!AudioSampleConverter::IsSupported(sourceFormat, this->targetFormat) || !AudioSampleConverter::IsSupported(this->targetFormat, targetFormat) || !AudioSampleConverter::IsSupported(sourceFormat, targetFormat))
+			return nullptr;
+
+		const AudioSampleType intermediateType = this->targetFormat.sampleType;
+		const bool widens = (sourceFormat.sampleType == AudioSampleType::S16) && ((intermediateType == AudioSampleType::S32) || (intermediateType == AudioSampleType::Float));
+		if((intermediateType != sourceFormat.sampleType) && (intermediateType != targetFormat.sampleType) && !widens)
+			return nullptr;
+		return new AudioResampleNode(this->sourceParameters, nextResampler->targetFormat);
+	}
+
+	String GetName() const override
+	{
+		return u8"AudioResampleNode";
+	}
+
 	PortFormat GetInputFormat(uint32 inputPortNumber) const override
 	{
 		return {
@@ -53,14 +80,30 @@ public:
 		};
 	}
 
+	bool IsIdentity() const override
+	{
+		return *this->sourceParameters.audio.sampleFormat == this->targetFormat;
+	}
+
 	void ProcessNextEntity() override
 	{
 		NodeData data = this->GetNextData();
-		auto buffer = data.frame->GetAudioBuffer()->Resample(*this->sourceParameters.audio.sampleFormat, this->targetFormat);
+		const AudioBuffer* sourceBuffer = data.GetFrame().GetAudioBuffer();
+		const AudioSampleFormat& sourceFormat = *this->sourceParameters.audio.sampleFormat;
 
 		NodeData outputData;
-		outputData.frame = new Frame(buffer);
-		this->outputPorts[0]->AddData(Move(outputData));
+		if(AudioSampleConverter::IsSupported(sourceFormat, this->targetFormat))
+		{
+			FramePool& framePool = this->Context().framePool;
+			framePool.AcquireAudioFrame(outputData, this->targetFormat, sourceBuffer->GetNumberOfSamplesPerChannel());
+
+			AudioSampleConverter::Convert(*sourceBuffer, sourceFormat, *outputData.frame->GetAudioBuffer(), this->targetFormat);
+		}
+		else
+			outputData.frame = new Frame(sourceBuffer->Resample(sourceFormat, this->targetFormat));
+		outputData.frame->pts = data.GetFrame().pts;
+
+		this->Emit(0, Move(outputData));
 	}
 
 private:
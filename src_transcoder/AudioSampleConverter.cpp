@@ -0,0 +1,230 @@
+/*
+ * Copyright (c) 2023-2024 Amir Czwink (amir130@hotmail.de)
+ *
+ * This file is part of AVTools.
+ *
+ * AVTools is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * AVTools is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with AVTools.  If not, see <http://www.gnu.org/licenses/>.
+ */
+//Class Header
+#include "AudioSampleConverter.hpp"
+//Global
+#include <type_traits>
+//Local
+#include "AudioSampleKernels.hpp"
+
+//Kernel selection
+template<typename SourceType, typename TargetType>
+static SampleConversionKernel<SourceType, TargetType> GetKernel(const AudioSampleKernels& kernels);
+
+template<> SampleConversionKernel<float32, int16> GetKernel(const AudioSampleKernels& kernels) { return kernels.floatToS16; }
+template<> SampleConversionKernel<float32, int32> GetKernel(const AudioSampleKernels& kernels) { return kernels.floatToS32; }
+template<> SampleConversionKernel<int16, float32> GetKernel(const AudioSampleKernels& kernels) { return kernels.s16ToFloat; }
+template<> SampleConversionKernel<int16, int32> GetKernel(const AudioSampleKernels& kernels) { return kernels.s16ToS32; }
+template<> SampleConversionKernel<int32, float32> GetKernel(const AudioSampleKernels& kernels) { return kernels.s32ToFloat; }
+template<> SampleConversionKernel<int32, int16> GetKernel(const AudioSampleKernels& kernels) { return kernels.s32ToS16; }
+
+template<typename T>
+static void CopySamples(const T* source, T* target, uint32 nSamples)
+{
+	MemCopy(target, source, nSamples * sizeof(T));
+}
+
+template<typename SourceType, typename TargetType>
+static SampleConversionKernel<SourceType, TargetType> GetConversionKernel(const AudioSampleKernels& kernels)
+{
+	if constexpr (std::is_same_v<SourceType, TargetType>)
+		return CopySamples<SourceType>;
+	else
+		return GetKernel<SourceType, TargetType>(kernels);
+}
+
+//Layout changes
+template<typename T>
+static void Deinterleave(const AudioSampleKernels& kernels, const T* source, T** planes, uint8 nChannels, uint32 nSamplesPerChannel)
+{
+	if(nChannels == 2)
+	{
+		if constexpr (sizeof(T) == 2)
+			return kernels.deinterleaveStereo16((const int16*)source, (int16*)planes[0], (int16*)planes[1], nSamplesPerChannel);
+		else
+			return kernels.deinterleaveStereo32((const uint32*)source, (uint32*)planes[0], (uint32*)planes[1], nSamplesPerChannel);
+	}
+
+	for(uint32 i = 0; i < nSamplesPerChannel; i++)
+	{
+		for(uint8 ch = 0; ch < nChannels; ch++)
+			planes[ch][i] = source[i * nChannels + ch];
+	}
+}
+
+template<typename T>
+static void Interleave(const AudioSampleKernels& kernels, const T* const* planes, T* target, uint8 nChannels, uint32 nSamplesPerChannel)
+{
+	if(nChannels == 2)
+	{
+		if constexpr (sizeof(T) == 2)
+			return kernels.interleaveStereo16((const int16*)planes[0], (const int16*)planes[1], (int16*)target, nSamplesPerChannel);
+		else
+			return kernels.interleaveStereo32((const uint32*)planes[0], (const uint32*)planes[1], (uint32*)target, nSamplesPerChannel);
+	}
+
+	for(uint32 i = 0; i < nSamplesPerChannel; i++)
+	{
+		for(uint8 ch = 0; ch < nChannels; ch++)
+			target[i * nChannels + ch] = planes[ch][i];
+	}
+}
+
+//Local functions
+template<typename SourceType, typename TargetType>
+static void ConvertSamples(const AudioBuffer& source, const AudioSampleFormat& sourceFormat, void* const* targetPlanes, const AudioSampleFormat& targetFormat)
+{
+	const AudioSampleKernels& kernels = AudioSampleKernels::Get();
+	const SampleConversionKernel<SourceType, TargetType> convert = GetConversionKernel<SourceType, TargetType>(kernels);
+
+	const uint32 nSamples = source.GetNumberOfSamplesPerChannel();
+	const uint8 nChannels = sourceFormat.nChannels;
+
+	if(sourceFormat.planar == targetFormat.planar)
+	{
+		if(sourceFormat.planar)
+		{
+			for(uint8 ch = 0; ch < nChannels; ch++)
+				convert(static_cast<const SourceType*>(source.GetPlane(ch)), static_cast<TargetType*>(targetPlanes[ch]), nSamples);
+		}
+		else
+			convert(static_cast<const SourceType*>(source.GetPlane(0)), static_cast<TargetType*>(targetPlanes[0]), nSamples * nChannels);
+		return;
+	}
+
+	//the layout changes. Convert blocks of samples into a temporary buffer and rearrange them from there
+	const uint32 c_blockSize = 4096;
+	TargetType block[c_blockSize];
+	const uint32 nBlockSamplesPerChannel = c_blockSize / nChannels;
+
+	TargetType* blockPlanes[256];
+	for(uint8 ch = 0; ch < nChannels; ch++)
+		blockPlanes[ch] = block + ch * nBlockSamplesPerChannel;
+
+	for(uint32 offset = 0; offset < nSamples; offset += nBlockSamplesPerChannel)
+	{
+		uint32 nBlockSamples = Math::Min(nBlockSamplesPerChannel, nSamples - offset);
+
+		if(sourceFormat.planar)
+		{
+			for(uint8 ch = 0; ch < nChannels; ch++)
+				convert(static_cast<const SourceType*>(source.GetPlane(ch)) + offset, blockPlanes[ch], nBlockSamples);
+			Interleave(kernels, blockPlanes, static_cast<TargetType*>(targetPlanes[0]) + offset * nChannels, nChannels, nBlockSamples);
+		}
+		else
+		{
+			TargetType* targetBlockPlanes[256];
+			for(uint8 ch = 0; ch < nChannels; ch++)
+				targetBlockPlanes[ch] = static_cast<TargetType*>(targetPlanes[ch]) + offset;
+
+			convert(static_cast<const SourceType*>(source.GetPlane(0)) + offset * nChannels, block, nBlockSamples * nChannels);
+			Deinterleave(kernels, block, targetBlockPlanes, nChannels, nBlockSamples);
+		}
+	}
+}
+
+template<typename SourceType>
+static void ConvertSamplesFrom(const AudioBuffer& source, const AudioSampleFormat& sourceFormat, void* const* targetPlanes, const AudioSampleFormat& targetFormat)
+{
+	switch(targetFormat.sampleType)
+	{
+		case AudioSampleType::Float:
+			ConvertSamples<SourceType, float32>(source, sourceFormat, targetPlanes, targetFormat);
+			break;
+		case AudioSampleType::S16:
+			ConvertSamples<SourceType, int16>(source, sourceFormat, targetPlanes, targetFormat);
+			break;
+		case AudioSampleType::S32:
+			ConvertSamples<SourceType, int32>(source, sourceFormat, targetPlanes, targetFormat);
+			break;
+		default:
+			NOT_IMPLEMENTED_ERROR;
+	}
+}
+
+static bool IsSampleTypeSupported(AudioSampleType sampleType)
+{
+	switch(sampleType)
+	{
+		case AudioSampleType::Float:
+		case AudioSampleType::S16:
+		case AudioSampleType::S32:
+			return true;
+	}
+	return false;
+}
+
+static void ConvertToPlanes(const AudioBuffer& source, const AudioSampleFormat& sourceFormat, void* const* targetPlanes, const AudioSampleFormat& targetFormat)
+{
+	ASSERT_EQUALS(sourceFormat.nChannels, targetFormat.nChannels);
+
+	switch(sourceFormat.sampleType)
+	{
+		case AudioSampleType::Float:
+			ConvertSamplesFrom<float32>(source, sourceFormat, targetPlanes, targetFormat);
+			break;
+		case AudioSampleType::S16:
+			ConvertSamplesFrom<int16>(source, sourceFormat, targetPlanes, targetFormat);
+			break;
+		case AudioSampleType::S32:
+			ConvertSamplesFrom<int32>(source, sourceFormat, targetPlanes, targetFormat);
+			break;
+		default:
+			NOT_IMPLEMENTED_ERROR;
+	}
+}
+
+//Class functions
+void AudioSampleConverter::Convert(const AudioBuffer& source, const AudioSampleFormat& sourceFormat, AudioBuffer& target, const AudioSampleFormat& targetFormat)
+{
+	void* targetPlanes[256];
+	for(uint8 i = 0; i < (targetFormat.planar ? targetFormat.nChannels : 1); i++)
+		targetPlanes[i] = target.GetPlane(i);
+
+	ConvertToPlanes(source, sourceFormat, targetPlanes, targetFormat);
+}
+
+void AudioSampleConverter::Convert(const AudioBuffer& source, const AudioSampleFormat& sourceFormat, void* target, const AudioSampleFormat& targetFormat)
+{
+	ASSERT(!targetFormat.planar, u8"raw target memory must be interleaved");
+	ConvertToPlanes(source, sourceFormat, &target, targetFormat);
+}
+
+uint8 AudioSampleConverter::GetSampleSize(AudioSampleType sampleType)
+{
+	switch(sampleType)
+	{
+		case AudioSampleType::Float:
+			return sizeof(float32);
+		case AudioSampleType::S16:
+			return sizeof(int16);
+		case AudioSampleType::S32:
+			return sizeof(int32);
+		default:
+			NOT_IMPLEMENTED_ERROR;
+	}
+	return 0;
+}
+
+bool AudioSampleConverter::IsSupported(const AudioSampleFormat& sourceFormat, const AudioSampleFormat& targetFormat)
+{
+	if(sourceFormat.nChannels != targetFormat.nChannels)
+		return false;
+	return IsSampleTypeSupported(sourceFormat.sampleType) && IsSampleTypeSupported(targetFormat.sampleType);
+}
\ No newline at end of file
@@ -0,0 +1,40 @@
+/*
+ * Copyright (c) 2023-2024 Amir Czwink (amir130@hotmail.de)
+ *
+ * This file is part of AVTools.
+ *
+ * AVTools is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * AVTools is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with AVTools.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#pragma once
+#include <StdXX.hpp>
+//Namespaces
+using namespace StdXX;
+using namespace StdXX::Multimedia;
+
+/**
+ * Converts audio samples between sample types and channel layouts into a caller-provided buffer.
+ * Unlike AudioBuffer::Resample this does not allocate, which allows the target buffer to come from a pool.
+ */
+class AudioSampleConverter
+{
+public:
+	//Functions
+	static void Convert(const AudioBuffer& source, const AudioSampleFormat& sourceFormat, AudioBuffer& target, const AudioSampleFormat& targetFormat);
+	/**
+	 * Converts into raw memory, e.g. the payload of a packet. targetFormat must be interleaved.
+	 */
+	static void Convert(const AudioBuffer& source, const AudioSampleFormat& sourceFormat, void* target, const AudioSampleFormat& targetFormat);
+	static uint8 GetSampleSize(AudioSampleType sampleType);
+	static bool IsSupported(const AudioSampleFormat& sourceFormat, const AudioSampleFormat& targetFormat);
+};
\ No newline at end of file
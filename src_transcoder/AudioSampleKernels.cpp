@@ -0,0 +1,500 @@
+/*
+ * Copyright (c) 2023-2024 Amir Czwink (amir130@hotmail.de)
+ *
+ * This file is part of AVTools.
+ *
+ * AVTools is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * AVTools is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with AVTools.  If not, see <http://www.gnu.org/licenses/>.
+ */
+//Class Header
+#include "AudioSampleKernels.hpp"
+//Global
+#include <cmath>
+#if defined(__x86_64__) || defined(__i386__)
+#define AUDIOSAMPLEKERNELS_X86
+#include <immintrin.h>
+#endif
+
+//Sample conversions
+static inline int16 ConvertSample(float32 sample, int16*)
+{
+	//clamping first also maps NaN to -1
+	sample = (sample > -1.0f) ? sample : -1.0f;
+	sample = (sample < 1.0f) ? sample : 1.0f;
+	int32 value = (int32)lrintf(sample * 32768.0f);
+	return (int16)((value > 32767) ? 32767 : value);
+}
+
+static inline int32 ConvertSample(float32 sample, int32*)
+{
+	sample = (sample > -1.0f) ? sample : -1.0f;
+	if(sample >= 1.0f)
+		return Signed<int32>::Max();
+	return (int32)lrintf(sample * 2147483648.0f);
+}
+
+static inline float32 ConvertSample(int16 sample, float32*)
+{
+	return sample * (1.0f / 32768.0f);
+}
+
+static inline int32 ConvertSample(int16 sample, int32*)
+{
+	return int32(sample) * 65536;
+}
+
+static inline float32 ConvertSample(int32 sample, float32*)
+{
+	return float32(sample) * (1.0f / 2147483648.0f);
+}
+
+static inline int16 ConvertSample(int32 sample, int16*)
+{
+	return int16(sample >> 16);
+}
+
+//Scalar kernels
+template<typename SourceType, typename TargetType>
+static void ConvertScalar(const SourceType* source, TargetType* target, uint32 nSamples)
+{
+	for(uint32 i = 0; i < nSamples; i++)
+		target[i] = ConvertSample(source[i], (TargetType*)nullptr);
+}
+
+template<typename T>
+static void DeinterleaveStereoScalar(const T* source, T* left, T* right, uint32 nSamplesPerChannel)
+{
+	for(uint32 i = 0; i < nSamplesPerChannel; i++)
+	{
+		left[i] = source[2*i];
+		right[i] = source[2*i + 1];
+	}
+}
+
+static float32 DotProductScalar(const float32* a, const float32* b, uint32 n)
+{
+	float32 sum = 0;
+	for(uint32 i = 0; i < n; i++)
+		sum += a[i] * b[i];
+	return sum;
+}
+
+static void MultiplyAccumulateScalar(const float32* source, float32 factor, float32* target, uint32 nSamples)
+{
+	for(uint32 i = 0; i < nSamples; i++)
+		target[i] += factor * source[i];
+}
+
+template<typename T>
+static void InterleaveStereoScalar(const T* left, const T* right, T* target, uint32 nSamplesPerChannel)
+{
+	for(uint32 i = 0; i < nSamplesPerChannel; i++)
+	{
+		target[2*i] = left[i];
+		target[2*i + 1] = right[i];
+	}
+}
+
+#ifdef AUDIOSAMPLEKERNELS_X86
+/*
+ * The vector kernels rely on the same IEEE semantics as the scalar ones:
+ * - maxps/minps return the second operand if the first is NaN, which is exactly what the scalar ternary clamps do
+ * - cvtps2dq rounds to nearest even like lrintf with the default rounding mode
+ * - int32 to float conversion rounds to nearest even like the scalar cast
+ * - scaling by a power of two is exact
+ */
+
+//SSE2 kernels
+__attribute__((target("sse2")))
+static float32 DotProductSSE2(const float32* a, const float32* b, uint32 n)
+{
+	//two accumulators hide the latency of the additions
+	__m128 sum0 = _mm_setzero_ps();
+	__m128 sum1 = _mm_setzero_ps();
+	uint32 i = 0;
+	for(; i + 8 <= n; i += 8)
+	{
+		sum0 = _mm_add_ps(sum0, _mm_mul_ps(_mm_loadu_ps(a + i), _mm_loadu_ps(b + i)));
+		sum1 = _mm_add_ps(sum1, _mm_mul_ps(_mm_loadu_ps(a + i + 4), _mm_loadu_ps(b + i + 4)));
+	}
+	__m128 sum = _mm_add_ps(sum0, sum1);
+	sum = _mm_add_ps(sum, _mm_movehl_ps(sum, sum));
+	sum = _mm_add_ss(sum, _mm_shuffle_ps(sum, sum, 1));
+	return _mm_cvtss_f32(sum) + DotProductScalar(a + i, b + i, n - i);
+}
+
+__attribute__((target("sse2")))
+static void ConvertFloatToS16SSE2(const float32* source, int16* target, uint32 nSamples)
+{
+	const __m128 minusOne = _mm_set1_ps(-1.0f);
+	const __m128 one = _mm_set1_ps(1.0f);
+	const __m128 scale = _mm_set1_ps(32768.0f);
+
+	uint32 i = 0;
+	for(; i + 8 <= nSamples; i += 8)
+	{
+		__m128 a = _mm_min_ps(_mm_max_ps(_mm_loadu_ps(source + i), minusOne), one);
+		__m128 b = _mm_min_ps(_mm_max_ps(_mm_loadu_ps(source + i + 4), minusOne), one);
+		//packs saturates 32768 to 32767
+		__m128i packed = _mm_packs_epi32(_mm_cvtps_epi32(_mm_mul_ps(a, scale)), _mm_cvtps_epi32(_mm_mul_ps(b, scale)));
+		_mm_storeu_si128((__m128i*)(target + i), packed);
+	}
+	ConvertScalar(source + i, target + i, nSamples - i);
+}
+
+__attribute__((target("sse2")))
+static void ConvertFloatToS32SSE2(const float32* source, int32* target, uint32 nSamples)
+{
+	const __m128 minusOne = _mm_set1_ps(-1.0f);
+	const __m128 one = _mm_set1_ps(1.0f);
+	const __m128 scale = _mm_set1_ps(2147483648.0f);
+	const __m128i max = _mm_set1_epi32(Signed<int32>::Max());
+
+	uint32 i = 0;
+	for(; i + 4 <= nSamples; i += 4)
+	{
+		__m128 x = _mm_max_ps(_mm_loadu_ps(source + i), minusOne);
+		__m128i overflow = _mm_castps_si128(_mm_cmpge_ps(x, one));
+		__m128i converted = _mm_cvtps_epi32(_mm_mul_ps(x, scale));
+		converted = _mm_or_si128(_mm_and_si128(overflow, max), _mm_andnot_si128(overflow, converted));
+		_mm_storeu_si128((__m128i*)(target + i), converted);
+	}
+	ConvertScalar(source + i, target + i, nSamples - i);
+}
+
+__attribute__((target("sse2")))
+static void ConvertS16ToFloatSSE2(const int16* source, float32* target, uint32 nSamples)
+{
+	const __m128 scale = _mm_set1_ps(1.0f / 32768.0f);
+
+	uint32 i = 0;
+	for(; i + 8 <= nSamples; i += 8)
+	{
+		__m128i x = _mm_loadu_si128((const __m128i*)(source + i));
+		//sign extend by moving the samples into the upper halves and shifting back
+		__m128i low = _mm_srai_epi32(_mm_unpacklo_epi16(x, x), 16);
+		__m128i high = _mm_srai_epi32(_mm_unpackhi_epi16(x, x), 16);
+		_mm_storeu_ps(target + i, _mm_mul_ps(_mm_cvtepi32_ps(low), scale));
+		_mm_storeu_ps(target + i + 4, _mm_mul_ps(_mm_cvtepi32_ps(high), scale));
+	}
+	ConvertScalar(source + i, target + i, nSamples - i);
+}
+
+__attribute__((target("sse2")))
+static void ConvertS16ToS32SSE2(const int16* source, int32* target, uint32 nSamples)
+{
+	const __m128i zero = _mm_setzero_si128();
+
+	uint32 i = 0;
+	for(; i + 8 <= nSamples; i += 8)
+	{
+		__m128i x = _mm_loadu_si128((const __m128i*)(source + i));
+		_mm_storeu_si128((__m128i*)(target + i), _mm_unpacklo_epi16(zero, x));
+		_mm_storeu_si128((__m128i*)(target + i + 4), _mm_unpackhi_epi16(zero, x));
+	}
+	ConvertScalar(source + i, target + i, nSamples - i);
+}
+
+__attribute__((target("sse2")))
+static void ConvertS32ToFloatSSE2(const int32* source, float32* target, uint32 nSamples)
+{
+	const __m128 scale = _mm_set1_ps(1.0f / 2147483648.0f);
+
+	uint32 i = 0;
+	for(; i + 4 <= nSamples; i += 4)
+	{
+		__m128i x = _mm_loadu_si128((const __m128i*)(source + i));
+		_mm_storeu_ps(target + i, _mm_mul_ps(_mm_cvtepi32_ps(x), scale));
+	}
+	ConvertScalar(source + i, target + i, nSamples - i);
+}
+
+__attribute__((target("sse2")))
+static void ConvertS32ToS16SSE2(const int32* source, int16* target, uint32 nSamples)
+{
+	uint32 i = 0;
+	for(; i + 8 <= nSamples; i += 8)
+	{
+		__m128i a = _mm_srai_epi32(_mm_loadu_si128((const __m128i*)(source + i)), 16);
+		__m128i b = _mm_srai_epi32(_mm_loadu_si128((const __m128i*)(source + i + 4)), 16);
+		_mm_storeu_si128((__m128i*)(target + i), _mm_packs_epi32(a, b));
+	}
+	ConvertScalar(source + i, target + i, nSamples - i);
+}
+
+__attribute__((target("sse2")))
+static void DeinterleaveStereo16SSE2(const int16* source, int16* left, int16* right, uint32 nSamplesPerChannel)
+{
+	uint32 i = 0;
+	for(; i + 8 <= nSamplesPerChannel; i += 8)
+	{
+		//every 32 bit lane holds one left (low half) and one right (high half) sample
+		__m128i a = _mm_loadu_si128((const __m128i*)(source + 2*i));
+		__m128i b = _mm_loadu_si128((const __m128i*)(source + 2*i + 8));
+		__m128i leftSamples = _mm_packs_epi32(_mm_srai_epi32(_mm_slli_epi32(a, 16), 16), _mm_srai_epi32(_mm_slli_epi32(b, 16), 16));
+		__m128i rightSamples = _mm_packs_epi32(_mm_srai_epi32(a, 16), _mm_srai_epi32(b, 16));
+		_mm_storeu_si128((__m128i*)(left + i), leftSamples);
+		_mm_storeu_si128((__m128i*)(right + i), rightSamples);
+	}
+	DeinterleaveStereoScalar(source + 2*i, left + i, right + i, nSamplesPerChannel - i);
+}
+
+__attribute__((target("sse2")))
+static void DeinterleaveStereo32SSE2(const uint32* source, uint32* left, uint32* right, uint32 nSamplesPerChannel)
+{
+	uint32 i = 0;
+	for(; i + 4 <= nSamplesPerChannel; i += 4)
+	{
+		__m128 a = _mm_loadu_ps((const float32*)(source + 2*i));
+		__m128 b = _mm_loadu_ps((const float32*)(source + 2*i + 4));
+		_mm_storeu_ps((float32*)(left + i), _mm_shuffle_ps(a, b, _MM_SHUFFLE(2, 0, 2, 0)));
+		_mm_storeu_ps((float32*)(right + i), _mm_shuffle_ps(a, b, _MM_SHUFFLE(3, 1, 3, 1)));
+	}
+	DeinterleaveStereoScalar(source + 2*i, left + i, right + i, nSamplesPerChannel - i);
+}
+
+__attribute__((target("sse2")))
+static void InterleaveStereo16SSE2(const int16* left, const int16* right, int16* target, uint32 nSamplesPerChannel)
+{
+	uint32 i = 0;
+	for(; i + 8 <= nSamplesPerChannel; i += 8)
+	{
+		__m128i l = _mm_loadu_si128((const __m128i*)(left + i));
+		__m128i r = _mm_loadu_si128((const __m128i*)(right + i));
+		_mm_storeu_si128((__m128i*)(target + 2*i), _mm_unpacklo_epi16(l, r));
+		_mm_storeu_si128((__m128i*)(target + 2*i + 8), _mm_unpackhi_epi16(l, r));
+	}
+	InterleaveStereoScalar(left + i, right + i, target + 2*i, nSamplesPerChannel - i);
+}
+
+__attribute__((target("sse2")))
+static void InterleaveStereo32SSE2(const uint32* left, const uint32* right, uint32* target, uint32 nSamplesPerChannel)
+{
+	uint32 i = 0;
+	for(; i + 4 <= nSamplesPerChannel; i += 4)
+	{
+		__m128i l = _mm_loadu_si128((const __m128i*)(left + i));
+		__m128i r = _mm_loadu_si128((const __m128i*)(right + i));
+		_mm_storeu_si128((__m128i*)(target + 2*i), _mm_unpacklo_epi32(l, r));
+		_mm_storeu_si128((__m128i*)(target + 2*i + 4), _mm_unpackhi_epi32(l, r));
+	}
+	InterleaveStereoScalar(left + i, right + i, target + 2*i, nSamplesPerChannel - i);
+}
+
+__attribute__((target("sse2")))
+static void MultiplyAccumulateSSE2(const float32* source, float32 factor, float32* target, uint32 nSamples)
+{
+	//no fused multiply-add, the product is rounded before the addition like in the scalar kernel
+	__m128 f = _mm_set1_ps(factor);
+	uint32 i = 0;
+	for(; i + 4 <= nSamples; i += 4)
+		_mm_storeu_ps(target + i, _mm_add_ps(_mm_loadu_ps(target + i), _mm_mul_ps(f, _mm_loadu_ps(source + i))));
+	MultiplyAccumulateScalar(source + i, factor, target + i, nSamples - i);
+}
+
+//AVX2 kernels
+__attribute__((target("avx2")))
+static float32 DotProductAVX2(const float32* a, const float32* b, uint32 n)
+{
+	__m256 sum0 = _mm256_setzero_ps();
+	__m256 sum1 = _mm256_setzero_ps();
+	uint32 i = 0;
+	for(; i + 16 <= n; i += 16)
+	{
+		sum0 = _mm256_add_ps(sum0, _mm256_mul_ps(_mm256_loadu_ps(a + i), _mm256_loadu_ps(b + i)));
+		sum1 = _mm256_add_ps(sum1, _mm256_mul_ps(_mm256_loadu_ps(a + i + 8), _mm256_loadu_ps(b + i + 8)));
+	}
+	__m256 sum256 = _mm256_add_ps(sum0, sum1);
+	__m128 sum = _mm_add_ps(_mm256_castps256_ps128(sum256), _mm256_extractf128_ps(sum256, 1));
+	sum = _mm_add_ps(sum, _mm_movehl_ps(sum, sum));
+	sum = _mm_add_ss(sum, _mm_shuffle_ps(sum, sum, 1));
+	return _mm_cvtss_f32(sum) + DotProductScalar(a + i, b + i, n - i);
+}
+
+__attribute__((target("avx2")))
+static void ConvertFloatToS16AVX2(const float32* source, int16* target, uint32 nSamples)
+{
+	const __m256 minusOne = _mm256_set1_ps(-1.0f);
+	const __m256 one = _mm256_set1_ps(1.0f);
+	const __m256 scale = _mm256_set1_ps(32768.0f);
+
+	uint32 i = 0;
+	for(; i + 16 <= nSamples; i += 16)
+	{
+		__m256 a = _mm256_min_ps(_mm256_max_ps(_mm256_loadu_ps(source + i), minusOne), one);
+		__m256 b = _mm256_min_ps(_mm256_max_ps(_mm256_loadu_ps(source + i + 8), minusOne), one);
+		__m256i packed = _mm256_packs_epi32(_mm256_cvtps_epi32(_mm256_mul_ps(a, scale)), _mm256_cvtps_epi32(_mm256_mul_ps(b, scale)));
+		//packs works per 128 bit lane
+		_mm256_storeu_si256((__m256i*)(target + i), _mm256_permute4x64_epi64(packed, _MM_SHUFFLE(3, 1, 2, 0)));
+	}
+	ConvertFloatToS16SSE2(source + i, target + i, nSamples - i);
+}
+
+__attribute__((target("avx2")))
+static void ConvertFloatToS32AVX2(const float32* source, int32* target, uint32 nSamples)
+{
+	const __m256 minusOne = _mm256_set1_ps(-1.0f);
+	const __m256 one = _mm256_set1_ps(1.0f);
+	const __m256 scale = _mm256_set1_ps(2147483648.0f);
+	const __m256i max = _mm256_set1_epi32(Signed<int32>::Max());
+
+	uint32 i = 0;
+	for(; i + 8 <= nSamples; i += 8)
+	{
+		__m256 x = _mm256_max_ps(_mm256_loadu_ps(source + i), minusOne);
+		__m256i overflow = _mm256_castps_si256(_mm256_cmp_ps(x, one, _CMP_GE_OQ));
+		__m256i converted = _mm256_blendv_epi8(_mm256_cvtps_epi32(_mm256_mul_ps(x, scale)), max, overflow);
+		_mm256_storeu_si256((__m256i*)(target + i), converted);
+	}
+	ConvertFloatToS32SSE2(source + i, target + i, nSamples - i);
+}
+
+__attribute__((target("avx2")))
+static void ConvertS16ToFloatAVX2(const int16* source, float32* target, uint32 nSamples)
+{
+	const __m256 scale = _mm256_set1_ps(1.0f / 32768.0f);
+
+	uint32 i = 0;
+	for(; i + 8 <= nSamples; i += 8)
+	{
+		__m256i x = _mm256_cvtepi16_epi32(_mm_loadu_si128((const __m128i*)(source + i)));
+		_mm256_storeu_ps(target + i, _mm256_mul_ps(_mm256_cvtepi32_ps(x), scale));
+	}
+	ConvertScalar(source + i, target + i, nSamples - i);
+}
+
+__attribute__((target("avx2")))
+static void ConvertS16ToS32AVX2(const int16* source, int32* target, uint32 nSamples)
+{
+	uint32 i = 0;
+	for(; i + 8 <= nSamples; i += 8)
+	{
+		__m256i x = _mm256_cvtepi16_epi32(_mm_loadu_si128((const __m128i*)(source + i)));
+		_mm256_storeu_si256((__m256i*)(target + i), _mm256_slli_epi32(x, 16));
+	}
+	ConvertScalar(source + i, target + i, nSamples - i);
+}
+
+__attribute__((target("avx2")))
+static void ConvertS32ToFloatAVX2(const int32* source, float32* target, uint32 nSamples)
+{
+	const __m256 scale = _mm256_set1_ps(1.0f / 2147483648.0f);
+
+	uint32 i = 0;
+	for(; i + 8 <= nSamples; i += 8)
+	{
+		__m256i x = _mm256_loadu_si256((const __m256i*)(source + i));
+		_mm256_storeu_ps(target + i, _mm256_mul_ps(_mm256_cvtepi32_ps(x), scale));
+	}
+	ConvertScalar(source + i, target + i, nSamples - i);
+}
+
+__attribute__((target("avx2")))
+static void ConvertS32ToS16AVX2(const int32* source, int16* target, uint32 nSamples)
+{
+	uint32 i = 0;
+	for(; i + 16 <= nSamples; i += 16)
+	{
+		__m256i a = _mm256_srai_epi32(_mm256_loadu_si256((const __m256i*)(source + i)), 16);
+		__m256i b = _mm256_srai_epi32(_mm256_loadu_si256((const __m256i*)(source + i + 8)), 16);
+		_mm256_storeu_si256((__m256i*)(target + i), _mm256_permute4x64_epi64(_mm256_packs_epi32(a, b), _MM_SHUFFLE(3, 1, 2, 0)));
+	}
+	ConvertScalar(source + i, target + i, nSamples - i);
+}
+
+__attribute__((target("avx2")))
+static void MultiplyAccumulateAVX2(const float32* source, float32 factor, float32* target, uint32 nSamples)
+{
+	__m256 f = _mm256_set1_ps(factor);
+	uint32 i = 0;
+	for(; i + 8 <= nSamples; i += 8)
+		_mm256_storeu_ps(target + i, _mm256_add_ps(_mm256_loadu_ps(target + i), _mm256_mul_ps(f, _mm256_loadu_ps(source + i))));
+	MultiplyAccumulateScalar(source + i, factor, target + i, nSamples - i);
+}
+#endif
+
+//Local functions
+static AudioSampleKernels CreateScalarKernels()
+{
+	AudioSampleKernels kernels;
+
+	kernels.floatToS16 = ConvertScalar<float32, int16>;
+	kernels.floatToS32 = ConvertScalar<float32, int32>;
+	kernels.s16ToFloat = ConvertScalar<int16, float32>;
+	kernels.s16ToS32 = ConvertScalar<int16, int32>;
+	kernels.s32ToFloat = ConvertScalar<int32, float32>;
+	kernels.s32ToS16 = ConvertScalar<int32, int16>;
+
+	kernels.deinterleaveStereo16 = DeinterleaveStereoScalar<int16>;
+	kernels.deinterleaveStereo32 = DeinterleaveStereoScalar<uint32>;
+	kernels.interleaveStereo16 = InterleaveStereoScalar<int16>;
+	kernels.interleaveStereo32 = InterleaveStereoScalar<uint32>;
+
+	kernels.dotProduct = DotProductScalar;
+	kernels.multiplyAccumulate = MultiplyAccumulateScalar;
+
+	return kernels;
+}
+
+static AudioSampleKernels SelectKernels()
+{
+	AudioSampleKernels kernels = CreateScalarKernels();
+
+#ifdef AUDIOSAMPLEKERNELS_X86
+	__builtin_cpu_init();
+	if(__builtin_cpu_supports("sse2"))
+	{
+		kernels.floatToS16 = ConvertFloatToS16SSE2;
+		kernels.floatToS32 = ConvertFloatToS32SSE2;
+		kernels.s16ToFloat = ConvertS16ToFloatSSE2;
+		kernels.s16ToS32 = ConvertS16ToS32SSE2;
+		kernels.s32ToFloat = ConvertS32ToFloatSSE2;
+		kernels.s32ToS16 = ConvertS32ToS16SSE2;
+
+		kernels.deinterleaveStereo16 = DeinterleaveStereo16SSE2;
+		kernels.deinterleaveStereo32 = DeinterleaveStereo32SSE2;
+		kernels.interleaveStereo16 = InterleaveStereo16SSE2;
+		kernels.interleaveStereo32 = InterleaveStereo32SSE2;
+
+		kernels.dotProduct = DotProductSSE2;
+		kernels.multiplyAccumulate = MultiplyAccumulateSSE2;
+	}
+	if(__builtin_cpu_supports("avx2"))
+	{
+		kernels.floatToS16 = ConvertFloatToS16AVX2;
+		kernels.floatToS32 = ConvertFloatToS32AVX2;
+		kernels.s16ToFloat = ConvertS16ToFloatAVX2;
+		kernels.s16ToS32 = ConvertS16ToS32AVX2;
+		kernels.s32ToFloat = ConvertS32ToFloatAVX2;
+		kernels.s32ToS16 = ConvertS32ToS16AVX2;
+
+		kernels.dotProduct = DotProductAVX2;
+		kernels.multiplyAccumulate = MultiplyAccumulateAVX2;
+	}
+#endif
+
+	return kernels;
+}
+
+//Class functions
+const AudioSampleKernels& AudioSampleKernels::Get()
+{
+	static const AudioSampleKernels kernels = SelectKernels();
+	return kernels;
+}
+
+const AudioSampleKernels& AudioSampleKernels::GetScalar()
+{
+	static const AudioSampleKernels kernels = CreateScalarKernels();
+	return kernels;
+}
\ No newline at end of file
@@ -0,0 +1,62 @@
+/*
+ * Copyright (c) 2023-2024 Amir Czwink (amir130@hotmail.de)
+ *
+ * This file is part of AVTools.
+ *
+ * AVTools is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * AVTools is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with AVTools.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#pragma once
+#include <StdXX.hpp>
+//Namespaces
+using namespace StdXX;
+
+/**
+ * Converts nSamples contiguous samples
+ */
+template<typename SourceType, typename TargetType>
+using SampleConversionKernel = void(*)(const SourceType* source, TargetType* target, uint32 nSamples);
+
+/**
+ * Inner loops of AudioSampleConverter, AudioSampleRateNode, AudioRemixNode and VideoScaleNode. Vectorized variants are chosen at runtime depending on the features of the CPU.
+ * All variants of the conversion, (de)interleaving and multiplyAccumulate kernels produce bit-exact the same results as the scalar ones.
+ * This relies on the compiler not fusing multiplications and additions, see the build flags of this file.
+ * dotProduct sums in a different order per variant and may therefore differ in the last bits.
+ */
+struct AudioSampleKernels
+{
+	SampleConversionKernel<float32, int16> floatToS16;
+	SampleConversionKernel<float32, int32> floatToS32;
+	SampleConversionKernel<int16, float32> s16ToFloat;
+	SampleConversionKernel<int16, int32> s16ToS32;
+	SampleConversionKernel<int32, float32> s32ToFloat;
+	SampleConversionKernel<int32, int16> s32ToS16;
+
+	void (*deinterleaveStereo16)(const int16* source, int16* left, int16* right, uint32 nSamplesPerChannel);
+	void (*deinterleaveStereo32)(const uint32* source, uint32* left, uint32* right, uint32 nSamplesPerChannel);
+	void (*interleaveStereo16)(const int16* left, const int16* right, int16* target, uint32 nSamplesPerChannel);
+	void (*interleaveStereo32)(const uint32* left, const uint32* right, uint32* target, uint32 nSamplesPerChannel);
+
+	float32 (*dotProduct)(const float32* a, const float32* b, uint32 n);
+	/**
+	 * target[i] += factor * source[i]
+	 */
+	void (*multiplyAccumulate)(const float32* source, float32 factor, float32* target, uint32 nSamples);
+
+	//Functions
+	/**
+	 * The fastest kernels that the CPU supports
+	 */
+	static const AudioSampleKernels& Get();
+	static const AudioSampleKernels& GetScalar();
+};
\ No newline at end of file
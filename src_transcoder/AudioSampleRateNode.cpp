@@ -0,0 +1,322 @@
+/*
+ * Copyright (c) 2023-2024 Amir Czwink (amir130@hotmail.de)
+ *
+ * This file is part of AVTools.
+ *
+ * AVTools is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * AVTools is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with AVTools.  If not, see <http://www.gnu.org/licenses/>.
+ */
+//Class Header
+#include "AudioSampleRateNode.hpp"
+//Global
+#include <cmath>
+//Local
+#include "AudioSampleKernels.hpp"
+
+//Constants
+/**
+ * Filter length in input samples. A multiple of 16 so that the vectorized dot products don't need a scalar tail.
+ */
+static const uint32 c_nTaps = 32;
+static const uint32 c_blockSize = 1024;
+static const uint32 c_historyCapacity = c_nTaps + c_blockSize;
+/**
+ * Limits the size of the coefficient table. All ratios between the common sample rates need far less.
+ */
+static const uint32 c_maxPhases = 1024;
+/**
+ * Fraction of the Nyquist frequency that passes the filter
+ */
+static const float64 c_passband = 0.9;
+static const float64 c_kaiserBeta = 8.0;
+
+//Local functions
+static uint32 ComputeGreatestCommonDivisor(uint32 a, uint32 b)
+{
+    while(b != 0)
+    {
+        uint32 r = a % b;
+        a = b;
+        b = r;
+    }
+    return a;
+}
+
+/**
+ * Zeroth order modified Bessel function of the first kind
+ */
+static float64 ComputeBesselI0(float64 x)
+{
+    float64 sum = 1;
+    float64 term = 1;
+    for(uint32 k = 1; k < 50; k++)
+    {
+        term *= (x / (2 * k)) * (x / (2 * k));
+        sum += term;
+        if(term < sum * 1e-12)
+            break;
+    }
+    return sum;
+}
+
+//Constructor
+AudioSampleRateNode::AudioSampleRateNode(const DecodingParameters& sourceParameters, uint32 targetSampleRate, const TimeScale& timeScale)
+    : sourceParameters(sourceParameters), targetSampleRate(targetSampleRate), timeScale(timeScale)
+{
+    this->outputPorts.Resize(1);
+
+    const uint8 nChannels = sourceParameters.audio.sampleFormat->nChannels;
+    this->sourceParameters.audio.sampleFormat = AudioSampleFormat(nChannels, AudioSampleType::Float, true);
+
+    const uint32 sourceSampleRate = sourceParameters.audio.sampleRate;
+    const uint32 divisor = ComputeGreatestCommonDivisor(sourceSampleRate, targetSampleRate);
+    this->upFactor = targetSampleRate / divisor;
+    this->downFactor = sourceSampleRate / divisor;
+    this->ComputeCoefficients();
+
+    //the history starts with silence so that the first output sample is located at the first input sample
+    this->history.Resize(nChannels * c_historyCapacity);
+    MemZero(&this->history[0], this->history.GetNumberOfElements() * sizeof(float32));
+    this->nBufferedSamples = c_nTaps / 2 - 1;
+    this->position = c_nTaps / 2 - 1;
+    this->phase = 0;
+
+    this->flushed = false;
+    this->retainsSequence = false;
+    this->hasStartPts = false;
+    this->startPts = 0;
+    this->nOutputSamples = 0;
+}
+
+//Public methods
+bool AudioSampleRateNode::CanProcess() const
+{
+    if(this->IsDataAvailable())
+        return true;
+    //the samples that are still in the filter must be flushed once the input ended
+    return !this->flushed && !this->IsMoreInputFromInputsPortsExpected();
+}
+
+String AudioSampleRateNode::GetName() const
+{
+    return u8"AudioSampleRateNode";
+}
+
+PortFormat AudioSampleRateNode::GetInputFormat(uint32 inputPortNumber) const
+{
+    return {
+        .packetsOrFrames = false,
+        .frameParameters = this->sourceParameters,
+    };
+}
+
+PortFormat AudioSampleRateNode::GetOutputFormat(uint32 outputPortNumber) const
+{
+    DecodingParameters codingParameters = this->sourceParameters;
+    codingParameters.audio.sampleRate = this->targetSampleRate;
+    return {
+        .packetsOrFrames = false,
+        .frameParameters = codingParameters,
+    };
+}
+
+void AudioSampleRateNode::ProcessNextEntity()
+{
+    //upstream state must be captured before looking at the queue, else data that arrives in between is missed
+    bool moreInputExpected = this->IsMoreInputFromInputsPortsExpected();
+    if(this->IsDataAvailable())
+    {
+        NodeData data = this->GetNextData();
+        const AudioBuffer* sourceBuffer = data.GetFrame().GetAudioBuffer();
+
+        if(!this->hasStartPts)
+        {
+            this->startPts = data.GetFrame().pts;
+            this->hasStartPts = true;
+        }
+
+        const float32* planes[256];
+        for(uint8 ch = 0; ch < this->sourceParameters.audio.sampleFormat->nChannels; ch++)
+            planes[ch] = static_cast<const float32*>(sourceBuffer->GetPlane(ch));
+        this->EmitResampled(planes, sourceBuffer->GetNumberOfSamplesPerChannel());
+
+        //the last input samples are still in the filter. Their tail must not be written after the entities that the source read later
+        this->RetainSequence(data.sequenceNumber);
+        if(this->retainsSequence)
+            this->ReleaseSequence(this->retainedSequenceNumber);
+        this->retainedSequenceNumber = data.sequenceNumber;
+        this->retainsSequence = true;
+    }
+    else if(!moreInputExpected)
+    {
+        //pad the end with silence so that the last input samples leave the filter
+        this->flushed = true;
+        if(this->retainsSequence)
+            this->currentSequenceNumber = this->retainedSequenceNumber;
+        this->EmitResampled(nullptr, c_nTaps / 2);
+
+        if(this->retainsSequence)
+        {
+            this->retainsSequence = false;
+            this->ReleaseSequence(this->retainedSequenceNumber);
+        }
+    }
+}
+
+//Class functions
+bool AudioSampleRateNode::IsSupported(uint32 sourceSampleRate, uint32 targetSampleRate)
+{
+    if((sourceSampleRate == 0) || (targetSampleRate == 0))
+        return false;
+
+    const uint32 divisor = ComputeGreatestCommonDivisor(sourceSampleRate, targetSampleRate);
+    const uint32 upFactor = targetSampleRate / divisor;
+    const uint32 downFactor = sourceSampleRate / divisor;
+    //the filter must still cover the step between two output samples
+    return (upFactor <= c_maxPhases) && (downFactor <= upFactor * (c_nTaps / 2));
+}
+
+//Private methods
+void AudioSampleRateNode::ComputeCoefficients()
+{
+    //cutoff relative to the input sample rate. When decimating, the Nyquist frequency of the output is the limit
+    const float64 cutoff = 0.5 * c_passband * Math::Min(1.0, float64(this->upFactor) / this->downFactor);
+    const float64 halfLength = c_nTaps / 2;
+    const float64 windowNormalization = ComputeBesselI0(c_kaiserBeta);
+
+    this->coefficients.Resize(this->upFactor * c_nTaps);
+    for(uint32 p = 0; p < this->upFactor; p++)
+    {
+        float32* taps = &this->coefficients[p * c_nTaps];
+
+        float64 sum = 0;
+        for(uint32 k = 0; k < c_nTaps; k++)
+        {
+            //distance of the input sample from the location of the output sample
+            const float64 t = (float64(k) - (halfLength - 1)) - float64(p) / this->upFactor;
+
+            const float64 x = 2 * cutoff * t;
+            const float64 sinc = (x == 0) ? 1.0 : sin(PI * x) / (PI * x);
+
+            const float64 w = Math::Min(1.0, fabs(t) / halfLength);
+            const float64 window = ComputeBesselI0(c_kaiserBeta * sqrt(1 - w * w)) / windowNormalization;
+
+            const float64 value = sinc * window;
+            taps[k] = float32(value);
+            sum += value;
+        }
+
+        //unity gain for DC in every phase
+        for(uint32 k = 0; k < c_nTaps; k++)
+            taps[k] = float32(taps[k] / sum);
+    }
+}
+
+uint64 AudioSampleRateNode::ComputeNextPts() const
+{
+    //seconds = nOutputSamples / targetSampleRate, pts = seconds / timeScale
+    const float64 ticks = float64(this->nOutputSamples) * this->timeScale.denominator / (float64(this->targetSampleRate) * this->timeScale.numerator);
+    return this->startPts + uint64(ticks + 0.5);
+}
+
+uint32 AudioSampleRateNode::CountOutputSamples(uint32 nAdditionalSamples) const
+{
+    /*
+     * The k-th next output sample is located after input sample position + (phase + k * downFactor) / upFactor.
+     * It can be computed as soon as c_nTaps / 2 samples after that one are available.
+     */
+    const int64 nAvailableSteps = int64(this->nBufferedSamples) + nAdditionalSamples - c_nTaps / 2 - this->position;
+    if(nAvailableSteps <= 0)
+        return 0;
+    return uint32((uint64(nAvailableSteps) * this->upFactor - this->phase + this->downFactor - 1) / this->downFactor);
+}
+
+void AudioSampleRateNode::EmitResampled(const float32* const* planes, uint32 nSamplesPerChannel)
+{
+    const uint32 nOutputSamples = this->CountOutputSamples(nSamplesPerChannel);
+    if(nOutputSamples == 0)
+    {
+        this->Resample(planes, nSamplesPerChannel, nullptr);
+        return;
+    }
+
+    const AudioSampleFormat& sampleFormat = *this->sourceParameters.audio.sampleFormat;
+    FramePool& framePool = this->Context().framePool;
+
+    NodeData outputData;
+    framePool.AcquireAudioFrame(outputData, sampleFormat, nOutputSamples);
+    outputData.frame->pts = this->ComputeNextPts();
+
+    AudioBuffer* outputBuffer = outputData.frame->GetAudioBuffer();
+    float32* outputPlanes[256];
+    for(uint8 ch = 0; ch < sampleFormat.nChannels; ch++)
+        outputPlanes[ch] = static_cast<float32*>(outputBuffer->GetPlane(ch));
+
+    this->Resample(planes, nSamplesPerChannel, outputPlanes);
+    this->nOutputSamples += nOutputSamples;
+
+    this->Emit(0, Move(outputData));
+}
+
+uint32 AudioSampleRateNode::Filter(float32* const* outputPlanes, uint32 offset)
+{
+    const auto dotProduct = AudioSampleKernels::Get().dotProduct;
+    const uint8 nChannels = this->sourceParameters.audio.sampleFormat->nChannels;
+
+    uint32 nOutputSamples = 0;
+    while(this->position + c_nTaps / 2 < this->nBufferedSamples)
+    {
+        const float32* taps = &this->coefficients[this->phase * c_nTaps];
+        const uint32 start = this->position - (c_nTaps / 2 - 1);
+        for(uint8 ch = 0; ch < nChannels; ch++)
+            outputPlanes[ch][offset + nOutputSamples] = dotProduct(taps, &this->history[ch * c_historyCapacity + start], c_nTaps);
+        nOutputSamples++;
+
+        this->phase += this->downFactor;
+        this->position += this->phase / this->upFactor;
+        this->phase %= this->upFactor;
+    }
+    return nOutputSamples;
+}
+
+void AudioSampleRateNode::Resample(const float32* const* planes, uint32 nSamplesPerChannel, float32* const* outputPlanes)
+{
+    const uint8 nChannels = this->sourceParameters.audio.sampleFormat->nChannels;
+
+    uint32 nOutputSamples = 0;
+    for(uint32 offset = 0; offset < nSamplesPerChannel; offset += c_blockSize)
+    {
+        uint32 nBlockSamples = Math::Min(c_blockSize, nSamplesPerChannel - offset);
+        for(uint8 ch = 0; ch < nChannels; ch++)
+        {
+            float32* target = &this->history[ch * c_historyCapacity + this->nBufferedSamples];
+            if(planes)
+                MemCopy(target, planes[ch] + offset, nBlockSamples * sizeof(float32));
+            else
+                MemZero(target, nBlockSamples * sizeof(float32));
+        }
+        this->nBufferedSamples += nBlockSamples;
+
+        nOutputSamples += this->Filter(outputPlanes, nOutputSamples);
+
+        //drop the samples that no future output sample depends on
+        const uint32 nDiscarded = Math::Min(this->position - (c_nTaps / 2 - 1), this->nBufferedSamples);
+        for(uint8 ch = 0; ch < nChannels; ch++)
+        {
+            float32* channelHistory = &this->history[ch * c_historyCapacity];
+            MemMove(channelHistory, channelHistory + nDiscarded, (this->nBufferedSamples - nDiscarded) * sizeof(float32));
+        }
+        this->nBufferedSamples -= nDiscarded;
+        this->position -= nDiscarded;
+    }
+}
\ No newline at end of file
@@ -0,0 +1,88 @@
+/*
+ * Copyright (c) 2023-2024 Amir Czwink (amir130@hotmail.de)
+ *
+ * This file is part of AVTools.
+ *
+ * AVTools is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * AVTools is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with AVTools.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#pragma once
+//Local
+#include "Node.hpp"
+
+/**
+ * Converts the sample rate by a rational factor upFactor/downFactor with a polyphase FIR filter (Kaiser windowed sinc).
+ * The filter taps of every phase are precomputed. Samples are streamed through a history buffer in blocks of fixed size,
+ * so that the memory usage does not depend on the size of the input frames.
+ * Works on planar float samples, SmartConnect inserts a resampler in front of it for other formats.
+ */
+class AudioSampleRateNode : public Node
+{
+public:
+    //Constructor
+    AudioSampleRateNode(const DecodingParameters& sourceParameters, uint32 targetSampleRate, const TimeScale& timeScale);
+
+    //Methods
+    bool CanProcess() const override;
+    String GetName() const override;
+    PortFormat GetInputFormat(uint32 inputPortNumber) const override;
+    PortFormat GetOutputFormat(uint32 outputPortNumber) const override;
+    void ProcessNextEntity() override;
+
+    //Functions
+    static bool IsSupported(uint32 sourceSampleRate, uint32 targetSampleRate);
+
+private:
+    //Members
+    DecodingParameters sourceParameters;
+    uint32 targetSampleRate;
+    TimeScale timeScale;
+    uint32 upFactor;
+    uint32 downFactor;
+    /**
+     * c_nTaps coefficients for each of the upFactor phases
+     */
+    DynamicArray<float32> coefficients;
+
+    //State
+    /**
+     * c_historyCapacity samples per channel
+     */
+    DynamicArray<float32> history;
+    uint32 nBufferedSamples;
+    /**
+     * Index of the input sample in history that the next output sample is located after
+     */
+    uint32 position;
+    /**
+     * Fractional part of the location of the next output sample in units of 1/upFactor input samples
+     */
+    uint32 phase;
+    bool flushed;
+    /**
+     * The sequence number of the last input frame is retained until the next frame arrived or the tail was flushed
+     */
+    bool retainsSequence;
+    uint64 retainedSequenceNumber;
+    bool hasStartPts;
+    uint64 startPts;
+    uint64 nOutputSamples;
+
+    //Methods
+    void ComputeCoefficients();
+    uint32 CountOutputSamples(uint32 nAdditionalSamples) const;
+    uint64 ComputeNextPts() const;
+    void EmitResampled(const float32* const* planes, uint32 nSamplesPerChannel);
+    uint32 Filter(float32* const* outputPlanes, uint32 offset);
+    void Resample(const float32* const* planes, uint32 nSamplesPerChannel, float32* const* outputPlanes);
+};
\ No newline at end of file
@@ -0,0 +1,180 @@
+/*
+ * Copyright (c) 2023-2024 Amir Czwink (amir130@hotmail.de)
+ *
+ * This file is part of AVTools.
+ *
+ * AVTools is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * AVTools is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with AVTools.  If not, see <http://www.gnu.org/licenses/>.
+ */
+//Class header
+#include "BatchTranscoder.hpp"
+//Local
+#include "NodeStatistics.hpp"
+
+class BatchWorker : public Thread
+{
+public:
+	//Constructor
+	inline BatchWorker(BatchTranscoder& batchTranscoder) : batchTranscoder(batchTranscoder)
+	{
+	}
+
+protected:
+	//Methods
+	int32 ThreadMain() override
+	{
+		this->batchTranscoder.ProcessJobs();
+		return EXIT_SUCCESS;
+	}
+
+private:
+	//State
+	BatchTranscoder& batchTranscoder;
+};
+
+//Local functions
+static String FormatThroughput(uint64 nBytes, uint64 duration)
+{
+	if(duration == 0)
+		return u8"-";
+	uint64 kibPerSecond = uint64(float64(nBytes) * 1000000000.0 / float64(duration) / 1024.0);
+	return String::Number(kibPerSecond) + u8" KiB/s";
+}
+
+//Public methods
+bool BatchTranscoder::LoadManifest(const FileSystem::Path& manifestPath)
+{
+	FileSystem::File file(manifestPath);
+	if(!file.Exists())
+	{
+		stdErr << "File '" << manifestPath << "' does not exist." << endl;
+		return false;
+	}
+
+	FileInputStream inputStream(manifestPath);
+	BufferedInputStream bufferedInputStream(inputStream);
+	TextReader textReader(bufferedInputStream, TextCodecType::UTF8);
+
+	uint32 lineNumber = 0;
+	while(!bufferedInputStream.IsAtEnd())
+	{
+		String line = textReader.ReadLine();
+		lineNumber++;
+
+		if(line.IsEmpty() || line.StartsWith(u8"#"))
+			continue;
+
+		DynamicArray<String> fields = line.Split(u8"\t");
+		if(fields.GetNumberOfElements() < 2)
+		{
+			stdErr << "Line " << lineNumber << " of manifest '" << manifestPath << "' needs at least an input and an output file." << endl;
+			return false;
+		}
+
+		BatchJob* job = new BatchJob(fields.GetNumberOfElements());
+		for(uint32 i = 0; i < fields.GetNumberOfElements(); i++)
+			job->args[i] = fields[i];
+		job->valid = CheckArguments(job->args);
+		if(!job->valid)
+			stdErr << "Line " << lineNumber << " of manifest '" << manifestPath << "' has invalid arguments. The job is skipped." << endl;
+		this->jobs.Push(job);
+	}
+
+	return true;
+}
+
+void BatchTranscoder::PrintReport() const
+{
+	uint32 nSucceeded = 0;
+	uint64 nBytesRead = 0;
+	uint64 nBytesWritten = 0;
+	uint64 cumulatedJobDuration = 0;
+	for(const auto& job : this->jobs)
+	{
+		if(!job->result.succeeded)
+			continue;
+		nSucceeded++;
+		nBytesRead += job->result.nBytesRead;
+		nBytesWritten += job->result.nBytesWritten;
+		cumulatedJobDuration += job->result.duration;
+	}
+
+	stdOut << u8"Batch summary:" << endl
+		<< u8"  Jobs: " << nSucceeded << u8" succeeded, " << (this->jobs.GetNumberOfElements() - nSucceeded) << u8" failed" << endl
+		<< u8"  Wall time: " << (this->duration / 1000000) << u8" ms (cumulated job time: " << (cumulatedJobDuration / 1000000) << u8" ms)" << endl
+		<< u8"  Read: " << nBytesRead << u8" bytes, " << FormatThroughput(nBytesRead, this->duration) << endl
+		<< u8"  Written: " << nBytesWritten << u8" bytes, " << FormatThroughput(nBytesWritten, this->duration) << endl
+		<< u8"  Jobs per second: " << (this->duration ? uint64(float64(nSucceeded) * 1000000000.0 / float64(this->duration)) : 0) << endl;
+}
+
+void BatchTranscoder::ProcessJobs()
+{
+	while(true)
+	{
+		BatchJob* job = this->TakeNextJob();
+		if(job == nullptr)
+			break;
+
+		TranscoderOptions options;
+		if(job->valid && ParseOptions(job->args, options))
+			job->result = Transcode(job->args, options, false, &this->outputMutex);
+
+		this->PrintJobReport(*job);
+	}
+}
+
+void BatchTranscoder::Run(uint32 nConcurrentJobs)
+{
+	uint64 start = NodeStatistics::QueryTimestamp();
+
+	uint32 nWorkers = Math::Min(nConcurrentJobs, this->jobs.GetNumberOfElements());
+	DynamicArray<UniquePointer<BatchWorker>> workers;
+	for(uint32 i = 0; i < nWorkers; i++)
+		workers.Push(new BatchWorker(*this));
+
+	for(auto& worker : workers)
+		worker->Start();
+	for(auto& worker : workers)
+		worker->Join();
+
+	this->duration = NodeStatistics::QueryTimestamp() - start;
+}
+
+//Private methods
+void BatchTranscoder::PrintJobReport(const BatchJob& job)
+{
+	AutoLock lock(this->outputMutex);
+	this->nFinishedJobs++;
+
+	const String& input = job.args[0];
+	const String& output = job.args[job.args.GetNumberOfElements() - 1];
+	stdOut << u8"[" << this->nFinishedJobs << u8"/" << this->jobs.GetNumberOfElements() << u8"] " << input << u8" -> " << output << u8": ";
+	if(job.result.succeeded)
+	{
+		stdOut << (job.result.duration / 1000000) << u8" ms, read " << FormatThroughput(job.result.nBytesRead, job.result.duration)
+			<< u8", written " << FormatThroughput(job.result.nBytesWritten, job.result.duration) << endl;
+	}
+	else if(job.valid)
+		stdOut << u8"failed" << endl;
+	else
+		stdOut << u8"skipped, invalid arguments" << endl;
+}
+
+BatchJob* BatchTranscoder::TakeNextJob()
+{
+	AutoLock lock(this->mutex);
+
+	if(this->nextJobIndex == this->jobs.GetNumberOfElements())
+		return nullptr;
+	return this->jobs[this->nextJobIndex++].operator->();
+}
\ No newline at end of file
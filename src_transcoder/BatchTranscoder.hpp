@@ -0,0 +1,86 @@
+/*
+ * Copyright (c) 2023-2024 Amir Czwink (amir130@hotmail.de)
+ *
+ * This file is part of AVTools.
+ *
+ * AVTools is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * AVTools is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with AVTools.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#pragma once
+#include <StdXX.hpp>
+//Local
+#include "Transcoder.hpp"
+//Namespaces
+using namespace StdXX;
+
+struct BatchJob
+{
+	FixedArray<String> args;
+	/**
+	 * The arguments passed CheckArguments. Invalid jobs are not run and count as failed.
+	 */
+	bool valid = true;
+	TranscodingResult result;
+
+	//Constructor
+	inline BatchJob(uint32 nArgs) : args(nArgs)
+	{
+	}
+};
+
+/**
+ * Transcodes many input/output pairs within one process. Each job gets its own filter graph, a fixed number of jobs run concurrently.
+ */
+class BatchTranscoder
+{
+public:
+	//Constructor
+	inline BatchTranscoder()
+	{
+		this->nextJobIndex = 0;
+		this->nFinishedJobs = 0;
+		this->duration = 0;
+	}
+
+	//Methods
+	/**
+	 * The manifest has one job per line. The fields of a line are separated by tabs and are the same as the command line arguments of a single
+	 * transcoding, i.e. inputFile [options] outputFile. Empty lines and lines starting with '#' are ignored.
+	 * The arguments of every job are checked right away. Jobs with invalid arguments are reported and skipped, so that they neither stop the
+	 * batch nor are only found after the jobs before them ran.
+	 */
+	bool LoadManifest(const FileSystem::Path& manifestPath);
+	void PrintReport() const;
+	void Run(uint32 nConcurrentJobs);
+
+	/**
+	 * Called by the worker threads until all jobs are processed. A job whose graph can't be built counts as failed, the batch continues.
+	 */
+	void ProcessJobs();
+
+private:
+	//State
+	DynamicArray<UniquePointer<BatchJob>> jobs;
+	Mutex mutex;
+	/**
+	 * Held by the workers while they write to stdOut, so that the lines of concurrent jobs don't interleave
+	 */
+	Mutex outputMutex;
+	uint32 nextJobIndex;
+	uint32 nFinishedJobs;
+	uint64 duration;
+
+	//Methods
+	void PrintJobReport(const BatchJob& job);
+	BatchJob* TakeNextJob();
+};
\ No newline at end of file
@@ -25,6 +25,11 @@ bool DecoderNode::CanProcess() const
     return this->IsDataAvailable();
 }
 
+String DecoderNode::GetName() const
+{
+    return u8"DecoderNode";
+}
+
 PortFormat DecoderNode::GetInputFormat(uint32 inputPortNumber) const
 {
     return {
@@ -44,13 +49,13 @@ PortFormat DecoderNode::GetOutputFormat(uint32 outputPortNumber) const
 void DecoderNode::ProcessNextEntity()
 {
     NodeData data = this->GetNextData();
-    this->decoderContext->Decode(*data.packet);
+    this->decoderContext->Decode(data.GetPacket());
 
     while(this->decoderContext->IsFrameReady())
     {
         NodeData data;
         data.frame = this->decoderContext->GetNextFrame();
 
-        this->outputPorts[0]->AddData(Move(data));
+        this->Emit(0, Move(data));
     }
 }
\ No newline at end of file
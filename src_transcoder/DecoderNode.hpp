@@ -27,11 +27,11 @@ public:
     {
         this->decoderContext = stream->GetDecoderContext();
         this->outputPorts.Resize(1);
-        this->outputPorts[0] = nullptr;
     }
 
     //Methods
     bool CanProcess() const override;
+    String GetName() const override;
     PortFormat GetInputFormat(uint32 inputPortNumber) const override;
     PortFormat GetOutputFormat(uint32 outputPortNumber) const;
     void ProcessNextEntity() override;
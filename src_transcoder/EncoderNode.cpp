@@ -25,6 +25,11 @@ bool EncoderNode::CanProcess() const
     return this->IsDataAvailable();
 }
 
+String EncoderNode::GetName() const
+{
+    return u8"EncoderNode";
+}
+
 PortFormat EncoderNode::GetInputFormat(uint32 inputPortNumber) const
 {
     return {
@@ -44,12 +49,12 @@ PortFormat EncoderNode::GetOutputFormat(uint32 outputPortNumber) const
 void EncoderNode::ProcessNextEntity()
 {
     NodeData data = this->GetNextData();
-    this->encoderContext->Encode(*data.frame);
+    this->encoderContext->Encode(data.GetFrame());
 
     while(this->encoderContext->IsPacketReady())
     {
         NodeData packet;
         packet.packet = this->encoderContext->GetNextPacket();
-        this->outputPorts[0]->AddData(Move(packet));
+        this->Emit(0, Move(packet));
     }
 }
\ No newline at end of file
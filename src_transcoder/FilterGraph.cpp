@@ -18,23 +18,52 @@
  */
 //Class Header
 #include "FilterGraph.hpp"
+//Local
+#include "FilterGraphWorker.hpp"
 
 //Public methods
 void FilterGraph::Run()
 {
-    bool didProcess;
+    FilterGraphWorker worker;
+    for(auto& node : this->nodes)
+    {
+        node->SetScheduler(&worker);
+        worker.AddNode(node.operator->());
+    }
+
+    worker.ProcessUntilFinished();
+
+    for(auto& node : this->nodes)
+        node->SetScheduler(nullptr);
+    this->statistics = worker.GetStatistics();
+}
+
+void FilterGraph::RunParallel(uint32 nThreads)
+{
+    uint32 nWorkers = Math::Min(nThreads, this->nodes.GetNumberOfElements());
 
-    do
+    DynamicArray<UniquePointer<FilterGraphWorker>> workers;
+    for(uint32 i = 0; i < nWorkers; i++)
+        workers.Push(new FilterGraphWorker);
+
+    for(uint32 i = 0; i < this->nodes.GetNumberOfElements(); i++)
     {
-    	didProcess = false;
-        for(auto& node : this->nodes)
-        {
-            if(node->CanProcess())
-            {
-                node->ProcessNextEntity();
-                didProcess = true;
-            }
-        }
+        Node* node = this->nodes[i].operator->();
+        FilterGraphWorker* worker = workers[i % nWorkers].operator->();
+
+        node->SetScheduler(worker);
+        worker->AddNode(node);
     }
-    while(didProcess);
+
+    for(auto& worker : workers)
+        worker->Start();
+    for(auto& worker : workers)
+        worker->Join();
+
+    for(auto& node : this->nodes)
+        node->SetScheduler(nullptr);
+
+    this->statistics = {};
+    for(const auto& worker : workers)
+        this->statistics += worker->GetStatistics();
 }
\ No newline at end of file
@@ -27,15 +27,87 @@ class FilterGraph
 {
 public:
     //Methods
+    /**
+     * Runs all nodes on the calling thread.
+     * Merging nodes (e.g. sinks) consume their inputs in sequence number order, i.e. in the order in which the source read the packets,
+     * regardless of how many nodes lie on the path of each stream. Before RunParallel was added, sinks consumed in order of arrival, which
+     * depended on the order in which the nodes were visited.
+     */
     void Run();
+    /**
+     * Runs the graph on nThreads worker threads. Each node is owned by exactly one worker.
+     * Merging nodes consume in the same order as with Run(), so the output is the same. The exception is output that merging nodes don't
+     * wait for: that of sequence numbers whose retention was given up (see Node::RetainSequence). How it is interleaved with other streams
+     * depends on the scheduling.
+     */
+    void RunParallel(uint32 nThreads);
+
+    //Properties
+    inline const FilterGraphContext& Context() const
+    {
+        return this->context;
+    }
+
+    inline const DynamicArray<UniquePointer<Node>>& Nodes() const
+    {
+        return this->nodes;
+    }
+
+    inline const SchedulingStatistics& Statistics() const
+    {
+        return this->statistics;
+    }
 
     //Inline
     inline void AddNode(Node* node)
     {
+        node->SetContext(&this->context);
         this->nodes.Push(node);
     }
 
+    /**
+     * Records a timeline of the next run. It can be written with WriteTrace afterwards.
+     */
+    inline void EnableTracing()
+    {
+        this->context.trace = new TraceRecorder;
+    }
+
+    /**
+     * Destroys a node that was disconnected from all other nodes. Must only be called before the graph runs.
+     */
+    inline void RemoveNode(Node* node)
+    {
+        for(uint32 i = 0; i < this->nodes.GetNumberOfElements(); i++)
+        {
+            if(this->nodes[i].operator->() == node)
+            {
+                this->nodes.Remove(i);
+                return;
+            }
+        }
+    }
+
+    inline void SetPortCapacity(const PortCapacity& portCapacity)
+    {
+        this->context.portCapacity = portCapacity;
+        if(portCapacity.maxEntities != 0)
+            this->context.sequenceTracker.SetRetentionLimit(portCapacity.maxEntities);
+    }
+
+    inline void SetProfiling(bool profile)
+    {
+        this->context.profile = profile;
+    }
+
+    inline void WriteTrace(OutputStream& outputStream) const
+    {
+        this->context.trace->Write(this->nodes, outputStream);
+    }
+
 private:
     //Members
+    FilterGraphContext context; //must outlive the nodes
     DynamicArray<UniquePointer<Node>> nodes;
+    SchedulingStatistics statistics;
 };
\ No newline at end of file
@@ -21,9 +21,72 @@
 //Local
 #include "DecoderNode.hpp"
 #include "EncoderNode.hpp"
+#include "MappedFileInputStream.hpp"
+#include "AudioRemixNode.hpp"
 #include "AudioResampleNode.hpp"
+#include "AudioSampleRateNode.hpp"
+#include "ParallelDecoderNode.hpp"
+#include "ParallelEncoderNode.hpp"
+#include "PcmEncoderNode.hpp"
+#include "VideoConvertNode.hpp"
+#include "WriteBehindOutputStream.hpp"
+
+//Constants
+/**
+ * Frames per segment of parallel encoders. Long enough that the keyframe at the start of each segment doesn't hurt compression much.
+ */
+static const uint32 c_parallelEncodingSegmentLength = 250;
+
+//Local functions
+static bool IsStreamCopyPossible(const DecodingParameters& sourceParameters, const DecodingParameters& targetParameters)
+{
+	if(sourceParameters.codingFormat != targetParameters.codingFormat)
+		return false;
+
+	switch(sourceParameters.dataType)
+	{
+		case DataType::Audio:
+			if(sourceParameters.audio.sampleRate != targetParameters.audio.sampleRate)
+				return false;
+			if(sourceParameters.audio.sampleFormat != targetParameters.audio.sampleFormat)
+				return false;
+			return true;
+		case DataType::Video:
+			if(sourceParameters.video.pixelFormat != targetParameters.video.pixelFormat)
+				return false;
+			return (sourceParameters.video.size.width == targetParameters.video.size.width) && (sourceParameters.video.size.height == targetParameters.video.size.height);
+		default:
+			return false;
+	}
+}
 
 //Public methods
+void FilterGraphBuilder::BeginBranch()
+{
+	if(this->branching)
+		this->mountPorts = this->branchMountPorts;
+	else
+	{
+		this->branchMountPorts = this->mountPorts;
+		this->branching = true;
+	}
+}
+
+PortFormat FilterGraphBuilder::GetOutputFormat(DataType dataType)
+{
+	MountPort mountPort = this->Follow(this->selectedStreams.Get(dataType));
+	return mountPort.node->GetOutputFormat(mountPort.outputPortNumber);
+}
+
+void FilterGraphBuilder::InsertAudioRemixer(DataType dataType, const DecodingParameters& sourceFormat, const AudioSampleFormat& targetFormat)
+{
+	uint32 sourceStreamIndex = this->selectedStreams.Get(dataType);
+
+	AudioRemixNode* remixNode = new AudioRemixNode(sourceFormat, targetFormat, {});
+	this->filterGraph.AddNode(remixNode);
+	this->SmartConnect(sourceStreamIndex, remixNode, 0);
+}
+
 void FilterGraphBuilder::InsertAudioResampler(DataType dataType, const DecodingParameters& sourceFormat, const AudioSampleFormat& targetFormat)
 {
 	uint32 sourceStreamIndex = this->selectedStreams.Get(dataType);
@@ -33,45 +96,232 @@ void FilterGraphBuilder::InsertAudioResampler(DataType dataType, const DecodingP
 	this->SmartConnect(sourceStreamIndex, resampleNode, 0);
 }
 
-void FilterGraphBuilder::InsertDecoder(DataType dataType)
+bool FilterGraphBuilder::InsertChannelRemixer(uint8 nChannels, const DynamicArray<float32>& matrix)
+{
+	uint32 sourceStreamIndex = this->selectedStreams.Get(DataType::Audio);
+
+	MountPort mountPort = this->Follow(sourceStreamIndex);
+	PortFormat inputFormat = mountPort.node->GetOutputFormat(mountPort.outputPortNumber);
+	if(inputFormat.packetsOrFrames)
+	{
+		stdErr << "Channels can only be remixed after the audio stream was decoded." << endl;
+		return false;
+	}
+
+	const uint8 nInputChannels = inputFormat.frameParameters.audio.sampleFormat->nChannels;
+	if((nChannels == 0) || (!matrix.IsEmpty() && (matrix.GetNumberOfElements() != uint32(nChannels) * nInputChannels)))
+	{
+		stdErr << "A remix matrix needs " << uint32(nChannels) * nInputChannels << " weights, one per output and input channel." << endl;
+		return false;
+	}
+
+	AudioRemixNode* remixNode = new AudioRemixNode(inputFormat.frameParameters, AudioSampleFormat(nChannels, AudioSampleType::Float, true), matrix);
+	this->filterGraph.AddNode(remixNode);
+	this->SmartConnect(sourceStreamIndex, remixNode, 0);
+
+	return true;
+}
+
+bool FilterGraphBuilder::InsertDecoder(DataType dataType, uint32 nThreads)
 {
 	uint32 sourceStreamIndex = this->selectedStreams.Get(dataType);
 	Demuxer* demuxer = this->sourceNode->GetDemuxer();
 	Stream* sourceStream = demuxer->GetStream(sourceStreamIndex);
 
-	DecoderNode* decoderNode = new DecoderNode(sourceStream);
+	MountPort mountPort = this->Follow(sourceStreamIndex);
+	if(!mountPort.node->GetOutputFormat(mountPort.outputPortNumber).packetsOrFrames)
+	{
+		stdErr << "The stream is already decoded." << endl;
+		return false;
+	}
+	const CodingFormat* codingFormat = sourceStream->codingParameters.codingFormat;
+	if((codingFormat == nullptr) || (codingFormat->GetBestMatchingDecoder() == nullptr))
+	{
+		stdErr << "No decoder is available for the coding format." << endl;
+		return false;
+	}
+
+	Node* decoderNode;
+	if(nThreads > 1)
+		decoderNode = new ParallelDecoderNode(sourceStream, nThreads);
+	else
+		decoderNode = new DecoderNode(sourceStream);
 	this->filterGraph.AddNode(decoderNode);
 
 	this->SmartConnect(sourceStreamIndex, decoderNode, 0);
+
+	return true;
 }
 
-void FilterGraphBuilder::InsertEncoder(DataType dataType, CodingFormatId codingFormatId)
+bool FilterGraphBuilder::InsertEncoder(DataType dataType, CodingFormatId codingFormatId, uint32 nThreads)
 {
 	uint32 sourceStreamIndex = this->selectedStreams.Get(dataType);
 
 	EncodingParameters codingParameters = this->sourceNode->GetDemuxer()->GetStream(sourceStreamIndex)->codingParameters;
 	codingParameters.codingFormat = FormatRegistry::Instance().FindCodingFormatById(codingFormatId);
+	if(codingParameters.codingFormat == nullptr)
+	{
+		stdErr << "The coding format is not supported." << endl;
+		return false;
+	}
 
 	switch(codingParameters.dataType)
 	{
 		case DataType::Audio:
-			codingParameters.audio.sampleFormat->sampleType = codingParameters.codingFormat->GetPreferredSampleType();
-			break;
+		{
+			const AudioSampleType sampleType = codingParameters.codingFormat->GetPreferredSampleType();
+			codingParameters.audio.sampleFormat->sampleType = sampleType;
+
+			//filters in front of the encoder might have changed the sample rate or the channel layout
+			MountPort mountPort = this->Follow(sourceStreamIndex);
+			PortFormat inputFormat = mountPort.node->GetOutputFormat(mountPort.outputPortNumber);
+			if(!inputFormat.packetsOrFrames)
+			{
+				codingParameters.audio.sampleRate = inputFormat.frameParameters.audio.sampleRate;
+
+				const uint8 nChannels = inputFormat.frameParameters.audio.sampleFormat->nChannels;
+				if(nChannels != codingParameters.audio.sampleFormat->nChannels)
+					codingParameters.audio.sampleFormat = AudioSampleFormat(nChannels, sampleType, codingParameters.audio.sampleFormat->planar);
+			}
+		}
+		break;
+		case DataType::Video:
+		{
+			//keep the pixel format of the frames that reach the encoder
+			MountPort mountPort = this->Follow(sourceStreamIndex);
+			PortFormat inputFormat = mountPort.node->GetOutputFormat(mountPort.outputPortNumber);
+			if(!inputFormat.packetsOrFrames)
+			{
+				codingParameters.video.pixelFormat = inputFormat.frameParameters.video.pixelFormat;
+				codingParameters.video.size = inputFormat.frameParameters.video.size;
+			}
+		}
+		break;
 		default:
 			NOT_IMPLEMENTED_ERROR; //TODO: implement me
 	}
 
+	//PCM does not need a real encoder. Converting the samples straight into the packets saves the intermediate frame of a resampler
+	if(this->InsertFusedPcmEncoder(sourceStreamIndex, codingFormatId, codingParameters))
+		return true;
+
 	auto encoder = codingParameters.codingFormat->GetBestMatchingEncoder();
 	if(encoder == nullptr)
-		NOT_IMPLEMENTED_ERROR;
+	{
+		stdErr << "No encoder is available for the coding format." << endl;
+		return false;
+	}
 
-	EncoderNode* encoderNode = new EncoderNode(encoder->CreateContext(codingParameters));
+	//the option parser rejects parallel encoding of other streams (see ParallelEncoderNode)
+	ASSERT((nThreads == 1) || (dataType == DataType::Video), u8"Only video can be encoded in parallel segments");
+	Node* encoderNode;
+	if(nThreads > 1)
+		encoderNode = new ParallelEncoderNode(encoder, codingParameters, nThreads, c_parallelEncodingSegmentLength);
+	else
+		encoderNode = new EncoderNode(encoder->CreateContext(codingParameters));
 	this->filterGraph.AddNode(encoderNode);
 
 	this->SmartConnect(sourceStreamIndex, encoderNode, 0);
+
+	return true;
+}
+
+void FilterGraphBuilder::InsertNode(DataType dataType, Node* node)
+{
+	this->filterGraph.AddNode(node);
+	this->SmartConnect(this->selectedStreams.Get(dataType), node, 0);
+}
+
+bool FilterGraphBuilder::InsertPixelFormatConverter(const PixelFormat& pixelFormat, uint32 nThreads)
+{
+	uint32 sourceStreamIndex = this->selectedStreams.Get(DataType::Video);
+
+	MountPort mountPort = this->Follow(sourceStreamIndex);
+	PortFormat inputFormat = mountPort.node->GetOutputFormat(mountPort.outputPortNumber);
+	if(inputFormat.packetsOrFrames)
+	{
+		stdErr << "The pixel format can only be changed after the video stream was decoded." << endl;
+		return false;
+	}
+	if(!inputFormat.frameParameters.video.pixelFormat.HasValue() || !VideoConvertNode::IsSupported(*inputFormat.frameParameters.video.pixelFormat, pixelFormat))
+	{
+		stdErr << "Conversion to the requested pixel format is not supported for this video stream." << endl;
+		return false;
+	}
+
+	VideoConvertNode* convertNode = new VideoConvertNode(inputFormat.frameParameters, pixelFormat, nThreads);
+	this->filterGraph.AddNode(convertNode);
+	this->SmartConnect(sourceStreamIndex, convertNode, 0);
+
+	return true;
+}
+
+bool FilterGraphBuilder::InsertSampleRateConverter(uint32 sampleRate)
+{
+	uint32 sourceStreamIndex = this->selectedStreams.Get(DataType::Audio);
+	Stream* sourceStream = this->sourceNode->GetDemuxer()->GetStream(sourceStreamIndex);
+
+	MountPort mountPort = this->Follow(sourceStreamIndex);
+	PortFormat inputFormat = mountPort.node->GetOutputFormat(mountPort.outputPortNumber);
+	if(inputFormat.packetsOrFrames)
+	{
+		stdErr << "The sample rate can only be changed after the audio stream was decoded." << endl;
+		return false;
+	}
+	if(!AudioSampleRateNode::IsSupported(inputFormat.frameParameters.audio.sampleRate, sampleRate))
+	{
+		stdErr << "Conversion of the sample rate from " << inputFormat.frameParameters.audio.sampleRate << " Hz to " << sampleRate << " Hz is not supported." << endl;
+		return false;
+	}
+	//the filter also runs at the same rate, i.e. the node would not be an identity
+	if(inputFormat.frameParameters.audio.sampleRate == sampleRate)
+		return true;
+
+	AudioSampleRateNode* sampleRateNode = new AudioSampleRateNode(inputFormat.frameParameters, sampleRate, sourceStream->timeScale);
+	this->filterGraph.AddNode(sampleRateNode);
+	this->SmartConnect(sourceStreamIndex, sampleRateNode, 0);
+
+	return true;
 }
 
-bool FilterGraphBuilder::LoadSink(const FileSystem::Path& outputPath)
+bool FilterGraphBuilder::InsertScaler(const Math::Size<uint16>& size, ScalingKernel kernel, uint32 nThreads)
+{
+	uint32 sourceStreamIndex = this->selectedStreams.Get(DataType::Video);
+
+	MountPort mountPort = this->Follow(sourceStreamIndex);
+	PortFormat inputFormat = mountPort.node->GetOutputFormat(mountPort.outputPortNumber);
+	if(inputFormat.packetsOrFrames)
+	{
+		stdErr << "Frames can only be scaled after the video stream was decoded." << endl;
+		return false;
+	}
+	PixelLayout layout;
+	if(!inputFormat.frameParameters.video.pixelFormat.HasValue() || !VideoConvertNode::GetPixelLayout(*inputFormat.frameParameters.video.pixelFormat, layout))
+	{
+		stdErr << "Frames of this pixel format can not be scaled." << endl;
+		return false;
+	}
+
+	VideoScaleNode* scaleNode = new VideoScaleNode(inputFormat.frameParameters, size, kernel, nThreads);
+	this->filterGraph.AddNode(scaleNode);
+	this->SmartConnect(sourceStreamIndex, scaleNode, 0);
+
+	return true;
+}
+
+void FilterGraphBuilder::InsertVideoConverter(DataType dataType, const DecodingParameters& sourceFormat, const PixelFormat& targetPixelFormat)
+{
+	uint32 sourceStreamIndex = this->selectedStreams.Get(dataType);
+
+	if(!VideoConvertNode::IsSupported(*sourceFormat.video.pixelFormat, targetPixelFormat))
+		NOT_IMPLEMENTED_ERROR; //TODO: implement me
+
+	VideoConvertNode* convertNode = new VideoConvertNode(sourceFormat, targetPixelFormat, 1);
+	this->filterGraph.AddNode(convertNode);
+	this->SmartConnect(sourceStreamIndex, convertNode, 0);
+}
+
+bool FilterGraphBuilder::LoadSink(const FileSystem::Path& outputPath, uint32 writeBehindSize)
 {
 	const ContainerFormat* format = FormatRegistry::Instance().FindFormatByFileExtension(outputPath.GetFileExtension());
 	if(!format)
@@ -80,7 +330,12 @@ bool FilterGraphBuilder::LoadSink(const FileSystem::Path& outputPath)
 		return false;
 	}
 
-	FileOutputStream* file = new FileOutputStream(outputPath);
+	SeekableOutputStream* file = new FileOutputStream(outputPath);
+	if(writeBehindSize != 0)
+	{
+		const uint32 nChunks = 4;
+		file = new WriteBehindOutputStream(file, Math::Max(writeBehindSize / nChunks, uint32(64 * 1024)), nChunks);
+	}
 
 	Muxer *pMuxer = format->CreateMuxer(*file);
 	if(!pMuxer)
@@ -93,14 +348,13 @@ bool FilterGraphBuilder::LoadSink(const FileSystem::Path& outputPath)
 	SinkNode *pSink = new SinkNode(format, file, pMuxer);
 
 	this->sinkNode = pSink;
+	this->sinkNodes.Push(pSink);
 	this->filterGraph.AddNode(pSink);
 
-	this->ConnectToSink();
-
-	return true;
+	return this->ConnectToSink();
 }
 
-bool FilterGraphBuilder::LoadSource(const FileSystem::Path& inputPath)
+bool FilterGraphBuilder::LoadSource(const FileSystem::Path& inputPath, bool memoryMapped, uint32 readAheadSize)
 {
 	FileSystem::File file(inputPath);
 	if(!file.Exists())
@@ -109,8 +363,8 @@ bool FilterGraphBuilder::LoadSource(const FileSystem::Path& inputPath)
 		return false;
 	}
 
-	FileInputStream* fileInputStream = new FileInputStream(inputPath);
-	const ContainerFormat *format = FormatRegistry::Instance().ProbeFormat(*fileInputStream);
+	SeekableInputStream* inputStream = OpenInputStream(inputPath, memoryMapped, readAheadSize);
+	const ContainerFormat *format = FormatRegistry::Instance().ProbeFormat(*inputStream);
 	if(!format)
 	{
 		//second try by extension
@@ -122,16 +376,16 @@ bool FilterGraphBuilder::LoadSource(const FileSystem::Path& inputPath)
 		else
 		{
 			stdErr << "No format could be found for file '" << inputPath << "'. Either the format is not supported or this is not a valid media file." << endl;
-			delete fileInputStream;
+			delete inputStream;
 			return false;
 		}
 	}
 
-	Demuxer* demuxer = format->CreateDemuxer(*fileInputStream);
+	Demuxer* demuxer = format->CreateDemuxer(*inputStream);
 	if(!demuxer)
 	{
 		stdErr << "No demuxer is available for format '" << format->GetName() << "'." << endl;
-		delete fileInputStream;
+		delete inputStream;
 		return false;
 	}
 
@@ -141,7 +395,7 @@ bool FilterGraphBuilder::LoadSource(const FileSystem::Path& inputPath)
 		stdErr << "Not all info could be gathered for file '" << inputPath << "'. Expect errors..." << endl;
 	}
 
-	SourceNode* sourceNode = new SourceNode(fileInputStream, demuxer);
+	SourceNode* sourceNode = new SourceNode(inputStream, demuxer);
 
 	this->sourceNode = sourceNode;
 	this->filterGraph.AddNode(sourceNode);
@@ -150,11 +404,145 @@ bool FilterGraphBuilder::LoadSource(const FileSystem::Path& inputPath)
 	return true;
 }
 
+void FilterGraphBuilder::Optimize()
+{
+	//every rewrite might enable others, e.g. removing an identity scaler leaves two pixel format converters back to back that might fuse
+	bool changed = true;
+	while(changed)
+		changed = this->RemoveIdentityNodes() || this->FuseConversions() || this->ReplaceReencodingByStreamCopy();
+
+	this->ConnectDirectlyIfPossible();
+}
+
+bool FilterGraphBuilder::SelectStreams(const DynamicArray<uint32>& streamIndices)
+{
+	Demuxer* demuxer = this->sourceNode->GetDemuxer();
+
+	this->selectedStreams = BinaryTreeMap<DataType, uint32>();
+	for(uint32 streamIndex : streamIndices)
+	{
+		if(streamIndex >= demuxer->GetNumberOfStreams())
+		{
+			stdErr << "The input has no stream " << streamIndex << "." << endl;
+			return false;
+		}
+
+		DataType dataType = demuxer->GetStream(streamIndex)->codingParameters.dataType;
+		if(this->selectedStreams.Contains(dataType))
+		{
+			stdErr << "Only one stream per type can be selected." << endl;
+			return false;
+		}
+		this->selectedStreams[dataType] = streamIndex;
+	}
+
+	return true;
+}
+
+void FilterGraphBuilder::Trim(uint64 startTime, uint64 endTime)
+{
+	const TimeScale nanoseconds(1, 1000000000);
+	Demuxer* demuxer = this->sourceNode->GetDemuxer();
+
+	//the demuxer jumps to the keyframe before startTime using the index of the container, so that the packets before it are not even read
+	if(startTime != 0)
+	{
+		uint64 timestamp = nanoseconds.Rescale(startTime, demuxer->TimeScale());
+		if(demuxer->GetStartTime() != Unsigned<uint64>::Max())
+			timestamp += demuxer->GetStartTime();
+		demuxer->Seek(timestamp, demuxer->TimeScale());
+	}
+
+	//the source still cuts exactly, e.g. for containers without an index where the seek doesn't move
+	for(const auto& kv : this->selectedStreams)
+	{
+		Stream* stream = demuxer->GetStream(kv.value);
+		uint64 offset = (stream->startTime == Unsigned<uint64>::Max()) ? 0 : stream->startTime;
+
+		uint64 streamEndTime = Unsigned<uint64>::Max();
+		if(endTime != Unsigned<uint64>::Max())
+			streamEndTime = offset + nanoseconds.Rescale(endTime, stream->timeScale);
+		this->sourceNode->Trim(kv.value, offset + nanoseconds.Rescale(startTime, stream->timeScale), streamEndTime);
+	}
+}
+
 //Private methods
-void FilterGraphBuilder::ConnectToSink()
+DynamicArray<Node*> FilterGraphBuilder::CollectNodes() const
+{
+	DynamicArray<Node*> nodes;
+	BinaryTreeSet<Node*> visited;
+	LinkedList<Node*> pending;
+	pending.InsertTail(this->sourceNode);
+	while(!pending.IsEmpty())
+	{
+		Node* node = pending.PopFront();
+		if(visited.Contains(node))
+			continue;
+		visited.Insert(node);
+		nodes.Push(node);
+
+		for(uint32 i = 0; i < node->GetOutputPortCount(); i++)
+		{
+			for(const PortLink& link : node->GetOutputLinks(i))
+				pending.InsertTail(link.target);
+		}
+	}
+	return nodes;
+}
+
+void FilterGraphBuilder::ConnectDirectlyIfPossible()
+{
+	//as in ConnectToSink, a single output whose streams all come straight from the source doesn't need the graph
+	if((this->sinkNodes.GetNumberOfElements() != 1) || (this->CollectNodes().GetNumberOfElements() != 2))
+		return;
+
+	//disconnecting leaves the input ports of the sink without source and queue, so that only the direct source keeps it from finishing
+	BinaryTreeMap<uint32, uint32> muxerStreamIndices;
+	for(uint32 i = 0; i < this->sourceNode->GetOutputPortCount(); i++)
+	{
+		DynamicArray<PortLink> links = this->sourceNode->GetOutputLinks(i);
+		for(const PortLink& link : links)
+		{
+			//output ports are source streams, input ports of the sink are muxer streams
+			muxerStreamIndices[i] = link.inputPortNumber;
+			this->sourceNode->DisconnectOutputPortFrom(i, link.target, link.inputPortNumber);
+		}
+	}
+	this->sourceNode->ConnectDirectly(this->sinkNodes[0], muxerStreamIndices);
+}
+
+bool FilterGraphBuilder::ConnectToSink()
 {
 	Demuxer* demuxer = this->sourceNode->GetDemuxer();
 	Muxer* muxer = this->sinkNode->Muxer();
+
+	//checked before the muxer gets any stream, so that an output that can't be written fails the transcoding instead of the process
+	for(const auto& kv : this->selectedStreams)
+	{
+		MountPort mountPort = this->Follow(kv.value);
+		PortFormat format = mountPort.node->GetOutputFormat(mountPort.outputPortNumber);
+		if(!format.packetsOrFrames)
+		{
+			stdErr << "Stream " << kv.value << " is decoded but not encoded again. Add an encode filter in front of the output." << endl;
+			return false;
+		}
+		if(!this->IsCodingFormatSupported(kv.key, this->sinkNode->Format(), format.frameParameters.codingFormat))
+		{
+			stdErr << "Format '" << this->sinkNode->Format()->GetName() << "' can't store the coding format of stream " << kv.value << ". Reencode it with an encode filter." << endl;
+			return false;
+		}
+	}
+
+	//without any filter the packets don't need to go through the graph, the source can write them right away. Only possible for a single output
+	bool streamCopy = !this->branching;
+	BinaryTreeSet<uint32> streamIndices;
+	BinaryTreeMap<uint32, uint32> muxerStreamIndices;
+	for(const auto& kv : this->selectedStreams)
+	{
+		streamCopy &= (this->Follow(kv.value).node == this->sourceNode);
+		streamIndices.Insert(kv.value);
+	}
+
 	for(const auto& kv : this->selectedStreams)
 	{
 		Stream* sourceStream = demuxer->GetStream(kv.value);
@@ -169,46 +557,122 @@ void FilterGraphBuilder::ConnectToSink()
 		muxer->AddStream(destStream);
 
 		MountPort mountPort = this->Follow(kv.value);
-		auto format = mountPort.node->GetOutputFormat(mountPort.outputPortNumber);
-		bool isTargetFormatSupported = this->IsCodingFormatSupported(sourceStream->codingParameters.dataType, this->sinkNode->Format(), format.frameParameters.codingFormat);
-		ASSERT(isTargetFormatSupported, u8"TODO: reencoding necessary");
+		destStream->codingParameters = mountPort.node->GetOutputFormat(mountPort.outputPortNumber).frameParameters;
 
-		destStream->codingParameters = format.frameParameters;
+		//e.g. with --map 0:2 the only source stream 2 becomes stream 0 of the output
+		muxerStreamIndices[kv.value] = muxer->GetNumberOfStreams() - 1;
+		if(!streamCopy)
+			this->SmartConnect(kv.value, this->sinkNode, muxer->GetNumberOfStreams() - 1);
+	}
 
-		if(!format.packetsOrFrames)
+	this->sourceNode->SelectStreams(streamIndices);
+	if(streamCopy)
+		this->sourceNode->ConnectDirectly(this->sinkNode, muxerStreamIndices);
+
+	return true;
+}
+
+MountPort FilterGraphBuilder::FindInput(const Node* node, uint32 inputPortNumber) const
+{
+	for(Node* candidate : this->CollectNodes())
+	{
+		for(uint32 i = 0; i < candidate->GetOutputPortCount(); i++)
 		{
-			NOT_IMPLEMENTED_ERROR; //TODO: encoder required
-			//encoding required
-			destStream->codingParameters.codingFormat = this->sinkNode->Format()->GetPreferredCodingFormat(sourceStream->codingParameters.dataType);
-
-			EncoderNode* pEncoderNode = new EncoderNode(destStream->GetEncoderContext());
-			this->filterGraph.AddNode(pEncoderNode);
-			//this->Connect(kv.value, pEncoderNode);
-			//MountPort mountPort = this->Follow(sourceStreamIndex);
-			//mountPort.node->ConnectOutputPortTo(mountPort.outputPortNumber, target);
+			for(const PortLink& link : candidate->GetOutputLinks(i))
+			{
+				if((link.target == node) && (link.inputPortNumber == inputPortNumber))
+				{
+					return {
+						.node = candidate,
+						.outputPortNumber = i
+					};
+				}
+			}
 		}
-
-		this->SmartConnect(kv.value, this->sinkNode, muxer->GetNumberOfStreams() - 1);
 	}
+
+	return {
+		.node = nullptr,
+		.outputPortNumber = 0
+	};
 }
 
-MountPort FilterGraphBuilder::Follow(uint32 sourceStreamIndex)
+SinkNode* FilterGraphBuilder::FindSinkNode(const Node* node) const
 {
-	Node* prev = this->sourceNode;
-	while(prev->GetOutputLinkTarget(sourceStreamIndex) != nullptr)
+	for(SinkNode* sinkNode : this->sinkNodes)
 	{
-		prev = prev->GetOutputLinkTarget(sourceStreamIndex);
-		if(prev->GetOutputPortCount() != 1)
-			NOT_IMPLEMENTED_ERROR;
-		sourceStreamIndex = 0;
+		if(sinkNode == node)
+			return sinkNode;
 	}
+	return nullptr;
+}
+
+MountPort FilterGraphBuilder::Follow(uint32 sourceStreamIndex)
+{
+	//output ports can feed several nodes, so the chain can't be found by walking the links
+	if(this->mountPorts.Contains(sourceStreamIndex))
+		return this->mountPorts.Get(sourceStreamIndex);
 
 	return {
-		.node = prev,
+		.node = this->sourceNode,
 		.outputPortNumber = sourceStreamIndex
 	};
 }
 
+bool FilterGraphBuilder::FuseConversions()
+{
+	for(Node* node : this->CollectNodes())
+	{
+		//with several consumers, the intermediate result is still needed
+		if((node->GetOutputPortCount() != 1) || (node->GetOutputLinks(0).GetNumberOfElements() != 1))
+			continue;
+		Node* next = node->GetOutputLinks(0)[0].target;
+		Node* fused = node->Fuse(*next);
+		if(fused == nullptr)
+			continue;
+
+		this->filterGraph.AddNode(fused);
+		MountPort input = this->FindInput(node, 0);
+		input.node->DisconnectOutputPortFrom(input.outputPortNumber, node, 0);
+		input.node->ConnectOutputPortTo(input.outputPortNumber, fused, 0);
+		this->Redirect(next, 0, {
+			.node = fused,
+			.outputPortNumber = 0
+		});
+
+		node->DisconnectOutputPortFrom(0, next, 0);
+		this->filterGraph.RemoveNode(next);
+		this->filterGraph.RemoveNode(node);
+		return true;
+	}
+	return false;
+}
+
+bool FilterGraphBuilder::InsertFusedPcmEncoder(uint32 sourceStreamIndex, CodingFormatId codingFormatId, EncodingParameters& codingParameters)
+{
+	AudioSampleType sampleType;
+	if((codingParameters.dataType != DataType::Audio) || !PcmEncoderNode::IsSupported(codingFormatId, sampleType))
+		return false;
+
+	MountPort mountPort = this->Follow(sourceStreamIndex);
+	PortFormat inputFormat = mountPort.node->GetOutputFormat(mountPort.outputPortNumber);
+	if(inputFormat.packetsOrFrames)
+		return false;
+
+	const AudioSampleFormat& sourceFormat = *inputFormat.frameParameters.audio.sampleFormat;
+	AudioSampleFormat targetFormat(sourceFormat.nChannels, sampleType, false);
+	if(!AudioSampleConverter::IsSupported(sourceFormat, targetFormat))
+		return false;
+
+	codingParameters.audio.sampleFormat = targetFormat;
+
+	PcmEncoderNode* encoderNode = new PcmEncoderNode(inputFormat.frameParameters, codingParameters);
+	this->filterGraph.AddNode(encoderNode);
+
+	this->SmartConnect(sourceStreamIndex, encoderNode, 0);
+	return true;
+}
+
 bool FilterGraphBuilder::IsCodingFormatSupported(DataType dataType, const ContainerFormat* containerFormat, const CodingFormat* codingFormat) const
 {
 	auto supportedFormats = containerFormat->GetSupportedCodingFormats(dataType);
@@ -231,6 +695,81 @@ void FilterGraphBuilder::PreselectStreams()
 	}
 }
 
+void FilterGraphBuilder::Redirect(Node* node, uint32 outputPortNumber, const MountPort& input)
+{
+	DynamicArray<PortLink> links = node->GetOutputLinks(outputPortNumber);
+	for(const PortLink& link : links)
+	{
+		node->DisconnectOutputPortFrom(outputPortNumber, link.target, link.inputPortNumber);
+		input.node->ConnectOutputPortTo(input.outputPortNumber, link.target, link.inputPortNumber);
+	}
+}
+
+bool FilterGraphBuilder::RemoveIdentityNodes()
+{
+	for(Node* node : this->CollectNodes())
+	{
+		if(!node->IsIdentity())
+			continue;
+
+		MountPort input = this->FindInput(node, 0);
+		this->Redirect(node, 0, input);
+		this->RemoveNode(node, input);
+		return true;
+	}
+	return false;
+}
+
+void FilterGraphBuilder::RemoveNode(Node* node, const MountPort& input)
+{
+	input.node->DisconnectOutputPortFrom(input.outputPortNumber, node, 0);
+	this->filterGraph.RemoveNode(node);
+}
+
+bool FilterGraphBuilder::ReplaceReencodingByStreamCopy()
+{
+	Demuxer* demuxer = this->sourceNode->GetDemuxer();
+	for(Node* encoder : this->CollectNodes())
+	{
+		//an encoder turns frames into packets, a decoder packets into frames
+		if((encoder->GetInputPortCount() != 1) || (encoder->GetOutputPortCount() != 1))
+			continue;
+		PortFormat encodedFormat = encoder->GetOutputFormat(0);
+		if(encoder->GetInputFormat(0).packetsOrFrames || !encodedFormat.packetsOrFrames)
+			continue;
+
+		MountPort decoded = this->FindInput(encoder, 0);
+		Node* decoder = decoded.node;
+		if((decoder->GetInputPortCount() != 1) || !decoder->GetInputFormat(0).packetsOrFrames || decoder->GetOutputFormat(decoded.outputPortNumber).packetsOrFrames)
+			continue;
+		MountPort packets = this->FindInput(decoder, 0);
+		if(packets.node != this->sourceNode)
+			continue;
+
+		const Stream* sourceStream = demuxer->GetStream(packets.outputPortNumber);
+		if(!IsStreamCopyPossible(sourceStream->codingParameters, encodedFormat.frameParameters))
+			continue;
+
+		bool onlySinks = true;
+		for(const PortLink& link : encoder->GetOutputLinks(0))
+			onlySinks &= (this->FindSinkNode(link.target) != nullptr);
+		if(!onlySinks)
+			continue;
+
+		//the muxers get the packets of the source now, which might come with different codec private data
+		for(const PortLink& link : encoder->GetOutputLinks(0))
+			this->FindSinkNode(link.target)->Muxer()->GetStream(link.inputPortNumber)->codingParameters = sourceStream->codingParameters;
+
+		this->Redirect(encoder, 0, packets);
+		this->RemoveNode(encoder, decoded);
+		//with --tee, the frames might still be needed by other branches
+		if(decoder->GetOutputLinks(decoded.outputPortNumber).IsEmpty())
+			this->RemoveNode(decoder, packets);
+		return true;
+	}
+	return false;
+}
+
 void FilterGraphBuilder::SmartConnect(uint32 sourceStreamIndex, Node* target, uint32 inputPortNumber)
 {
 	MountPort mountPort = this->Follow(sourceStreamIndex);
@@ -246,17 +785,40 @@ void FilterGraphBuilder::SmartConnect(uint32 sourceStreamIndex, Node* target, ui
 			switch(inputFormat.frameParameters.dataType)
 			{
 				case DataType::Audio:
+					if(inputFormat.frameParameters.audio.sampleFormat->nChannels != outputFormat.frameParameters.audio.sampleFormat->nChannels)
+					{
+						this->InsertAudioRemixer(DataType::Audio, outputFormat.frameParameters, *inputFormat.frameParameters.audio.sampleFormat);
+						return this->SmartConnect(sourceStreamIndex, target, inputPortNumber);
+					}
 					if(inputFormat.frameParameters.audio.sampleFormat != outputFormat.frameParameters.audio.sampleFormat)
 					{
 						this->InsertAudioResampler(DataType::Audio, outputFormat.frameParameters, *inputFormat.frameParameters.audio.sampleFormat);
 						return this->SmartConnect(sourceStreamIndex, target, inputPortNumber);
 					}
 					break;
+				case DataType::Video:
+					if(inputFormat.frameParameters.video.pixelFormat != outputFormat.frameParameters.video.pixelFormat)
+					{
+						this->InsertVideoConverter(DataType::Video, outputFormat.frameParameters, *inputFormat.frameParameters.video.pixelFormat);
+						return this->SmartConnect(sourceStreamIndex, target, inputPortNumber);
+					}
+					break;
 				default:
 					NOT_IMPLEMENTED_ERROR; //TODO: implment me
 			}
 		}
 		mountPort.node->ConnectOutputPortTo(mountPort.outputPortNumber, target, inputPortNumber);
+
+		//the sink ends the chain
+		if(target->GetOutputPortCount() != 0)
+		{
+			if(target->GetOutputPortCount() != 1)
+				NOT_IMPLEMENTED_ERROR;
+			this->mountPorts[sourceStreamIndex] = {
+				.node = target,
+				.outputPortNumber = 0
+			};
+		}
 	}
 	else
 		NOT_IMPLEMENTED_ERROR; //TODO: implment me
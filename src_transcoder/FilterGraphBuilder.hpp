@@ -21,6 +21,7 @@
 #include "FilterGraph.hpp"
 #include "SourceNode.hpp"
 #include "SinkNode.hpp"
+#include "VideoScaleNode.hpp"
 //Namespaces
 using namespace StdXX;
 
@@ -36,14 +37,80 @@ public:
 	//Constructor
 	inline FilterGraphBuilder(FilterGraph& filterGraph) : filterGraph(filterGraph)
 	{
+		this->branching = false;
+	}
+
+	//Properties
+	inline const DynamicArray<SinkNode*>& GetSinkNodes() const
+	{
+		return this->sinkNodes;
+	}
+
+	inline const SourceNode* GetSourceNode() const
+	{
+		return this->sourceNode;
+	}
+
+	/**
+	 * Filters can only be inserted for data types that have a selected stream
+	 */
+	inline bool HasSelectedStream(DataType dataType) const
+	{
+		return this->selectedStreams.Contains(dataType);
 	}
 
 	//Methods
+	/**
+	 * Starts the filter chain of another output. All branches continue from where the graph stood at the first call, so that everything
+	 * inserted before (e.g. the decoders) runs only once and its output is shared by the branches.
+	 * Call it before inserting the filters of each branch, then load the sink of the branch.
+	 */
+	void BeginBranch();
+	/**
+	 * The format at the end of the filter chain of the selected stream of a data type
+	 */
+	PortFormat GetOutputFormat(DataType dataType);
+	void InsertAudioRemixer(DataType dataType, const DecodingParameters& sourceFormat, const AudioSampleFormat& targetFormat);
 	void InsertAudioResampler(DataType dataType, const DecodingParameters& sourceFormat, const AudioSampleFormat& targetFormat);
-	void InsertDecoder(DataType dataType);
-	void InsertEncoder(DataType dataType, CodingFormatId codingFormatId);
-	bool LoadSink(const FileSystem::Path& outputPath);
-	bool LoadSource(const FileSystem::Path& inputPath);
+	/**
+	 * @param matrix see AudioRemixNode
+	 */
+	bool InsertChannelRemixer(uint8 nChannels, const DynamicArray<float32>& matrix);
+	/**
+	 * @return false if the stream is decoded already or no decoder is available for its coding format
+	 */
+	bool InsertDecoder(DataType dataType, uint32 nThreads = 1);
+	/**
+	 * @param nThreads encodes segments in parallel if > 1. Only allowed for video
+	 * @return false if no encoder is available for the coding format
+	 */
+	bool InsertEncoder(DataType dataType, CodingFormatId codingFormatId, uint32 nThreads = 1);
+	/**
+	 * Appends a node that was created elsewhere (e.g. by a benchmark) to the filter chain of the selected stream of a data type.
+	 */
+	void InsertNode(DataType dataType, Node* node);
+	bool InsertPixelFormatConverter(const PixelFormat& pixelFormat, uint32 nThreads);
+	bool InsertSampleRateConverter(uint32 sampleRate);
+	bool InsertScaler(const Math::Size<uint16>& size, ScalingKernel kernel, uint32 nThreads);
+	void InsertVideoConverter(DataType dataType, const DecodingParameters& sourceFormat, const PixelFormat& targetPixelFormat);
+	bool LoadSink(const FileSystem::Path& outputPath, uint32 writeBehindSize = 0);
+	bool LoadSource(const FileSystem::Path& inputPath, bool memoryMapped = false, uint32 readAheadSize = 0);
+	/**
+	 * Rewrites the graph so that it does less work for the same output. Identity nodes are removed, adjacent conversions of the same kind
+	 * are fused where that doesn't change a single sample and decoding followed by encoding to the same parameters is replaced by stream copy.
+	 * Call it after all sinks were loaded and before the graph runs. No filters can be inserted afterwards.
+	 */
+	void Optimize();
+	/**
+	 * Replaces the automatic choice of one stream per data type. Must be called before any filter is inserted.
+	 * @param streamIndices at most one stream per data type
+	 */
+	bool SelectStreams(const DynamicArray<uint32>& streamIndices);
+	/**
+	 * Restricts the selected streams to [startTime, endTime) in nanoseconds, relative to the start of the input.
+	 * The demuxer seeks to the keyframe before startTime, the source drops the remaining packets outside of the range.
+	 */
+	void Trim(uint64 startTime, uint64 endTime);
 
 private:
 	//State
@@ -51,11 +118,46 @@ private:
 	FilterGraph& filterGraph;
 	SinkNode* sinkNode;
 	SourceNode* sourceNode;
+	DynamicArray<SinkNode*> sinkNodes;
+	/**
+	 * The ends of the filter chains, by source stream index. Streams without an entry end at the source.
+	 */
+	BinaryTreeMap<uint32, MountPort> mountPorts;
+	bool branching;
+	BinaryTreeMap<uint32, MountPort> branchMountPorts;
 
 	//Methods
-	void ConnectToSink();
+	/**
+	 * @return all nodes that are reachable from the source
+	 */
+	DynamicArray<Node*> CollectNodes() const;
+	void ConnectDirectlyIfPossible();
+	/**
+	 * @return false if a selected stream doesn't end in packets that the format of the sink can store
+	 */
+	bool ConnectToSink();
+	/**
+	 * @return the output port that feeds the input port of node
+	 */
+	MountPort FindInput(const Node* node, uint32 inputPortNumber) const;
+	SinkNode* FindSinkNode(const Node* node) const;
 	MountPort Follow(uint32 sourceStreamIndex);
+	bool FuseConversions();
+	/**
+	 * Inserts a PcmEncoderNode if the coding format is PCM and the decoded samples can be converted to it directly.
+	 */
+	bool InsertFusedPcmEncoder(uint32 sourceStreamIndex, CodingFormatId codingFormatId, EncodingParameters& codingParameters);
 	bool IsCodingFormatSupported(DataType dataType, const ContainerFormat* containerFormat, const CodingFormat* codingFormat) const;
 	void PreselectStreams();
+	/**
+	 * Connects the consumers of the output port of node to input instead.
+	 */
+	void Redirect(Node* node, uint32 outputPortNumber, const MountPort& input);
+	bool RemoveIdentityNodes();
+	/**
+	 * Removes node, which must not have consumers anymore, from the graph. input is the output port that feeds it.
+	 */
+	void RemoveNode(Node* node, const MountPort& input);
+	bool ReplaceReencodingByStreamCopy();
 	void SmartConnect(uint32 sourceStreamIndex, Node* target, uint32 inputPortNumber);
 };
\ No newline at end of file
@@ -0,0 +1,103 @@
+/*
+ * Copyright (c) 2023-2024 Amir Czwink (amir130@hotmail.de)
+ *
+ * This file is part of AVTools.
+ *
+ * AVTools is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * AVTools is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with AVTools.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#pragma once
+#include <atomic>
+#include <StdXX.hpp>
+//Local
+#include "FramePool.hpp"
+#include "SequenceTracker.hpp"
+#include "TraceRecorder.hpp"
+//Namespaces
+using namespace StdXX;
+
+struct PortCapacity
+{
+	/**
+	 * 0 means unlimited
+	 */
+	uint32 maxEntities = 64;
+	/**
+	 * 0 means unlimited
+	 */
+	uint64 maxBytes = 64 * 1024 * 1024;
+};
+
+/**
+ * State that is shared by all nodes of a filter graph.
+ */
+class FilterGraphContext
+{
+public:
+	//Members
+	FramePool framePool;
+	PortCapacity portCapacity;
+	/**
+	 * Measure the time that nodes spend in ProcessNextEntity
+	 */
+	bool profile = false;
+	SequenceTracker sequenceTracker;
+	/**
+	 * nullptr if no timeline is recorded
+	 */
+	UniquePointer<TraceRecorder> trace;
+
+	//Constructor
+	inline FilterGraphContext() : nQueuedEntities(0), nQueuedBytes(0), peakQueuedEntities(0), peakQueuedBytes(0)
+	{
+	}
+
+	//Properties
+	inline uint64 PeakQueuedBytes() const
+	{
+		return this->peakQueuedBytes;
+	}
+
+	inline uint64 PeakQueuedEntities() const
+	{
+		return this->peakQueuedEntities;
+	}
+
+	//Inline
+	inline void OnDataDequeued(uint64 size)
+	{
+		this->nQueuedEntities--;
+		this->nQueuedBytes -= size;
+	}
+
+	inline void OnDataQueued(uint64 size)
+	{
+		UpdatePeak(this->peakQueuedEntities, ++this->nQueuedEntities);
+		UpdatePeak(this->peakQueuedBytes, this->nQueuedBytes += size);
+	}
+
+private:
+	//State
+	std::atomic<uint64> nQueuedEntities;
+	std::atomic<uint64> nQueuedBytes;
+	std::atomic<uint64> peakQueuedEntities;
+	std::atomic<uint64> peakQueuedBytes;
+
+	//Functions
+	static inline void UpdatePeak(std::atomic<uint64>& peak, uint64 value)
+	{
+		uint64 current = peak;
+		while((value > current) && !peak.compare_exchange_weak(current, value))
+			;
+	}
+};
\ No newline at end of file
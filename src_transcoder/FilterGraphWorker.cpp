@@ -0,0 +1,94 @@
+/*
+ * Copyright (c) 2023-2024 Amir Czwink (amir130@hotmail.de)
+ *
+ * This file is part of AVTools.
+ *
+ * AVTools is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * AVTools is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with AVTools.  If not, see <http://www.gnu.org/licenses/>.
+ */
+//Class Header
+#include "FilterGraphWorker.hpp"
+
+//Public methods
+void FilterGraphWorker::AddNode(Node* node)
+{
+    this->nUnfinishedNodes++;
+    this->Notify(*node);
+}
+
+void FilterGraphWorker::Notify(Node& node)
+{
+    AutoLock lock(this->readyLock);
+
+    if(this->queuedNodes.Contains(&node))
+        return;
+    this->queuedNodes.Insert(&node);
+    this->readyNodes.InsertTail(&node);
+    this->readySignal.Signal();
+}
+
+void FilterGraphWorker::ProcessUntilFinished()
+{
+    while(true)
+    {
+        Node* node = this->WaitForReadyNode();
+        if(node == nullptr)
+            break;
+        if(node->IsFinished())
+            continue;
+
+        if(node->IsReady())
+        {
+            this->statistics.nProcessCalls++;
+            if(!node->Process())
+                this->statistics.nWastedProcessCalls++;
+
+            if(node->IsReady())
+            {
+                this->Notify(*node);
+                continue;
+            }
+        }
+
+        //nothing to do for now. Either the node is done or it gets notified as soon as there is something to do or its output was drained
+        if(node->TryFinish())
+        {
+            AutoLock lock(this->readyLock);
+            this->nUnfinishedNodes--;
+        }
+    }
+}
+
+//Protected methods
+int32 FilterGraphWorker::ThreadMain()
+{
+    this->ProcessUntilFinished();
+    return EXIT_SUCCESS;
+}
+
+//Private methods
+Node* FilterGraphWorker::WaitForReadyNode()
+{
+    AutoLock lock(this->readyLock);
+
+    while(this->readyNodes.IsEmpty())
+    {
+        if(this->nUnfinishedNodes == 0)
+            return nullptr;
+        this->readySignal.Wait(this->readyLock);
+    }
+
+    Node* node = this->readyNodes.PopFront();
+    this->queuedNodes.Remove(node);
+    return node;
+}
\ No newline at end of file
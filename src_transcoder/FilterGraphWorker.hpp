@@ -0,0 +1,65 @@
+/*
+ * Copyright (c) 2023-2024 Amir Czwink (amir130@hotmail.de)
+ *
+ * This file is part of AVTools.
+ *
+ * AVTools is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * AVTools is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with AVTools.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#pragma once
+#include <StdXX.hpp>
+//Local
+#include "Node.hpp"
+//Namespaces
+using namespace StdXX;
+
+/**
+ * Processes the nodes it owns. Nodes are only looked at when they were notified, i.e. when they might be able to process.
+ * FilterGraph::Run uses a single worker on the calling thread while FilterGraph::RunParallel starts one thread per worker.
+ */
+class FilterGraphWorker : public Thread, public NodeScheduler
+{
+public:
+    //Constructor
+    inline FilterGraphWorker()
+    {
+        this->nUnfinishedNodes = 0;
+    }
+
+    //Methods
+    void AddNode(Node* node);
+    void Notify(Node& node) override;
+    void ProcessUntilFinished();
+
+    //Inline
+    inline const SchedulingStatistics& GetStatistics() const
+    {
+        return this->statistics;
+    }
+
+protected:
+    //Methods
+    int32 ThreadMain() override;
+
+private:
+    //State
+    Mutex readyLock;
+    ConditionVariable readySignal;
+    LinkedList<Node*> readyNodes;
+    BinaryTreeSet<Node*> queuedNodes;
+    uint32 nUnfinishedNodes;
+    SchedulingStatistics statistics;
+
+    //Methods
+    Node* WaitForReadyNode();
+};
\ No newline at end of file
@@ -0,0 +1,117 @@
+/*
+ * Copyright (c) 2023-2024 Amir Czwink (amir130@hotmail.de)
+ *
+ * This file is part of AVTools.
+ *
+ * AVTools is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * AVTools is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with AVTools.  If not, see <http://www.gnu.org/licenses/>.
+ */
+//Class Header
+#include "FramePool.hpp"
+//Local
+#include "Node.hpp"
+
+//Constants
+static const uint32 c_maxFreeFramesPerBucket = 64;
+
+//Public methods
+void FramePool::AcquireAudioFrame(NodeData& data, const AudioSampleFormat& sampleFormat, uint32 nSamplesPerChannel)
+{
+	AutoLock lock(this->mutex);
+
+	FramePoolBucket& bucket = this->FindAudioBucket(sampleFormat, nSamplesPerChannel);
+	this->HandOut(data, bucket);
+	if(data.frame == nullptr)
+		data.frame = new Frame(new AudioBuffer(nSamplesPerChannel, sampleFormat));
+}
+
+void FramePool::AcquireVideoFrame(NodeData& data, const PixelFormat& pixelFormat, const Math::Size<uint16>& size)
+{
+	AutoLock lock(this->mutex);
+
+	FramePoolBucket& bucket = this->FindVideoBucket(pixelFormat, size);
+	this->HandOut(data, bucket);
+	if(data.frame == nullptr)
+		data.frame = new Frame(new Pixmap(size, pixelFormat));
+}
+
+FramePoolStatistics FramePool::GetStatistics() const
+{
+	AutoLock lock(this->mutex);
+
+	return {
+		.nHits = this->nHits,
+		.nMisses = this->nMisses,
+		.nOutstanding = this->nOutstanding,
+	};
+}
+
+void FramePool::Recycle(UniquePointer<Frame>&& frame, FramePoolBucket& bucket)
+{
+	AutoLock lock(this->mutex);
+
+	this->nOutstanding--;
+	if(bucket.nFreeFrames < bucket.freeFrames.GetNumberOfElements())
+		bucket.freeFrames[bucket.nFreeFrames++] = Move(frame);
+	//else frame is freed when it goes out of scope
+}
+
+//Private methods
+FramePoolBucket& FramePool::FindAudioBucket(const AudioSampleFormat& sampleFormat, uint32 nSamplesPerChannel)
+{
+	for(const auto& bucket : this->audioBuckets)
+	{
+		if((bucket->nSamplesPerChannel == nSamplesPerChannel) && (bucket->sampleFormat == sampleFormat))
+			return bucket->frames;
+	}
+
+	AudioBucket* bucket = new AudioBucket{ .sampleFormat = sampleFormat, .nSamplesPerChannel = nSamplesPerChannel, .frames = FramePoolBucket(c_maxFreeFramesPerBucket) };
+	this->audioBuckets.Push(bucket);
+
+	return bucket->frames;
+}
+
+FramePoolBucket& FramePool::FindVideoBucket(const PixelFormat& pixelFormat, const Math::Size<uint16>& size)
+{
+	for(const auto& bucket : this->videoBuckets)
+	{
+		if((bucket->size == size) && (bucket->pixelFormat == pixelFormat))
+			return bucket->frames;
+	}
+
+	VideoBucket* bucket = new VideoBucket{ .pixelFormat = pixelFormat, .size = size, .frames = FramePoolBucket(c_maxFreeFramesPerBucket) };
+	this->videoBuckets.Push(bucket);
+
+	return bucket->frames;
+}
+
+/**
+ * Leaves the frame of data empty if the bucket has no free frame, the caller allocates one then
+ */
+void FramePool::HandOut(NodeData& data, FramePoolBucket& bucket)
+{
+	ASSERT(data.frame == nullptr, u8"NodeData already has a frame");
+
+	data.framePool = this;
+	data.framePoolBucket = &bucket;
+	this->nOutstanding++;
+
+	if(bucket.nFreeFrames == 0)
+	{
+		this->nMisses++;
+		return;
+	}
+
+	this->nHits++;
+	data.frame = Move(bucket.freeFrames[--bucket.nFreeFrames]);
+}
\ No newline at end of file
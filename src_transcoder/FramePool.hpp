@@ -0,0 +1,105 @@
+/*
+ * Copyright (c) 2023-2024 Amir Czwink (amir130@hotmail.de)
+ *
+ * This file is part of AVTools.
+ *
+ * AVTools is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * AVTools is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with AVTools.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#pragma once
+#include <StdXX.hpp>
+//Namespaces
+using namespace StdXX;
+using namespace StdXX::Multimedia;
+
+//Forward declarations
+struct NodeData;
+
+struct FramePoolStatistics
+{
+	uint64 nHits;
+	uint64 nMisses;
+	/**
+	 * Frames that were handed out and have not been returned yet.
+	 */
+	uint32 nOutstanding;
+};
+
+/**
+ * The free frames of one format and size. The slots are allocated with the bucket, so that handing out and returning a frame never allocates.
+ * Frames are handed out again in the reverse order of their return, i.e. the one that was used last and is most likely still cached comes first.
+ */
+struct FramePoolBucket
+{
+	FixedArray<UniquePointer<Frame>> freeFrames;
+	uint32 nFreeFrames;
+
+	//Constructor
+	inline FramePoolBucket(uint32 nSlots) : freeFrames(nSlots)
+	{
+		this->nFreeFrames = 0;
+	}
+};
+
+/**
+ * Recycles the frames that nodes of a graph produce themselves (decoders allocate their frames on their own).
+ * Frames are keyed by their format and size. A frame that was acquired from the pool is returned to the bucket it came from when the NodeData
+ * that owns it is destroyed.
+ */
+class FramePool
+{
+	struct AudioBucket
+	{
+		AudioSampleFormat sampleFormat;
+		uint32 nSamplesPerChannel;
+		FramePoolBucket frames;
+	};
+	struct VideoBucket
+	{
+		PixelFormat pixelFormat;
+		Math::Size<uint16> size;
+		FramePoolBucket frames;
+	};
+
+public:
+	//Constructor
+	inline FramePool()
+	{
+		this->nHits = 0;
+		this->nMisses = 0;
+		this->nOutstanding = 0;
+	}
+
+	//Methods
+	/**
+	 * Sets the frame of data, which must not have one yet, and remembers where it is returned to.
+	 */
+	void AcquireAudioFrame(NodeData& data, const AudioSampleFormat& sampleFormat, uint32 nSamplesPerChannel);
+	void AcquireVideoFrame(NodeData& data, const PixelFormat& pixelFormat, const Math::Size<uint16>& size);
+	FramePoolStatistics GetStatistics() const;
+	void Recycle(UniquePointer<Frame>&& frame, FramePoolBucket& bucket);
+
+private:
+	//State
+	mutable Mutex mutex;
+	DynamicArray<UniquePointer<AudioBucket>> audioBuckets;
+	DynamicArray<UniquePointer<VideoBucket>> videoBuckets;
+	uint64 nHits;
+	uint64 nMisses;
+	uint32 nOutstanding;
+
+	//Methods
+	FramePoolBucket& FindAudioBucket(const AudioSampleFormat& sampleFormat, uint32 nSamplesPerChannel);
+	FramePoolBucket& FindVideoBucket(const PixelFormat& pixelFormat, const Math::Size<uint16>& size);
+	void HandOut(NodeData& data, FramePoolBucket& bucket);
+};
\ No newline at end of file
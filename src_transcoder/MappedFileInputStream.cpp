@@ -0,0 +1,128 @@
+/*
+ * Copyright (c) 2023-2024 Amir Czwink (amir130@hotmail.de)
+ *
+ * This file is part of AVTools.
+ *
+ * AVTools is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * AVTools is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with AVTools.  If not, see <http://www.gnu.org/licenses/>.
+ */
+//Class Header
+#include "MappedFileInputStream.hpp"
+//Local
+#include "ReadAheadInputStream.hpp"
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+//Constructor
+MappedFileInputStream::MappedFileInputStream(const FileSystem::Path& path)
+{
+	this->data = nullptr;
+	this->size = 0;
+	this->offset = 0;
+
+	int fd = open(reinterpret_cast<const char*>(path.GetString().ToUTF8().GetRawZeroTerminatedData()), O_RDONLY);
+	if(fd == -1)
+		return;
+
+	struct stat info;
+	//pipes and devices can't be mapped, empty files can't be mapped either
+	if((fstat(fd, &info) == 0) && S_ISREG(info.st_mode) && (info.st_size > 0))
+	{
+		void* mapping = mmap(nullptr, info.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+		if(mapping != MAP_FAILED)
+		{
+			madvise(mapping, info.st_size, MADV_SEQUENTIAL);
+			this->data = static_cast<const uint8*>(mapping);
+			this->size = info.st_size;
+		}
+	}
+
+	//the mapping stays valid after closing
+	close(fd);
+}
+
+//Destructor
+MappedFileInputStream::~MappedFileInputStream()
+{
+	if(this->data)
+		munmap(const_cast<uint8*>(this->data), this->size);
+}
+
+//Public methods
+uint32 MappedFileInputStream::GetBytesAvailable() const
+{
+	return Math::Min(this->size - this->offset, uint64(Unsigned<uint32>::Max()));
+}
+
+bool MappedFileInputStream::IsAtEnd() const
+{
+	return this->offset >= this->size;
+}
+
+uint64 MappedFileInputStream::QueryCurrentOffset() const
+{
+	return this->offset;
+}
+
+uint64 MappedFileInputStream::QueryRemainingBytes() const
+{
+	return this->size - this->offset;
+}
+
+uint64 MappedFileInputStream::QuerySize() const
+{
+	return this->size;
+}
+
+uint32 MappedFileInputStream::ReadBytes(void* destination, uint32 count)
+{
+	uint32 nBytesRead = Math::Min(count, this->GetBytesAvailable());
+	MemCopy(destination, this->data + this->offset, nBytesRead);
+	this->offset += nBytesRead;
+	return nBytesRead;
+}
+
+void MappedFileInputStream::SeekTo(uint64 offset)
+{
+	this->offset = Math::Min(offset, this->size);
+}
+
+uint32 MappedFileInputStream::Skip(uint32 nBytes)
+{
+	uint32 nBytesSkipped = Math::Min(nBytes, this->GetBytesAvailable());
+	this->offset += nBytesSkipped;
+	return nBytesSkipped;
+}
+
+//Functions
+SeekableInputStream* OpenInputStream(const FileSystem::Path& path, bool memoryMapped, uint32 readAheadSize)
+{
+	if(memoryMapped)
+	{
+		MappedFileInputStream* mappedFileInputStream = new MappedFileInputStream(path);
+		if(mappedFileInputStream->IsMapped())
+			return mappedFileInputStream;
+		delete mappedFileInputStream;
+	}
+
+	FileInputStream* fileInputStream = new FileInputStream(path);
+	//a stream of unknown size (e.g. a pipe) would look empty to the read-ahead
+	if((readAheadSize == 0) || (fileInputStream->QuerySize() == 0))
+		return fileInputStream;
+
+	//triple buffering: the demuxer reads one chunk while the other two are being filled
+	const uint32 nChunks = 3;
+	return new ReadAheadInputStream(fileInputStream, Math::Max(readAheadSize / nChunks, uint32(64 * 1024)), nChunks);
+}
\ No newline at end of file
@@ -0,0 +1,68 @@
+/*
+ * Copyright (c) 2023-2024 Amir Czwink (amir130@hotmail.de)
+ *
+ * This file is part of AVTools.
+ *
+ * AVTools is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * AVTools is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with AVTools.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#pragma once
+#include <StdXX.hpp>
+//Namespaces
+using namespace StdXX;
+
+/**
+ * Reads a regular file through a read-only memory mapping instead of read() calls.
+ * Seeking only moves the offset, so demuxers that jump around while gathering stream info don't cause any I/O by themselves.
+ */
+class MappedFileInputStream : public SeekableInputStream
+{
+public:
+	//Constructor
+	MappedFileInputStream(const FileSystem::Path& path);
+
+	//Destructor
+	~MappedFileInputStream();
+
+	//Methods
+	uint32 GetBytesAvailable() const override;
+	bool IsAtEnd() const override;
+	uint64 QueryCurrentOffset() const override;
+	uint64 QueryRemainingBytes() const override;
+	uint64 QuerySize() const override;
+	uint32 ReadBytes(void* destination, uint32 count) override;
+	void SeekTo(uint64 offset) override;
+	uint32 Skip(uint32 nBytes) override;
+
+	//Inline
+	/**
+	 * False if the file could not be mapped, e.g. because it is a pipe or a special file. The stream is empty then.
+	 */
+	inline bool IsMapped() const
+	{
+		return this->data != nullptr;
+	}
+
+private:
+	//Members
+	const uint8* data;
+	uint64 size;
+	uint64 offset;
+};
+
+//Functions
+/**
+ * @param memoryMapped try to map the file. Files that can't be mapped are read through a FileInputStream.
+ * @param readAheadSize if not 0, a FileInputStream is read ahead on a background thread into a window of this many bytes
+ */
+SeekableInputStream* OpenInputStream(const FileSystem::Path& path, bool memoryMapped, uint32 readAheadSize = 0);
\ No newline at end of file
@@ -17,54 +17,343 @@
  * along with AVTools.  If not, see <http://www.gnu.org/licenses/>.
  */
 #pragma once
+#include <atomic>
 #include <StdXX.hpp>
+//Local
+#include "FilterGraphContext.hpp"
+#include "NodeStatistics.hpp"
+#include "PortQueue.hpp"
 //Namespaces
 using namespace StdXX;
 using namespace StdXX::Multimedia;
 
+struct SharedNodeData;
+
 struct NodeData
 {
+    uint64 sequenceNumber;
     UniquePointer<Frame> frame;
     UniquePointer<IPacket> packet;
+    /**
+     * Set if frame was acquired from this pool. It is returned to framePoolBucket when this NodeData is destroyed.
+     */
+    FramePool* framePool = nullptr;
+    FramePoolBucket* framePoolBucket = nullptr;
+    /**
+     * Set instead of frame and packet if the entity was emitted to several consumers. They all reference the same frame or packet, which
+     * is destroyed when the last consumer is done with it. Shared entities must not be modified.
+     */
+    SharedNodeData* shared = nullptr;
+
+    //Constructors
+    NodeData() = default;
+
+    inline NodeData(NodeData&& other) : sequenceNumber(other.sequenceNumber), frame(Move(other.frame)), packet(Move(other.packet)),
+        framePool(other.framePool), framePoolBucket(other.framePoolBucket), shared(other.shared)
+    {
+        other.framePool = nullptr;
+        other.framePoolBucket = nullptr;
+        other.shared = nullptr;
+    }
+
+    inline NodeData(SharedNodeData* shared);
+
+    //Destructor
+    inline ~NodeData()
+    {
+        this->RecycleFrame();
+        this->ReleaseShared();
+    }
+
+    //Operators
+    inline NodeData& operator=(NodeData&& other)
+    {
+        this->RecycleFrame();
+        this->ReleaseShared();
+
+        this->sequenceNumber = other.sequenceNumber;
+        this->frame = Move(other.frame);
+        this->packet = Move(other.packet);
+        this->framePool = other.framePool;
+        other.framePool = nullptr;
+        this->framePoolBucket = other.framePoolBucket;
+        other.framePoolBucket = nullptr;
+        this->shared = other.shared;
+        other.shared = nullptr;
+
+        return *this;
+    }
+
+    //Properties
+    /**
+     * Use these instead of frame and packet to read the input of a node, they also work for shared entities.
+     */
+    inline Frame& GetFrame();
+    inline const Frame& GetFrame() const;
+    inline IPacket& GetPacket();
+    inline const IPacket& GetPacket() const;
+
+    /**
+     * Number of payload bytes that this entity keeps alive.
+     */
+    inline uint64 ComputeSize() const;
+
+private:
+    //Inline
+    inline void RecycleFrame()
+    {
+        if(this->framePool && (this->frame != nullptr))
+            this->framePool->Recycle(Move(this->frame), *this->framePoolBucket);
+    }
+
+    inline void ReleaseShared();
 };
+
+struct SharedNodeData
+{
+    std::atomic<uint32> nReferences;
+    NodeData data;
+
+    //Constructor
+    inline SharedNodeData(NodeData&& data, uint32 nReferences) : nReferences(nReferences), data(Move(data))
+    {
+    }
+};
+
+//NodeData inline methods
+inline NodeData::NodeData(SharedNodeData* shared) : sequenceNumber(shared->data.sequenceNumber), shared(shared)
+{
+}
+
+inline Frame& NodeData::GetFrame()
+{
+    if(this->shared)
+        return *this->shared->data.frame;
+    return *this->frame;
+}
+
+inline const Frame& NodeData::GetFrame() const
+{
+    if(this->shared)
+        return *this->shared->data.frame;
+    return *this->frame;
+}
+
+inline IPacket& NodeData::GetPacket()
+{
+    if(this->shared)
+        return *this->shared->data.packet;
+    return *this->packet;
+}
+
+inline const IPacket& NodeData::GetPacket() const
+{
+    if(this->shared)
+        return *this->shared->data.packet;
+    return *this->packet;
+}
+
+inline uint64 NodeData::ComputeSize() const
+{
+    if(this->shared)
+        return this->shared->data.ComputeSize();
+    if(this->packet != nullptr)
+        return this->packet->GetSize();
+    if(this->frame == nullptr)
+        return 0;
+
+    uint64 size = 0;
+    switch(this->frame->GetType())
+    {
+        case DataType::Audio:
+        {
+            const AudioBuffer* audioBuffer = this->frame->GetAudioBuffer();
+            for(uint8 i = 0; i < audioBuffer->GetNumberOfPlanes(); i++)
+                size += audioBuffer->GetPlaneSize(i);
+        }
+        break;
+        case DataType::Video:
+        {
+            const Pixmap* pixmap = this->frame->GetPixmap();
+            for(uint8 i = 0; i < pixmap->GetPixelFormat().GetNumberOfPlanes(); i++)
+                size += uint64(pixmap->GetLineSize(i)) * pixmap->GetNumberOfLines(i);
+        }
+        break;
+    }
+    return size;
+}
+
+inline void NodeData::ReleaseShared()
+{
+    //the last consumer destroys the entity, which returns a pooled frame to its pool
+    if(this->shared && (--this->shared->nReferences == 0))
+        delete this->shared;
+    this->shared = nullptr;
+}
+
 struct PortFormat
 {
     bool packetsOrFrames;
     DecodingParameters frameParameters;
 };
 
+/**
+ * Connection of an output port to the input port of another node.
+ */
+struct PortLink
+{
+    class Node* target;
+    uint32 inputPortNumber;
+};
+
+struct SchedulingStatistics
+{
+    uint64 nProcessCalls = 0;
+    /**
+     * Calls of ProcessNextEntity that neither consumed nor emitted anything.
+     */
+    uint64 nWastedProcessCalls = 0;
+
+    inline SchedulingStatistics& operator+=(const SchedulingStatistics& other)
+    {
+        this->nProcessCalls += other.nProcessCalls;
+        this->nWastedProcessCalls += other.nWastedProcessCalls;
+        return *this;
+    }
+};
+
+class NodeScheduler
+{
+public:
+    //Destructor
+    virtual ~NodeScheduler(){}
+
+    //Abstract
+    /**
+     * Called whenever the state of node changed in a way that might allow it to process (new input, upstream finished).
+     * May be called from any thread.
+     */
+    virtual void Notify(class Node& node) = 0;
+};
+
 class Node
 {
+    struct InputPort
+    {
+        Node* source = nullptr;
+        UniquePointer<PortQueue<NodeData>> queue;
+    };
+    struct OutputPort
+    {
+        /**
+         * Every entity that is emitted on the port is handed to all links. Empty if nobody is interested in the output.
+         */
+        DynamicArray<PortLink> links;
+    };
+
 public:
+    //Constructor
+    inline Node() : finished(false)
+    {
+        this->mergesInputs = false;
+        this->holdsSequence = false;
+        this->scheduler = nullptr;
+        this->context = nullptr;
+    }
+
     //Destructor
     virtual ~Node(){}
 
     //Abstract
     virtual bool CanProcess() const = 0;
+    virtual String GetName() const = 0;
     virtual PortFormat GetInputFormat(uint32 inputPortNumber) const = 0;
     virtual PortFormat GetOutputFormat(uint32 outputPortNumber) const = 0;
     virtual void ProcessNextEntity() = 0;
 
+    //Overrideable
+    /**
+     * Used by the graph optimizer. Creates a node that has the same effect as this node followed by next, nullptr if they can't be fused.
+     * The fused node must produce bit for bit the same output, i.e. lossy steps such as round trips through a narrower format can't be fused.
+     */
+    virtual Node* Fuse(const Node& next) const
+    {
+        return nullptr;
+    }
+
+    /**
+     * Used by the graph optimizer. Whether the node passes its input through unchanged, i.e. it can be left out.
+     */
+    virtual bool IsIdentity() const
+    {
+        return false;
+    }
+
     //Inline
-    inline void AddData(NodeData&& data)
+    inline void AddData(uint32 inputPortNumber, NodeData&& data, uint64 size)
     {
-        this->inputPortQueue.InsertTail(Move(data));
+        if(this->context->sequenceTracker.Acquire(data.sequenceNumber))
+            this->NotifyMergingNodes();
+
+        this->context->OnDataQueued(size);
+        this->inputPorts[inputPortNumber].queue->Push(Move(data), size);
+        if(this->context->trace != nullptr)
+            this->context->trace->Record(TraceEventType::QueueDepth, *this, this->inputPorts[inputPortNumber].queue->GetNumberOfElements(), inputPortNumber);
+
+        this->NotifyScheduler();
     }
 
+    /**
+     * An output port can be connected to several input ports (fan-out), an input port only to one output port.
+     */
     inline void ConnectOutputPortTo(uint32 outputPortNumber, Node* target, uint32 inputPortNumber)
     {
-        this->outputPorts[outputPortNumber] = target;
+        this->outputPorts[outputPortNumber].links.Push({
+            .target = target,
+            .inputPortNumber = inputPortNumber
+        });
 
         if(target->inputPorts.GetNumberOfElements() <= inputPortNumber)
-        {
             target->inputPorts.Resize(inputPortNumber + 1);
-            target->inputPorts[inputPortNumber] = this;
+
+        InputPort& port = target->inputPorts[inputPortNumber];
+        port.source = this;
+        if(port.queue == nullptr)
+        {
+            //keep some headroom for producers that emit several entities at once
+            uint32 maxEntities = target->context->portCapacity.maxEntities;
+            port.queue = new PortQueue<NodeData>(maxEntities ? 2 * maxEntities : 256);
+        }
+    }
+
+    /**
+     * Reverts ConnectOutputPortTo. Must only be called before the graph runs.
+     */
+    inline void DisconnectOutputPortFrom(uint32 outputPortNumber, Node* target, uint32 inputPortNumber)
+    {
+        DynamicArray<PortLink>& links = this->outputPorts[outputPortNumber].links;
+        for(uint32 i = 0; i < links.GetNumberOfElements(); i++)
+        {
+            if((links[i].target == target) && (links[i].inputPortNumber == inputPortNumber))
+            {
+                links.Remove(i);
+                break;
+            }
         }
+
+        InputPort& port = target->inputPorts[inputPortNumber];
+        port.source = nullptr;
+        port.queue = nullptr;
     }
 
-    inline Node* GetOutputLinkTarget(uint32 index)
+    inline uint32 GetInputPortCount() const
     {
-        return this->outputPorts[index];
+        return this->inputPorts.GetNumberOfElements();
+    }
+
+    inline const DynamicArray<PortLink>& GetOutputLinks(uint32 outputPortNumber) const
+    {
+        return this->outputPorts[outputPortNumber].links;
     }
 
     inline uint32 GetOutputPortCount() const
@@ -72,42 +361,383 @@ public:
         return this->outputPorts.GetNumberOfElements();
     }
 
+    inline uint32 GetQueueHighWaterMark() const
+    {
+        uint32 highWaterMark = 0;
+        for(const auto& port : this->inputPorts)
+        {
+            if(port.queue != nullptr)
+                highWaterMark = Math::Max(highWaterMark, port.queue->GetHighWaterMark());
+        }
+        return highWaterMark;
+    }
+
+    inline const NodeStatistics& GetStatistics() const
+    {
+        return this->statistics;
+    }
+
+    inline bool IsAnyInputPortConnected() const
+    {
+        for(const auto& input : this->inputPorts)
+        {
+            if(input.source)
+                return true;
+        }
+        return false;
+    }
+
+    inline bool IsFinished() const
+    {
+        return this->finished;
+    }
+
+    /**
+     * Must only be called by the node that is connected to the input port.
+     * @return true if the input port reached its capacity. In that case the producer gets notified as soon as the port was drained.
+     */
+    inline bool IsInputPortFull(uint32 inputPortNumber) const
+    {
+        const PortCapacity& capacity = this->context->portCapacity;
+        return this->inputPorts[inputPortNumber].queue->TestFullAndRegisterProducer(capacity.maxEntities, capacity.maxBytes);
+    }
+
+    inline bool IsOutputBlocked() const
+    {
+        for(const auto& port : this->outputPorts)
+        {
+            for(const PortLink& link : port.links)
+            {
+                if(link.target->IsInputPortFull(link.inputPortNumber))
+                    return true;
+            }
+        }
+        return false;
+    }
+
+    /**
+     * Whether the node has something to do and is allowed to do it.
+     */
+    inline bool IsReady() const
+    {
+        return this->CanProcess() && !this->IsOutputBlocked();
+    }
+
+    inline void NotifyScheduler()
+    {
+        if(this->scheduler)
+            this->scheduler->Notify(*this);
+    }
+
+    /**
+     * @return false if the call was wasted, i.e. the node neither consumed nor emitted anything
+     */
+    inline bool Process()
+    {
+        uint64 nTransferredEntitiesBefore = this->statistics.nEntitiesIn + this->statistics.nEntitiesOut;
+        if(this->context->trace != nullptr)
+            this->context->trace->Record(TraceEventType::Begin, *this);
+        if(this->context->profile)
+        {
+            uint64 start = NodeStatistics::QueryTimestamp();
+            this->ProcessNextEntity();
+            this->statistics.AddProcessingTime(NodeStatistics::QueryTimestamp() - start);
+        }
+        else
+            this->ProcessNextEntity();
+
+        if(this->holdsSequence)
+        {
+            this->holdsSequence = false;
+            if(this->context->sequenceTracker.Release(this->heldSequenceNumber))
+                this->NotifyMergingNodes();
+        }
+
+        if(this->context->trace != nullptr)
+            this->context->trace->Record(TraceEventType::End, *this);
+
+        return (this->statistics.nEntitiesIn + this->statistics.nEntitiesOut) != nTransferredEntitiesBefore;
+    }
+
+    inline void SetScheduler(NodeScheduler* scheduler)
+    {
+        this->scheduler = scheduler;
+    }
+
+    inline void SetContext(FilterGraphContext* context)
+    {
+        this->context = context;
+        if(this->mergesInputs)
+            context->sequenceTracker.AddMergingNode(this);
+    }
+
+    /**
+     * Marks the node as finished if it can't process anymore and never will be able to again.
+     * @return true if the node became finished by this call
+     */
+    inline bool TryFinish()
+    {
+        if(this->finished)
+            return false;
+        //the order of the checks is important. Upstream nodes must be checked before the own queue, else data that arrives in between is missed
+        if(this->IsMoreInputFromInputsPortsExpected())
+            return false;
+        if(this->IsAnyDataQueued())
+            return false;
+        if(this->HasBufferedData())
+            return false;
+        if(this->CanProcess())
+            return false;
+
+        this->finished = true;
+        for(const auto& port : this->outputPorts)
+        {
+            for(const PortLink& link : port.links)
+                link.target->NotifyScheduler();
+        }
+        return true;
+    }
+
 protected:
     //Members
-    DynamicArray<Node *> outputPorts;
+    DynamicArray<OutputPort> outputPorts;
+    /**
+     * Sequence number of the entity that is currently processed.
+     * Everything that is emitted inherits it.
+     */
+    uint64 currentSequenceNumber;
+    /**
+     * If true, entities from all input ports are handed out in sequence number order instead of arrival order.
+     */
+    bool mergesInputs;
+
+    //Properties
+    inline FilterGraphContext& Context()
+    {
+        return *this->context;
+    }
+
+    //Overrideable
+    /**
+     * Nodes that keep entities beyond a call of ProcessNextEntity (e.g. while they are processed by other threads) must report them here,
+     * else they might be finished while they still have output to emit.
+     */
+    virtual bool HasBufferedData() const
+    {
+        return false;
+    }
 
     //Inline
+    /**
+     * Accounts an entity that was received without passing through an input port (stream copy).
+     */
+    inline void CountDirectInput(uint64 size)
+    {
+        this->statistics.nEntitiesIn++;
+        this->statistics.nBytesIn += size;
+    }
+
+    /**
+     * Accounts an entity that was handed to another node without passing through an output port (stream copy).
+     */
+    inline void CountDirectOutput(uint64 size)
+    {
+        this->statistics.nEntitiesOut++;
+        this->statistics.nBytesOut += size;
+    }
+
+    inline void Emit(uint32 outputPortNumber, NodeData&& data)
+    {
+        this->statistics.nEntitiesOut++;
+
+        const OutputPort& port = this->outputPorts[outputPortNumber];
+        if(port.links.IsEmpty())
+            return; //nobody is interested in this output
+
+        uint64 size = data.ComputeSize();
+        this->statistics.nBytesOut += size;
+
+        data.sequenceNumber = this->currentSequenceNumber;
+        if((this->context->trace != nullptr) && (this->inputPorts.GetNumberOfElements() == 0))
+            this->context->trace->Record(TraceEventType::FlowStart, *this, data.sequenceNumber);
+
+        if(port.links.GetNumberOfElements() == 1)
+        {
+            port.links[0].target->AddData(port.links[0].inputPortNumber, Move(data), size);
+            return;
+        }
+
+        //fan-out: the consumers share the entity instead of getting copies. Every queue accounts its size though, as each of them keeps it alive
+        SharedNodeData* shared = new SharedNodeData(Move(data), port.links.GetNumberOfElements());
+        for(const PortLink& link : port.links)
+            link.target->AddData(link.inputPortNumber, NodeData(shared), size);
+    }
+
     inline NodeData GetNextData()
     {
-        return this->inputPortQueue.PopFront();
+        uint32 inputPortNumber;
+        return this->GetNextData(inputPortNumber);
+    }
+
+    /**
+     * @param inputPortNumber is set to the port that the entity came from, which merging nodes need to tell their inputs apart
+     */
+    inline NodeData GetNextData(uint32& inputPortNumber)
+    {
+        inputPortNumber = this->FindNextInputPort();
+        InputPort& port = this->inputPorts[inputPortNumber];
+
+        NodeData data;
+        uint64 size = port.queue->Pop(data);
+
+        this->context->OnDataDequeued(size);
+        if(port.queue->TakeWaitingProducer())
+            port.source->NotifyScheduler();
+
+        this->currentSequenceNumber = data.sequenceNumber;
+        this->heldSequenceNumber = data.sequenceNumber;
+        this->holdsSequence = true;
+        this->statistics.nEntitiesIn++;
+        this->statistics.nBytesIn += size;
+
+        if(this->context->trace != nullptr)
+        {
+            this->context->trace->Record(TraceEventType::QueueDepth, *this, port.queue->GetNumberOfElements(), inputPortNumber);
+            this->context->trace->Record((this->outputPorts.GetNumberOfElements() == 0) ? TraceEventType::FlowEnd : TraceEventType::FlowStep, *this, data.sequenceNumber);
+        }
+
+        return data;
     }
 
     inline bool IsDataAvailable() const
     {
-        return !this->inputPortQueue.IsEmpty();
+        if(this->mergesInputs)
+        {
+            //upstream state must be captured before looking at the queues, else data that arrives in between is missed
+            bool moreInputExpected = this->IsMoreInputFromInputsPortsExpected();
+
+            uint64 nextSequenceNumber;
+            if(!this->PeekNextSequenceNumber(nextSequenceNumber))
+                return false;
+            if(!moreInputExpected)
+                return true;
+            if(nextSequenceNumber == SequenceTracker::EndOfStream)
+            {
+                //all queues are empty or hold output of ended streams. An empty one might still receive anything though
+                for(const auto& input : this->inputPorts)
+                {
+                    if(input.source && !input.source->IsFinished() && input.queue->IsEmpty())
+                        return false;
+                }
+                return true;
+            }
+
+            /*
+             * The tracker must be queried after looking at the queues. Entities are acquired before they are pushed and released only after their
+             * successors were pushed. Therefore everything with a smaller sequence number that is not visible in our queues yet is still open.
+             */
+            uint64 smallestOpenSequenceNumber;
+            if(!this->context->sequenceTracker.GetSmallestOpenSequenceNumber(smallestOpenSequenceNumber))
+                return true;
+            return smallestOpenSequenceNumber >= nextSequenceNumber;
+        }
+
+        return this->IsAnyDataQueued();
     }
 
     inline bool IsMoreInputFromInputsPortsExpected() const
     {
         for(const auto& input : this->inputPorts)
         {
-            if(input->IsMoreInputExpected())
+            if(input.source && !input.source->IsFinished())
                 return true;
         }
         return false;
     }
 
+    /**
+     * Keeps the sequence number open until ReleaseDeferredSequence is called, without ever giving it up (unlike RetainSequence).
+     * The node must be able to emit the output that carries the sequence number without waiting for further input, else the graph stalls.
+     */
+    inline void DeferSequence(uint64 sequenceNumber)
+    {
+        this->context->sequenceTracker.Defer(sequenceNumber);
+    }
+
+    inline void ReleaseDeferredSequence(uint64 sequenceNumber)
+    {
+        if(this->context->sequenceTracker.Release(sequenceNumber))
+            this->NotifyMergingNodes();
+    }
+
+    /**
+     * Releases a sequence number that was retained with RetainSequence.
+     */
+    inline void ReleaseSequence(uint64 sequenceNumber)
+    {
+        if(this->context->sequenceTracker.ReleaseRetained(sequenceNumber))
+            this->NotifyMergingNodes();
+    }
+
+    /**
+     * Keeps the sequence number open beyond the current call of ProcessNextEntity, i.e. merging points wait for it until it is released.
+     * Nodes that buffer entities must do this so that the output order does not depend on scheduling.
+     * The retention is given up if the source reads too far ahead (see SequenceTracker::SetRetentionLimit), releasing it is still allowed then.
+     */
+    inline void RetainSequence(uint64 sequenceNumber)
+    {
+        this->context->sequenceTracker.Retain(sequenceNumber);
+    }
+
 
 private:
     //State
-    DynamicArray<Node *> inputPorts;
-    LinkedList<NodeData> inputPortQueue;
+    std::atomic<bool> finished;
+    bool holdsSequence;
+    uint64 heldSequenceNumber;
+    DynamicArray<InputPort> inputPorts;
+    NodeStatistics statistics;
+    NodeScheduler* scheduler;
+    FilterGraphContext* context;
 
     //Inline
-    inline bool IsMoreInputExpected() const
+    inline int32 FindNextInputPort() const
     {
-        if(this->CanProcess())
-            return true;
-        return this->IsMoreInputFromInputsPortsExpected();
+        int32 best = -1;
+        uint64 bestSequenceNumber;
+        for(uint32 i = 0; i < this->inputPorts.GetNumberOfElements(); i++)
+        {
+            const auto& queue = this->inputPorts[i].queue;
+            if((queue == nullptr) || queue->IsEmpty())
+                continue;
+
+            uint64 sequenceNumber = queue->Peek().sequenceNumber;
+            if((best == -1) || (sequenceNumber < bestSequenceNumber))
+            {
+                best = i;
+                bestSequenceNumber = sequenceNumber;
+            }
+        }
+        return best;
+    }
+
+    inline bool IsAnyDataQueued() const
+    {
+        return this->FindNextInputPort() != -1;
+    }
+
+    inline void NotifyMergingNodes()
+    {
+        for(Node* node : this->context->sequenceTracker.GetMergingNodes())
+            node->NotifyScheduler();
+    }
+
+    inline bool PeekNextSequenceNumber(uint64& sequenceNumber) const
+    {
+        int32 inputPortNumber = this->FindNextInputPort();
+        if(inputPortNumber == -1)
+            return false;
+        sequenceNumber = this->inputPorts[inputPortNumber].queue->Peek().sequenceNumber;
+        return true;
     }
 };
\ No newline at end of file
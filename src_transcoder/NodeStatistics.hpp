@@ -0,0 +1,101 @@
+/*
+ * Copyright (c) 2023-2024 Amir Czwink (amir130@hotmail.de)
+ *
+ * This file is part of AVTools.
+ *
+ * AVTools is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * AVTools is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with AVTools.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#pragma once
+#include <chrono>
+#include <StdXX.hpp>
+//Namespaces
+using namespace StdXX;
+
+/**
+ * Counters of a single node. Only the thread that processes the node writes them.
+ */
+class NodeStatistics
+{
+	//log2 buckets with 4 linear sub-buckets each, i.e. a relative error of at most 25%
+	static const uint32 c_nSubBucketBits = 2;
+	static const uint32 c_nBuckets = 64 << c_nSubBucketBits;
+
+public:
+	//Members
+	uint64 nEntitiesIn = 0;
+	uint64 nEntitiesOut = 0;
+	uint64 nBytesIn = 0;
+	uint64 nBytesOut = 0;
+	uint64 nProcessCalls = 0;
+	uint64 totalProcessingTime = 0; //in nanoseconds
+
+	//Inline
+	inline void AddProcessingTime(uint64 nanoseconds)
+	{
+		this->nProcessCalls++;
+		this->totalProcessingTime += nanoseconds;
+		this->histogram[ComputeBucketIndex(nanoseconds)]++;
+	}
+
+	/**
+	 * @return upper bound of the processing time (in nanoseconds) below which the given percentage of calls fall
+	 */
+	inline uint64 ComputePercentile(uint32 percentage) const
+	{
+		if(this->nProcessCalls == 0)
+			return 0;
+
+		uint64 threshold = (this->nProcessCalls * percentage + 99) / 100;
+		uint64 count = 0;
+		for(uint32 i = 0; i < c_nBuckets; i++)
+		{
+			count += this->histogram[i];
+			if(count >= threshold)
+				return ComputeBucketUpperBound(i);
+		}
+		return ComputeBucketUpperBound(c_nBuckets - 1);
+	}
+
+	//Functions
+	static inline uint64 QueryTimestamp()
+	{
+		return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+	}
+
+private:
+	//State
+	uint64 histogram[c_nBuckets] = {};
+
+	//Functions
+	static inline uint32 ComputeBucketIndex(uint64 value)
+	{
+		if(value < (1 << c_nSubBucketBits))
+			return (uint32)value;
+
+		uint32 exponent = 63 - __builtin_clzll(value);
+		uint32 subBucket = (value >> (exponent - c_nSubBucketBits)) & ((1 << c_nSubBucketBits) - 1);
+		return ((exponent - c_nSubBucketBits + 1) << c_nSubBucketBits) + subBucket;
+	}
+
+	static inline uint64 ComputeBucketUpperBound(uint32 index)
+	{
+		if(index < (1 << c_nSubBucketBits))
+			return index;
+
+		uint32 exponent = (index >> c_nSubBucketBits) + c_nSubBucketBits - 1;
+		uint64 subBucket = index & ((1 << c_nSubBucketBits) - 1);
+		uint64 lowerBound = (uint64(1) << exponent) + (subBucket << (exponent - c_nSubBucketBits));
+		return lowerBound + (uint64(1) << (exponent - c_nSubBucketBits)) - 1;
+	}
+};
\ No newline at end of file
@@ -0,0 +1,117 @@
+/*
+ * Copyright (c) 2023-2024 Amir Czwink (amir130@hotmail.de)
+ *
+ * This file is part of AVTools.
+ *
+ * AVTools is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * AVTools is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with AVTools.  If not, see <http://www.gnu.org/licenses/>.
+ */
+//Class Header
+#include "ParallelDecoderNode.hpp"
+
+//Constructor
+ParallelDecoderNode::ParallelDecoderNode(Stream* stream, uint32 nThreads) : SegmentParallelNode(nThreads), codingParameters(stream->codingParameters)
+{
+    this->outputPorts.Resize(1);
+    this->gopStructure = GopStructure::Unknown;
+    this->nKeyframes = 0;
+    this->keyframePts = Unsigned<uint64>::Max();
+    this->atKeyframe = false;
+
+    const Decoder* decoder = this->codingParameters.codingFormat->GetBestMatchingDecoder();
+    for(uint32 i = 0; i < nThreads; i++)
+        this->decoderContexts.Push(decoder->CreateContext(stream->codingParameters));
+}
+
+//Public methods
+String ParallelDecoderNode::GetName() const
+{
+    return u8"ParallelDecoderNode";
+}
+
+PortFormat ParallelDecoderNode::GetInputFormat(uint32 inputPortNumber) const
+{
+    return {
+        .packetsOrFrames = true,
+        .frameParameters = this->codingParameters,
+    };
+}
+
+PortFormat ParallelDecoderNode::GetOutputFormat(uint32 outputPortNumber) const
+{
+    return {
+        .packetsOrFrames = false,
+        .frameParameters = this->codingParameters,
+    };
+}
+
+//Protected methods
+void ParallelDecoderNode::FinishSegment(uint32 workerIndex, LinkedList<NodeData>& output)
+{
+    DecoderContext& decoderContext = *this->decoderContexts[workerIndex];
+
+    decoderContext.Flush();
+    this->CollectFrames(decoderContext, output);
+}
+
+void ParallelDecoderNode::OnSegmentEntityQueued(const NodeData& data)
+{
+    const IPacket& packet = data.GetPacket();
+    if(packet.ContainsKeyframe())
+    {
+        this->nKeyframes++;
+        this->keyframePts = packet.GetPresentationTimestamp();
+        this->atKeyframe = true;
+        return;
+    }
+
+    bool firstAfterKeyframe = this->atKeyframe;
+    this->atKeyframe = false;
+
+    //leading pictures of the first GOP can't be decoded anyway, so only the following GOPs tell the structure
+    if((this->gopStructure == GopStructure::Open) || (this->nKeyframes < 2))
+        return;
+
+    uint64 pts = packet.GetPresentationTimestamp();
+    if((pts == Unsigned<uint64>::Max()) || (this->keyframePts == Unsigned<uint64>::Max()) || (pts < this->keyframePts))
+        this->gopStructure = GopStructure::Open;
+    else if(firstAfterKeyframe && (this->gopStructure == GopStructure::Unknown))
+    {
+        //leading pictures directly follow their keyframe in decoding order
+        this->gopStructure = GopStructure::Closed;
+    }
+}
+
+void ParallelDecoderNode::ProcessSegmentEntity(uint32 workerIndex, NodeData&& data, LinkedList<NodeData>& output)
+{
+    DecoderContext& decoderContext = *this->decoderContexts[workerIndex];
+
+    decoderContext.Decode(data.GetPacket());
+    this->CollectFrames(decoderContext, output);
+}
+
+bool ParallelDecoderNode::StartsNewSegment(const NodeData& data, uint32 nSegmentEntities) const
+{
+    return (this->gopStructure == GopStructure::Closed) && data.GetPacket().ContainsKeyframe() && (nSegmentEntities > 0);
+}
+
+//Private methods
+void ParallelDecoderNode::CollectFrames(DecoderContext& decoderContext, LinkedList<NodeData>& output)
+{
+    while(decoderContext.IsFrameReady())
+    {
+        NodeData data;
+        data.frame = decoderContext.GetNextFrame();
+        output.InsertTail(Move(data));
+    }
+}
\ No newline at end of file
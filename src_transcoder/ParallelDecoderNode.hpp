@@ -0,0 +1,81 @@
+/*
+ * Copyright (c) 2023-2024 Amir Czwink (amir130@hotmail.de)
+ *
+ * This file is part of AVTools.
+ *
+ * AVTools is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * AVTools is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with AVTools.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#pragma once
+#include <StdXX.hpp>
+//Local
+#include "SegmentParallelNode.hpp"
+//Namespaces
+using namespace StdXX;
+using namespace StdXX::Multimedia;
+
+/**
+ * Decodes a stream on several threads, each having its own decoder context. Every keyframe starts a new segment.
+ * Decoders return frames in presentation order and segments are emitted one after another, i.e. the output is in presentation order.
+ *
+ * This only works for closed GOPs. In an open GOP, the pictures that follow the keyframe in decoding order but precede it in presentation order
+ * (leading pictures) reference the previous GOP, which a fresh decoder context doesn't have. Therefore the stream is decoded serially until the
+ * second GOP showed that its keyframe is not followed by leading pictures. If packets lack presentation timestamps or a leading picture shows
+ * up later on, the rest of the stream is decoded serially. In the latter case, the leading pictures of that one GOP were already handed to a
+ * fresh decoder context.
+ */
+class ParallelDecoderNode : public SegmentParallelNode
+{
+public:
+    //Constructor
+    ParallelDecoderNode(Stream* stream, uint32 nThreads);
+
+    //Methods
+    String GetName() const override;
+    PortFormat GetInputFormat(uint32 inputPortNumber) const override;
+    PortFormat GetOutputFormat(uint32 outputPortNumber) const;
+
+protected:
+    //Methods
+    void FinishSegment(uint32 workerIndex, LinkedList<NodeData>& output) override;
+    void OnSegmentEntityQueued(const NodeData& data) override;
+    void ProcessSegmentEntity(uint32 workerIndex, NodeData&& data, LinkedList<NodeData>& output) override;
+    bool StartsNewSegment(const NodeData& data, uint32 nSegmentEntities) const override;
+
+private:
+    enum class GopStructure
+    {
+        Unknown,
+        Closed,
+        Open
+    };
+
+    //Members
+    const DecodingParameters& codingParameters;
+    /**
+     * One per worker
+     */
+    DynamicArray<UniquePointer<DecoderContext>> decoderContexts;
+
+    //State
+    GopStructure gopStructure;
+    uint32 nKeyframes;
+    uint64 keyframePts;
+    /**
+     * No packet followed the last keyframe yet
+     */
+    bool atKeyframe;
+
+    //Methods
+    void CollectFrames(DecoderContext& decoderContext, LinkedList<NodeData>& output);
+};
\ No newline at end of file
@@ -0,0 +1,106 @@
+/*
+ * Copyright (c) 2023-2024 Amir Czwink (amir130@hotmail.de)
+ *
+ * This file is part of AVTools.
+ *
+ * AVTools is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * AVTools is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with AVTools.  If not, see <http://www.gnu.org/licenses/>.
+ */
+//Class Header
+#include "ParallelEncoderNode.hpp"
+
+//Constructor
+ParallelEncoderNode::ParallelEncoderNode(const Encoder* encoder, const EncodingParameters& encodingParameters, uint32 nThreads, uint32 segmentLength)
+    : SegmentParallelNode(nThreads), encoder(encoder), encodingParameters(encodingParameters), segmentLength(segmentLength)
+{
+    this->outputPorts.Resize(1);
+    this->workerStates.Resize(nThreads);
+}
+
+//Public methods
+String ParallelEncoderNode::GetName() const
+{
+    return u8"ParallelEncoderNode";
+}
+
+PortFormat ParallelEncoderNode::GetInputFormat(uint32 inputPortNumber) const
+{
+    return {
+        .packetsOrFrames = false,
+        .frameParameters = this->encodingParameters,
+    };
+}
+
+PortFormat ParallelEncoderNode::GetOutputFormat(uint32 outputPortNumber) const
+{
+    return {
+        .packetsOrFrames = true,
+        .frameParameters = this->encodingParameters
+    };
+}
+
+//Protected methods
+void ParallelEncoderNode::FinishSegment(uint32 workerIndex, LinkedList<NodeData>& output)
+{
+    WorkerState& workerState = this->workerStates[workerIndex];
+    if(workerState.encoderContext == nullptr)
+        return;
+
+    workerState.encoderContext->Flush();
+    this->CollectPackets(workerState, output);
+    workerState.encoderContext = nullptr;
+}
+
+void ParallelEncoderNode::ProcessSegmentEntity(uint32 workerIndex, NodeData&& data, LinkedList<NodeData>& output)
+{
+    WorkerState& workerState = this->workerStates[workerIndex];
+    if(workerState.encoderContext == nullptr)
+    {
+        workerState.encoderContext = this->encoder->CreateContext(this->encodingParameters);
+        workerState.firstFramePts = data.GetFrame().pts;
+        workerState.ptsOffsetKnown = false;
+    }
+
+    workerState.encoderContext->Encode(data.GetFrame());
+    this->CollectPackets(workerState, output);
+}
+
+bool ParallelEncoderNode::StartsNewSegment(const NodeData& data, uint32 nSegmentEntities) const
+{
+    return nSegmentEntities >= this->segmentLength;
+}
+
+//Private methods
+void ParallelEncoderNode::CollectPackets(WorkerState& workerState, LinkedList<NodeData>& output)
+{
+    while(workerState.encoderContext->IsPacketReady())
+    {
+        Packet* packet = workerState.encoderContext->GetNextPacket();
+
+        if(packet->pts != Unsigned<uint64>::Max())
+        {
+            //the first packet of a closed segment is its keyframe, which is also the first frame to be presented
+            if(!workerState.ptsOffsetKnown && (workerState.firstFramePts != Unsigned<uint64>::Max()))
+            {
+                workerState.ptsOffset = int64(workerState.firstFramePts) - int64(packet->pts);
+                workerState.ptsOffsetKnown = true;
+            }
+            if(workerState.ptsOffsetKnown)
+                packet->pts = uint64(int64(packet->pts) + workerState.ptsOffset);
+        }
+
+        NodeData data;
+        data.packet = packet;
+        output.InsertTail(Move(data));
+    }
+}
\ No newline at end of file
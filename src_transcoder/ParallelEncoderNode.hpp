@@ -0,0 +1,77 @@
+/*
+ * Copyright (c) 2023-2024 Amir Czwink (amir130@hotmail.de)
+ *
+ * This file is part of AVTools.
+ *
+ * AVTools is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * AVTools is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with AVTools.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#pragma once
+#include <StdXX.hpp>
+//Local
+#include "SegmentParallelNode.hpp"
+//Namespaces
+using namespace StdXX;
+using namespace StdXX::Multimedia;
+
+/**
+ * Splits the frames into segments of fixed length and encodes every segment with a fresh encoder context on one of several threads.
+ * Each segment therefore starts with a keyframe and is a closed group of pictures. The packets of the segments are emitted one after another.
+ * Encoders that start the timestamps of a fresh context at zero are corrected: the packets of a segment are shifted so that its first packet
+ * gets the timestamp of its first frame, i.e. the timeline continues seamlessly across segment boundaries.
+ * Packets have no decoding timestamp. Packets are emitted in decoding order and no packet refers to a packet of an earlier segment, so the
+ * decoding order stays valid across segment boundaries too.
+ * Only for video. Audio encoders prime every fresh context (e.g. encoder delay), which would insert a gap at every segment boundary.
+ */
+class ParallelEncoderNode : public SegmentParallelNode
+{
+public:
+    //Constructor
+    ParallelEncoderNode(const Encoder* encoder, const EncodingParameters& encodingParameters, uint32 nThreads, uint32 segmentLength);
+
+    //Methods
+    String GetName() const override;
+    PortFormat GetInputFormat(uint32 inputPortNumber) const override;
+    PortFormat GetOutputFormat(uint32 outputPortNumber) const;
+
+protected:
+    //Methods
+    void FinishSegment(uint32 workerIndex, LinkedList<NodeData>& output) override;
+    void ProcessSegmentEntity(uint32 workerIndex, NodeData&& data, LinkedList<NodeData>& output) override;
+    bool StartsNewSegment(const NodeData& data, uint32 nSegmentEntities) const override;
+
+private:
+    //State
+    struct WorkerState
+    {
+        /**
+         * nullptr while the worker has no segment.
+         */
+        UniquePointer<EncoderContext> encoderContext;
+        uint64 firstFramePts;
+        bool ptsOffsetKnown;
+        int64 ptsOffset;
+    };
+
+    //Members
+    const Encoder* encoder;
+    EncodingParameters encodingParameters;
+    uint32 segmentLength;
+    /**
+     * One per worker
+     */
+    DynamicArray<WorkerState> workerStates;
+
+    //Methods
+    void CollectPackets(WorkerState& workerState, LinkedList<NodeData>& output);
+};
\ No newline at end of file
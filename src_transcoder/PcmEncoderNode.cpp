@@ -0,0 +1,110 @@
+/*
+ * Copyright (c) 2023-2024 Amir Czwink (amir130@hotmail.de)
+ *
+ * This file is part of AVTools.
+ *
+ * AVTools is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * AVTools is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with AVTools.  If not, see <http://www.gnu.org/licenses/>.
+ */
+//Class Header
+#include "PcmEncoderNode.hpp"
+//Local
+#include "AudioSampleConverter.hpp"
+
+//Local functions
+#if __BYTE_ORDER__ == __ORDER_BIG_ENDIAN__
+static void SwapByteOrder(uint8* data, uint32 nSamples, uint8 sampleSize)
+{
+    if(sampleSize == 2)
+    {
+        uint16* samples = (uint16*)data;
+        for(uint32 i = 0; i < nSamples; i++)
+            samples[i] = __builtin_bswap16(samples[i]);
+    }
+    else
+    {
+        uint32* samples = (uint32*)data;
+        for(uint32 i = 0; i < nSamples; i++)
+            samples[i] = __builtin_bswap32(samples[i]);
+    }
+}
+#endif
+
+//Public methods
+bool PcmEncoderNode::CanProcess() const
+{
+    return this->IsDataAvailable();
+}
+
+String PcmEncoderNode::GetName() const
+{
+    return u8"PcmEncoderNode";
+}
+
+PortFormat PcmEncoderNode::GetInputFormat(uint32 inputPortNumber) const
+{
+    return {
+        .packetsOrFrames = false,
+        .frameParameters = this->sourceParameters,
+    };
+}
+
+PortFormat PcmEncoderNode::GetOutputFormat(uint32 outputPortNumber) const
+{
+    return {
+        .packetsOrFrames = true,
+        .frameParameters = this->encodingParameters
+    };
+}
+
+void PcmEncoderNode::ProcessNextEntity()
+{
+    NodeData data = this->GetNextData();
+    const AudioBuffer* sourceBuffer = data.GetFrame().GetAudioBuffer();
+    const AudioSampleFormat& sourceFormat = *this->sourceParameters.audio.sampleFormat;
+    const AudioSampleFormat& targetFormat = *this->encodingParameters.audio.sampleFormat;
+
+    uint32 nSamples = sourceBuffer->GetNumberOfSamplesPerChannel() * targetFormat.nChannels;
+    uint8 sampleSize = AudioSampleConverter::GetSampleSize(targetFormat.sampleType);
+
+    Packet* packet = new Packet;
+    packet->Allocate(nSamples * sampleSize);
+    packet->pts = data.GetFrame().pts;
+    AudioSampleConverter::Convert(*sourceBuffer, sourceFormat, packet->GetData(), targetFormat);
+#if __BYTE_ORDER__ == __ORDER_BIG_ENDIAN__
+    //the converter writes host byte order, all supported coding formats are little endian
+    SwapByteOrder(packet->GetData(), nSamples, sampleSize);
+#endif
+
+    NodeData packetData;
+    packetData.packet = packet;
+    this->Emit(0, Move(packetData));
+}
+
+//Class functions
+bool PcmEncoderNode::IsSupported(CodingFormatId codingFormatId, AudioSampleType& sampleType)
+{
+    //only little endian formats, ProcessNextEntity swaps the bytes on big endian hosts
+    switch(codingFormatId)
+    {
+        case CodingFormatId::PCM_Float32LE:
+            sampleType = AudioSampleType::Float;
+            return true;
+        case CodingFormatId::PCM_S16LE:
+            sampleType = AudioSampleType::S16;
+            return true;
+        default:
+            break;
+    }
+    return false;
+}
\ No newline at end of file
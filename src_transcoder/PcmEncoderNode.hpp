@@ -0,0 +1,54 @@
+/*
+ * Copyright (c) 2023-2024 Amir Czwink (amir130@hotmail.de)
+ *
+ * This file is part of AVTools.
+ *
+ * AVTools is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * AVTools is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with AVTools.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#pragma once
+//Local
+#include "Node.hpp"
+
+/**
+ * Encodes frames to interleaved PCM by converting the samples directly into the packet payload.
+ * Accepts frames in any sample format that AudioSampleConverter supports, so that no AudioResampleNode is required in front of it.
+ */
+class PcmEncoderNode : public Node
+{
+public:
+    //Constructor
+    inline PcmEncoderNode(const DecodingParameters& sourceParameters, const EncodingParameters& encodingParameters)
+        : sourceParameters(sourceParameters), encodingParameters(encodingParameters)
+    {
+        this->outputPorts.Resize(1);
+    }
+
+    //Methods
+    bool CanProcess() const override;
+    String GetName() const override;
+    PortFormat GetInputFormat(uint32 inputPortNumber) const override;
+    PortFormat GetOutputFormat(uint32 outputPortNumber) const;
+    void ProcessNextEntity() override;
+
+    //Functions
+    /**
+     * @return true if the coding format is a PCM format that this node can produce. In that case sampleType is set to its sample type.
+     */
+    static bool IsSupported(CodingFormatId codingFormatId, AudioSampleType& sampleType);
+
+private:
+    //Members
+    DecodingParameters sourceParameters;
+    EncodingParameters encodingParameters;
+};
\ No newline at end of file
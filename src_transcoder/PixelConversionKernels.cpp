@@ -0,0 +1,194 @@
+/*
+ * Copyright (c) 2023-2024 Amir Czwink (amir130@hotmail.de)
+ *
+ * This file is part of AVTools.
+ *
+ * AVTools is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * AVTools is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with AVTools.  If not, see <http://www.gnu.org/licenses/>.
+ */
+//Class Header
+#include "PixelConversionKernels.hpp"
+//Global
+#if defined(__x86_64__) || defined(__i386__)
+#define PIXELCONVERSIONKERNELS_X86
+#include <immintrin.h>
+#endif
+
+//Local functions
+static inline uint8 ClampToUInt8(int32 value)
+{
+	return (uint8)((value < 0) ? 0 : ((value > 255) ? 255 : value));
+}
+
+//Scalar kernels
+static void RgbToYCbCrScalar(const uint8* r, const uint8* g, const uint8* b, uint8* y, uint8* cb, uint8* cr, uint32 nPixels)
+{
+	for(uint32 i = 0; i < nPixels; i++)
+	{
+		int32 R = r[i], G = g[i], B = b[i];
+		y[i] = ClampToUInt8(((66 * R + 129 * G + 25 * B + 128) >> 8) + 16);
+		cb[i] = ClampToUInt8(((-38 * R - 74 * G + 112 * B + 128) >> 8) + 128);
+		cr[i] = ClampToUInt8(((112 * R - 94 * G - 18 * B + 128) >> 8) + 128);
+	}
+}
+
+static void YCbCrToRgbScalar(const uint8* y, const uint8* cb, const uint8* cr, uint8* r, uint8* g, uint8* b, uint32 nPixels)
+{
+	for(uint32 i = 0; i < nPixels; i++)
+	{
+		int32 c = int32(y[i]) - 16, d = int32(cb[i]) - 128, e = int32(cr[i]) - 128;
+		int32 luma = 298 * c + 128;
+		r[i] = ClampToUInt8((luma + 409 * e) >> 8);
+		g[i] = ClampToUInt8((luma - 100 * d - 208 * e) >> 8);
+		b[i] = ClampToUInt8((luma + 516 * d) >> 8);
+	}
+}
+
+#ifdef PIXELCONVERSIONKERNELS_X86
+/*
+ * The vector kernels compute the same 32 bit sums as the scalar ones with pmaddwd on pairs of 16 bit samples.
+ * The additive constants are folded into the products by pairing a sample with the constant 1.
+ * packssdw can't saturate because all sums fit into 16 bits after the shift and packuswb clamps like ClampToUInt8.
+ */
+
+//SSE2 kernels
+__attribute__((target("sse2")))
+static inline __m128i CombineSSE2(__m128i pairs0Lo, __m128i pairs0Hi, __m128i coefficients0, __m128i pairs1Lo, __m128i pairs1Hi, __m128i coefficients1, __m128i offset)
+{
+	__m128i lo = _mm_srai_epi32(_mm_add_epi32(_mm_madd_epi16(pairs0Lo, coefficients0), _mm_madd_epi16(pairs1Lo, coefficients1)), 8);
+	__m128i hi = _mm_srai_epi32(_mm_add_epi32(_mm_madd_epi16(pairs0Hi, coefficients0), _mm_madd_epi16(pairs1Hi, coefficients1)), 8);
+	return _mm_add_epi16(_mm_packs_epi32(lo, hi), offset);
+}
+
+__attribute__((target("sse2")))
+static inline __m128i MakeCoefficientPairSSE2(int16 first, int16 second)
+{
+	return _mm_set1_epi32(int32((uint32(uint16(second)) << 16) | uint16(first)));
+}
+
+__attribute__((target("sse2")))
+static void RgbToYCbCrSSE2(const uint8* r, const uint8* g, const uint8* b, uint8* y, uint8* cb, uint8* cr, uint32 nPixels)
+{
+	const __m128i zero = _mm_setzero_si128();
+	const __m128i one = _mm_set1_epi16(1);
+	const __m128i yRG = MakeCoefficientPairSSE2(66, 129), yB1 = MakeCoefficientPairSSE2(25, 128);
+	const __m128i cbRG = MakeCoefficientPairSSE2(-38, -74), cbB1 = MakeCoefficientPairSSE2(112, 128);
+	const __m128i crRG = MakeCoefficientPairSSE2(112, -94), crB1 = MakeCoefficientPairSSE2(-18, 128);
+	const __m128i lumaOffset = _mm_set1_epi16(16), chromaOffset = _mm_set1_epi16(128);
+
+	uint32 i = 0;
+	for(; i + 16 <= nPixels; i += 16)
+	{
+		__m128i r8 = _mm_loadu_si128((const __m128i*)(r + i));
+		__m128i g8 = _mm_loadu_si128((const __m128i*)(g + i));
+		__m128i b8 = _mm_loadu_si128((const __m128i*)(b + i));
+
+		__m128i result[3][2];
+		for(uint8 half = 0; half < 2; half++)
+		{
+			__m128i r16 = half ? _mm_unpackhi_epi8(r8, zero) : _mm_unpacklo_epi8(r8, zero);
+			__m128i g16 = half ? _mm_unpackhi_epi8(g8, zero) : _mm_unpacklo_epi8(g8, zero);
+			__m128i b16 = half ? _mm_unpackhi_epi8(b8, zero) : _mm_unpacklo_epi8(b8, zero);
+
+			__m128i rgLo = _mm_unpacklo_epi16(r16, g16), rgHi = _mm_unpackhi_epi16(r16, g16);
+			__m128i b1Lo = _mm_unpacklo_epi16(b16, one), b1Hi = _mm_unpackhi_epi16(b16, one);
+
+			result[0][half] = CombineSSE2(rgLo, rgHi, yRG, b1Lo, b1Hi, yB1, lumaOffset);
+			result[1][half] = CombineSSE2(rgLo, rgHi, cbRG, b1Lo, b1Hi, cbB1, chromaOffset);
+			result[2][half] = CombineSSE2(rgLo, rgHi, crRG, b1Lo, b1Hi, crB1, chromaOffset);
+		}
+
+		_mm_storeu_si128((__m128i*)(y + i), _mm_packus_epi16(result[0][0], result[0][1]));
+		_mm_storeu_si128((__m128i*)(cb + i), _mm_packus_epi16(result[1][0], result[1][1]));
+		_mm_storeu_si128((__m128i*)(cr + i), _mm_packus_epi16(result[2][0], result[2][1]));
+	}
+	RgbToYCbCrScalar(r + i, g + i, b + i, y + i, cb + i, cr + i, nPixels - i);
+}
+
+__attribute__((target("sse2")))
+static void YCbCrToRgbSSE2(const uint8* y, const uint8* cb, const uint8* cr, uint8* r, uint8* g, uint8* b, uint32 nPixels)
+{
+	const __m128i zero = _mm_setzero_si128();
+	const __m128i one = _mm_set1_epi16(1);
+	const __m128i lumaBias = _mm_set1_epi16(16), chromaBias = _mm_set1_epi16(128);
+	const __m128i luma1 = MakeCoefficientPairSSE2(298, 128);
+	const __m128i rDE = MakeCoefficientPairSSE2(0, 409), gDE = MakeCoefficientPairSSE2(-100, -208), bDE = MakeCoefficientPairSSE2(516, 0);
+
+	uint32 i = 0;
+	for(; i + 16 <= nPixels; i += 16)
+	{
+		__m128i y8 = _mm_loadu_si128((const __m128i*)(y + i));
+		__m128i cb8 = _mm_loadu_si128((const __m128i*)(cb + i));
+		__m128i cr8 = _mm_loadu_si128((const __m128i*)(cr + i));
+
+		__m128i result[3][2];
+		for(uint8 half = 0; half < 2; half++)
+		{
+			__m128i c = _mm_sub_epi16(half ? _mm_unpackhi_epi8(y8, zero) : _mm_unpacklo_epi8(y8, zero), lumaBias);
+			__m128i d = _mm_sub_epi16(half ? _mm_unpackhi_epi8(cb8, zero) : _mm_unpacklo_epi8(cb8, zero), chromaBias);
+			__m128i e = _mm_sub_epi16(half ? _mm_unpackhi_epi8(cr8, zero) : _mm_unpacklo_epi8(cr8, zero), chromaBias);
+
+			__m128i c1Lo = _mm_unpacklo_epi16(c, one), c1Hi = _mm_unpackhi_epi16(c, one);
+			__m128i deLo = _mm_unpacklo_epi16(d, e), deHi = _mm_unpackhi_epi16(d, e);
+
+			result[0][half] = CombineSSE2(c1Lo, c1Hi, luma1, deLo, deHi, rDE, zero);
+			result[1][half] = CombineSSE2(c1Lo, c1Hi, luma1, deLo, deHi, gDE, zero);
+			result[2][half] = CombineSSE2(c1Lo, c1Hi, luma1, deLo, deHi, bDE, zero);
+		}
+
+		_mm_storeu_si128((__m128i*)(r + i), _mm_packus_epi16(result[0][0], result[0][1]));
+		_mm_storeu_si128((__m128i*)(g + i), _mm_packus_epi16(result[1][0], result[1][1]));
+		_mm_storeu_si128((__m128i*)(b + i), _mm_packus_epi16(result[2][0], result[2][1]));
+	}
+	YCbCrToRgbScalar(y + i, cb + i, cr + i, r + i, g + i, b + i, nPixels - i);
+}
+#endif
+
+static PixelConversionKernels CreateScalarKernels()
+{
+	PixelConversionKernels kernels;
+
+	kernels.rgbToYCbCr = RgbToYCbCrScalar;
+	kernels.yCbCrToRgb = YCbCrToRgbScalar;
+
+	return kernels;
+}
+
+static PixelConversionKernels SelectKernels()
+{
+	PixelConversionKernels kernels = CreateScalarKernels();
+
+#ifdef PIXELCONVERSIONKERNELS_X86
+	__builtin_cpu_init();
+	if(__builtin_cpu_supports("sse2"))
+	{
+		kernels.rgbToYCbCr = RgbToYCbCrSSE2;
+		kernels.yCbCrToRgb = YCbCrToRgbSSE2;
+	}
+#endif
+
+	return kernels;
+}
+
+//Class functions
+const PixelConversionKernels& PixelConversionKernels::Get()
+{
+	static const PixelConversionKernels kernels = SelectKernels();
+	return kernels;
+}
+
+const PixelConversionKernels& PixelConversionKernels::GetScalar()
+{
+	static const PixelConversionKernels kernels = CreateScalarKernels();
+	return kernels;
+}
\ No newline at end of file
@@ -0,0 +1,40 @@
+/*
+ * Copyright (c) 2023-2024 Amir Czwink (amir130@hotmail.de)
+ *
+ * This file is part of AVTools.
+ *
+ * AVTools is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * AVTools is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with AVTools.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#pragma once
+#include <StdXX.hpp>
+//Namespaces
+using namespace StdXX;
+
+/**
+ * Inner loops of VideoConvertNode. They work on rows of separate 8-bit R, G, B and Y, Cb, Cr samples at full resolution,
+ * using the BT.601 limited range matrix in 8 bit fixed point.
+ * Vectorized variants are chosen at runtime depending on the features of the CPU and produce bit-exact the same results as the scalar ones.
+ */
+struct PixelConversionKernels
+{
+	void (*rgbToYCbCr)(const uint8* r, const uint8* g, const uint8* b, uint8* y, uint8* cb, uint8* cr, uint32 nPixels);
+	void (*yCbCrToRgb)(const uint8* y, const uint8* cb, const uint8* cr, uint8* r, uint8* g, uint8* b, uint32 nPixels);
+
+	//Functions
+	/**
+	 * The fastest kernels that the CPU supports
+	 */
+	static const PixelConversionKernels& Get();
+	static const PixelConversionKernels& GetScalar();
+};
\ No newline at end of file
@@ -0,0 +1,226 @@
+/*
+ * Copyright (c) 2023-2024 Amir Czwink (amir130@hotmail.de)
+ *
+ * This file is part of AVTools.
+ *
+ * AVTools is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * AVTools is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with AVTools.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#pragma once
+#include <atomic>
+#include <StdXX.hpp>
+//Namespaces
+using namespace StdXX;
+
+/**
+ * Single-producer/single-consumer queue for the input ports of a node.
+ * Entities are stored in a fixed-size ring so that queueing does not allocate. Port capacities are soft limits, i.e. a producer might emit
+ * more entities than the ring can hold (e.g. all frames of one packet). These go to a second, locked ring until the consumer drained it again.
+ * The overflow ring is as large as the main ring from the start and only grows if even that is exceeded, so it doesn't allocate either once
+ * it fits the largest burst.
+ *
+ * Push and the producer side of IsFull must only be called by the producing node, everything else only by the consuming node.
+ */
+template<typename T>
+class PortQueue
+{
+	struct Entry
+	{
+		T data;
+		uint64 size;
+	};
+public:
+	//Constructor
+	inline PortQueue(uint32 capacity) : nQueuedBytes(0), producerWaiting(false), highWaterMark(0), readIndex(0), writeIndex(0), nOverflowEntries(0)
+	{
+		this->capacity = 2;
+		while(this->capacity < capacity)
+			this->capacity <<= 1;
+		this->mask = this->capacity - 1;
+
+		this->entries = new Entry[this->capacity];
+
+		this->overflowCapacity = this->capacity;
+		this->overflowEntries = new Entry[this->overflowCapacity];
+		this->overflowReadIndex = 0;
+		this->overflowWriteIndex = 0;
+	}
+
+	//Destructor
+	inline ~PortQueue()
+	{
+		delete[] this->entries;
+		delete[] this->overflowEntries;
+	}
+
+	//Inline
+	inline uint32 GetHighWaterMark() const
+	{
+		return this->highWaterMark;
+	}
+
+	inline uint32 GetNumberOfElements() const
+	{
+		return uint32(this->writeIndex - this->readIndex) + this->nOverflowEntries;
+	}
+
+	inline uint64 GetNumberOfQueuedBytes() const
+	{
+		return this->nQueuedBytes;
+	}
+
+	inline bool IsEmpty() const
+	{
+		return this->GetNumberOfElements() == 0;
+	}
+
+	/**
+	 * Only to be called by the consumer and only if the queue is not empty.
+	 */
+	inline const T& Peek() const
+	{
+		uint64 readIndex = this->readIndex.load(std::memory_order_relaxed);
+		if(readIndex != this->writeIndex.load(std::memory_order_acquire))
+			return this->entries[readIndex & this->mask].data;
+
+		AutoLock lock(this->overflowLock);
+		return this->overflowEntries[this->overflowReadIndex & (this->overflowCapacity - 1)].data;
+	}
+
+	/**
+	 * Only to be called by the consumer and only if the queue is not empty.
+	 * @return the size that was passed to Push
+	 */
+	inline uint64 Pop(T& data)
+	{
+		uint64 size;
+
+		uint64 readIndex = this->readIndex.load(std::memory_order_relaxed);
+		if(readIndex != this->writeIndex.load(std::memory_order_acquire))
+		{
+			Entry& entry = this->entries[readIndex & this->mask];
+			data = Move(entry.data);
+			size = entry.size;
+			this->readIndex.store(readIndex + 1, std::memory_order_release);
+		}
+		else
+		{
+			//the ring is only empty while entries are in the overflow list if all entries before those have been consumed
+			AutoLock lock(this->overflowLock);
+			Entry& entry = this->overflowEntries[this->overflowReadIndex++ & (this->overflowCapacity - 1)];
+			data = Move(entry.data);
+			size = entry.size;
+			this->nOverflowEntries--;
+		}
+
+		this->nQueuedBytes -= size;
+		return size;
+	}
+
+	/**
+	 * Only to be called by the producer.
+	 */
+	inline void Push(T&& data, uint64 size)
+	{
+		this->nQueuedBytes += size;
+
+		uint32 nElements = this->GetNumberOfElements() + 1;
+		if(nElements > this->highWaterMark)
+			this->highWaterMark = nElements;
+
+		uint64 writeIndex = this->writeIndex.load(std::memory_order_relaxed);
+		//as long as there are entries in the overflow list, new entries must go there too to preserve order
+		if((this->nOverflowEntries == 0) && ((writeIndex - this->readIndex.load(std::memory_order_acquire)) < this->capacity))
+		{
+			Entry& entry = this->entries[writeIndex & this->mask];
+			entry.data = Move(data);
+			entry.size = size;
+			this->writeIndex.store(writeIndex + 1, std::memory_order_release);
+			return;
+		}
+
+		AutoLock lock(this->overflowLock);
+		if((this->overflowWriteIndex - this->overflowReadIndex) == this->overflowCapacity)
+			this->GrowOverflow();
+		Entry& entry = this->overflowEntries[this->overflowWriteIndex++ & (this->overflowCapacity - 1)];
+		entry.data = Move(data);
+		entry.size = size;
+		this->nOverflowEntries++;
+	}
+
+	/**
+	 * Called by the consumer after Pop.
+	 * @return true if the producer found the queue full since the last call and should be notified
+	 */
+	inline bool TakeWaitingProducer()
+	{
+		return this->producerWaiting.exchange(false);
+	}
+
+	/**
+	 * Called by the producer. If the queue is full, the producer is registered so that TakeWaitingProducer reports it after the next Pop.
+	 */
+	inline bool TestFullAndRegisterProducer(uint32 maxEntities, uint64 maxBytes)
+	{
+		if(!this->IsFull(maxEntities, maxBytes))
+			return false;
+		this->producerWaiting = true;
+		//the consumer might have popped before the flag was visible
+		return this->IsFull(maxEntities, maxBytes);
+	}
+
+private:
+	//State
+	uint32 capacity;
+	uint64 mask;
+	Entry* entries;
+	std::atomic<uint64> nQueuedBytes;
+	std::atomic<bool> producerWaiting;
+	std::atomic<uint32> highWaterMark; //only written by the producer
+	//consumer and producer indices live on separate cache lines so that they don't invalidate each other
+	alignas(64) std::atomic<uint64> readIndex;
+	alignas(64) std::atomic<uint64> writeIndex;
+	alignas(64) std::atomic<uint32> nOverflowEntries;
+	mutable Mutex overflowLock;
+	//the overflow ring is guarded by overflowLock
+	uint32 overflowCapacity;
+	Entry* overflowEntries;
+	uint64 overflowReadIndex;
+	uint64 overflowWriteIndex;
+
+	//Inline
+	/**
+	 * Doubles the overflow ring. Only called by the producer with overflowLock held.
+	 */
+	inline void GrowOverflow()
+	{
+		Entry* entries = new Entry[2 * this->overflowCapacity];
+		for(uint64 i = this->overflowReadIndex; i < this->overflowWriteIndex; i++)
+			entries[i - this->overflowReadIndex] = Move(this->overflowEntries[i & (this->overflowCapacity - 1)]);
+		delete[] this->overflowEntries;
+
+		this->overflowEntries = entries;
+		this->overflowWriteIndex -= this->overflowReadIndex;
+		this->overflowReadIndex = 0;
+		this->overflowCapacity *= 2;
+	}
+
+	inline bool IsFull(uint32 maxEntities, uint64 maxBytes) const
+	{
+		if(maxEntities && (this->GetNumberOfElements() >= maxEntities))
+			return true;
+		if(maxBytes && (this->nQueuedBytes >= maxBytes))
+			return true;
+		return false;
+	}
+};
\ No newline at end of file
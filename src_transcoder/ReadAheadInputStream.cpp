@@ -0,0 +1,207 @@
+/*
+ * Copyright (c) 2023-2024 Amir Czwink (amir130@hotmail.de)
+ *
+ * This file is part of AVTools.
+ *
+ * AVTools is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * AVTools is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with AVTools.  If not, see <http://www.gnu.org/licenses/>.
+ */
+//Class Header
+#include "ReadAheadInputStream.hpp"
+
+//ReadAheadWorker protected methods
+int32 ReadAheadWorker::ThreadMain()
+{
+    this->stream.Prefetch();
+    return EXIT_SUCCESS;
+}
+
+//Constructor
+ReadAheadInputStream::ReadAheadInputStream(SeekableInputStream* source, uint32 chunkSize, uint32 nChunks) : source(source)
+{
+    this->size = this->source->QuerySize();
+    this->chunkSize = chunkSize;
+    this->sourceOffset = this->source->QueryCurrentOffset();
+
+    this->shutdown = false;
+    this->offset = this->sourceOffset;
+    this->readPosition = 0;
+    this->readChunkIndex = 0;
+    this->nFilledChunks = 0;
+    this->fetchOffset = this->sourceOffset;
+    this->sourceExhausted = false;
+    this->generation = 0;
+
+    this->chunks.Resize(nChunks);
+    for(Chunk& chunk : this->chunks)
+        chunk.data = new uint8[chunkSize];
+
+    this->worker = new ReadAheadWorker(*this);
+    this->worker->Start();
+}
+
+//Destructor
+ReadAheadInputStream::~ReadAheadInputStream()
+{
+    this->mutex.Lock();
+    this->shutdown = true;
+    this->chunkConsumed.Signal();
+    this->mutex.Unlock();
+
+    this->worker->Join();
+
+    for(const Chunk& chunk : this->chunks)
+        delete[] chunk.data;
+}
+
+//Public methods
+uint32 ReadAheadInputStream::GetBytesAvailable() const
+{
+    return Math::Min(this->size - this->offset, uint64(Unsigned<uint32>::Max()));
+}
+
+bool ReadAheadInputStream::IsAtEnd() const
+{
+    return this->offset >= this->size;
+}
+
+void ReadAheadInputStream::Prefetch()
+{
+    this->mutex.Lock();
+    while(true)
+    {
+        while(!this->shutdown && ((this->nFilledChunks == this->chunks.GetNumberOfElements()) || this->IsFetchingDone()))
+            this->chunkConsumed.Wait(this->mutex);
+        if(this->shutdown)
+            break;
+
+        //the consumer never touches chunks that are not filled, so the chunk can be written without holding the lock
+        uint32 chunkIndex = (this->readChunkIndex + this->nFilledChunks) % this->chunks.GetNumberOfElements();
+        Chunk& chunk = this->chunks[chunkIndex];
+        uint64 generation = this->generation;
+        uint64 offset = this->fetchOffset;
+        this->mutex.Unlock();
+
+        if(offset != this->sourceOffset)
+            this->source->SeekTo(offset);
+        uint32 nBytesRead = this->source->ReadBytes(chunk.data, Math::Min(uint64(this->chunkSize), this->size - offset));
+        this->sourceOffset = offset + nBytesRead;
+
+        this->mutex.Lock();
+        if(generation != this->generation)
+            continue;
+
+        if(nBytesRead == 0)
+            this->sourceExhausted = true;
+        else
+        {
+            chunk.offset = offset;
+            chunk.size = nBytesRead;
+            this->fetchOffset += nBytesRead;
+            this->nFilledChunks++;
+        }
+        this->chunkFilled.Signal();
+    }
+    this->mutex.Unlock();
+}
+
+uint64 ReadAheadInputStream::QueryCurrentOffset() const
+{
+    return this->offset;
+}
+
+uint64 ReadAheadInputStream::QueryRemainingBytes() const
+{
+    return this->size - this->offset;
+}
+
+uint64 ReadAheadInputStream::QuerySize() const
+{
+    return this->size;
+}
+
+uint32 ReadAheadInputStream::ReadBytes(void* destination, uint32 count)
+{
+    uint8* target = static_cast<uint8*>(destination);
+    uint32 nBytesRead = 0;
+    while(nBytesRead < count)
+    {
+        this->mutex.Lock();
+        while((this->nFilledChunks == 0) && !this->IsFetchingDone())
+            this->chunkFilled.Wait(this->mutex);
+        if(this->nFilledChunks == 0)
+        {
+            this->mutex.Unlock();
+            break;
+        }
+        const Chunk& chunk = this->chunks[this->readChunkIndex];
+        this->mutex.Unlock();
+
+        uint32 nBytesToCopy = Math::Min(count - nBytesRead, chunk.size - this->readPosition);
+        MemCopy(target + nBytesRead, chunk.data + this->readPosition, nBytesToCopy);
+        nBytesRead += nBytesToCopy;
+        this->offset += nBytesToCopy;
+        this->readPosition += nBytesToCopy;
+
+        if(this->readPosition == chunk.size)
+        {
+            this->mutex.Lock();
+            this->readChunkIndex = (this->readChunkIndex + 1) % this->chunks.GetNumberOfElements();
+            this->nFilledChunks--;
+            this->readPosition = 0;
+            this->chunkConsumed.Signal();
+            this->mutex.Unlock();
+        }
+    }
+
+    return nBytesRead;
+}
+
+void ReadAheadInputStream::SeekTo(uint64 offset)
+{
+    offset = Math::Min(offset, this->size);
+
+    AutoLock lock(this->mutex);
+    this->offset = offset;
+
+    //drop the chunks before the new offset. If the offset lies within a buffered chunk, nothing needs to be read again
+    while(this->nFilledChunks != 0)
+    {
+        const Chunk& chunk = this->chunks[this->readChunkIndex];
+        if((offset >= chunk.offset) && (offset < chunk.offset + chunk.size))
+        {
+            this->readPosition = offset - chunk.offset;
+            return;
+        }
+
+        this->readChunkIndex = (this->readChunkIndex + 1) % this->chunks.GetNumberOfElements();
+        this->nFilledChunks--;
+    }
+
+    //the offset is not buffered (yet)
+    this->readPosition = 0;
+    this->chunkConsumed.Signal();
+    if(offset == this->fetchOffset)
+        return;
+
+    this->generation++;
+    this->fetchOffset = offset;
+    this->sourceExhausted = false;
+}
+
+uint32 ReadAheadInputStream::Skip(uint32 nBytes)
+{
+    uint64 offset = this->offset;
+    this->SeekTo(offset + nBytes);
+    return this->offset - offset;
+}
\ No newline at end of file
@@ -0,0 +1,115 @@
+/*
+ * Copyright (c) 2023-2024 Amir Czwink (amir130@hotmail.de)
+ *
+ * This file is part of AVTools.
+ *
+ * AVTools is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * AVTools is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with AVTools.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#pragma once
+#include <StdXX.hpp>
+//Namespaces
+using namespace StdXX;
+
+class ReadAheadInputStream;
+
+class ReadAheadWorker : public Thread
+{
+public:
+    //Constructor
+    inline ReadAheadWorker(ReadAheadInputStream& stream) : stream(stream)
+    {
+    }
+
+protected:
+    //Methods
+    int32 ThreadMain() override;
+
+private:
+    //Members
+    ReadAheadInputStream& stream;
+};
+
+/**
+ * Reads the underlying stream sequentially in large chunks on a background thread, so that the demuxer finds the data in memory instead of
+ * waiting for the disk. Chunks form a ring: while the consumer reads one, the worker fills the others.
+ * Seeks within the buffered chunks are free, all other seeks drop the buffered data and restart prefetching at the new offset.
+ *
+ * Only the worker accesses the underlying stream after construction. All methods of the stream interface must be called by one thread only.
+ */
+class ReadAheadInputStream : public SeekableInputStream
+{
+    struct Chunk
+    {
+        uint8* data;
+        uint64 offset;
+        uint32 size;
+    };
+public:
+    //Constructor
+    /**
+     * @param source is owned by the new stream
+     */
+    ReadAheadInputStream(SeekableInputStream* source, uint32 chunkSize, uint32 nChunks);
+
+    //Destructor
+    ~ReadAheadInputStream();
+
+    //Methods
+    uint32 GetBytesAvailable() const override;
+    bool IsAtEnd() const override;
+    /**
+     * Called by the worker thread until the stream is destroyed.
+     */
+    void Prefetch();
+    uint64 QueryCurrentOffset() const override;
+    uint64 QueryRemainingBytes() const override;
+    uint64 QuerySize() const override;
+    uint32 ReadBytes(void* destination, uint32 count) override;
+    void SeekTo(uint64 offset) override;
+    uint32 Skip(uint32 nBytes) override;
+
+private:
+    //Members
+    UniquePointer<SeekableInputStream> source;
+    uint64 size;
+    uint32 chunkSize;
+    DynamicArray<Chunk> chunks;
+    UniquePointer<ReadAheadWorker> worker;
+    Mutex mutex;
+    ConditionVariable chunkFilled;
+    ConditionVariable chunkConsumed;
+
+    //State
+    bool shutdown;
+    //consumer
+    uint64 offset;
+    uint32 readPosition;
+    //shared, protected by mutex
+    uint32 readChunkIndex;
+    uint32 nFilledChunks;
+    uint64 fetchOffset;
+    bool sourceExhausted;
+    /**
+     * Incremented for every seek that drops the buffered chunks, so that the worker discards a chunk it was reading meanwhile.
+     */
+    uint64 generation;
+    //worker
+    uint64 sourceOffset;
+
+    //Inline
+    inline bool IsFetchingDone() const
+    {
+        return (this->fetchOffset >= this->size) || this->sourceExhausted;
+    }
+};
\ No newline at end of file
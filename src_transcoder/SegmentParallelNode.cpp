@@ -0,0 +1,280 @@
+/*
+ * Copyright (c) 2023-2024 Amir Czwink (amir130@hotmail.de)
+ *
+ * This file is part of AVTools.
+ *
+ * AVTools is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * AVTools is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with AVTools.  If not, see <http://www.gnu.org/licenses/>.
+ */
+//Class Header
+#include "SegmentParallelNode.hpp"
+
+//SegmentWorker protected methods
+int32 SegmentWorker::ThreadMain()
+{
+    this->node.ProcessSegments(*this);
+    return EXIT_SUCCESS;
+}
+
+//Constructor
+SegmentParallelNode::SegmentParallelNode(uint32 nThreads)
+{
+    this->shutdown = false;
+    this->openSegment = nullptr;
+    this->hasPendingData = false;
+
+    for(uint32 i = 0; i < nThreads; i++)
+    {
+        SegmentWorker* worker = new SegmentWorker(*this, i);
+        this->workers.Push(worker);
+        worker->Start();
+    }
+}
+
+//Destructor
+SegmentParallelNode::~SegmentParallelNode()
+{
+    /*
+     * A finished node has no segments left and the workers notified the scheduler for the last time while they held the mutex.
+     * I.e. they are idle and don't call into the (already destroyed) subclass or the scheduler anymore.
+     */
+    this->mutex.Lock();
+    this->shutdown = true;
+    for(const auto& worker : this->workers)
+        worker->workAvailable.Signal();
+    this->mutex.Unlock();
+
+    for(const auto& worker : this->workers)
+        worker->Join();
+}
+
+//Public methods
+bool SegmentParallelNode::CanProcess() const
+{
+    AutoLock lock(this->mutex);
+
+    if(!this->segments.IsEmpty())
+    {
+        const ProcessingSegment& head = *this->segments.GetFront();
+        if(!head.output.IsEmpty() || (head.nProcessedEntities != 0) || head.processed)
+            return true;
+    }
+
+    if(this->hasPendingData)
+        return !this->IsNewSegmentRequired(this->pendingData) || (this->FindIdleWorker() != nullptr);
+
+    bool moreInputExpected = this->IsMoreInputFromInputsPortsExpected();
+    if(this->IsDataAvailable())
+        return true;
+    return !moreInputExpected && (this->openSegment != nullptr);
+}
+
+void SegmentParallelNode::ProcessNextEntity()
+{
+    this->EmitProcessedOutput();
+
+    if(!this->hasPendingData)
+    {
+        //upstream state must be captured before looking at the queues, else data that arrives in between is missed
+        bool moreInputExpected = this->IsMoreInputFromInputsPortsExpected();
+        if(this->IsDataAvailable())
+        {
+            this->pendingData = this->GetNextData();
+            this->DeferSequence(this->pendingData.sequenceNumber);
+            this->hasPendingData = true;
+        }
+        else if(!moreInputExpected)
+        {
+            AutoLock lock(this->mutex);
+            if(this->openSegment)
+                this->CompleteOpenSegment(SequenceTracker::EndOfStream);
+        }
+    }
+
+    if(this->hasPendingData)
+        this->QueuePendingData();
+}
+
+void SegmentParallelNode::ProcessSegments(SegmentWorker& worker)
+{
+    this->mutex.Lock();
+    while(true)
+    {
+        while(!this->shutdown && ((worker.segment == nullptr) || (worker.segment->input.IsEmpty() && !worker.segment->complete)))
+            worker.workAvailable.Wait(this->mutex);
+        if(this->shutdown)
+            break;
+
+        ProcessingSegment* segment = worker.segment;
+        bool finish = segment->input.IsEmpty();
+        NodeData data;
+        uint64 sequenceNumber = segment->finishSequenceNumber;
+        if(!finish)
+        {
+            data = segment->input.PopFront();
+            sequenceNumber = data.sequenceNumber;
+        }
+        this->mutex.Unlock();
+
+        LinkedList<NodeData> output;
+        if(finish)
+            this->FinishSegment(worker.index, output);
+        else
+            this->ProcessSegmentEntity(worker.index, Move(data), output);
+
+        this->mutex.Lock();
+        while(!output.IsEmpty())
+        {
+            NodeData outputData = output.PopFront();
+            outputData.sequenceNumber = sequenceNumber;
+            segment->output.InsertTail(Move(outputData));
+        }
+        if(finish)
+        {
+            segment->processed = true;
+            worker.segment = nullptr;
+        }
+        else
+            segment->nProcessedEntities++;
+
+        /*
+         * New output or a worker became idle. The scheduler must be notified before the mutex is released. HasBufferedData takes the mutex,
+         * so the node can't finish and the graph can't stop (which destroys the scheduler) before this call returned.
+         */
+        this->NotifyScheduler();
+    }
+    this->mutex.Unlock();
+}
+
+//Protected methods
+bool SegmentParallelNode::HasBufferedData() const
+{
+    AutoLock lock(this->mutex);
+    return !this->segments.IsEmpty() || this->hasPendingData;
+}
+
+//Private methods
+void SegmentParallelNode::CompleteOpenSegment(uint64 finishSequenceNumber)
+{
+    this->openSegment->finishSequenceNumber = finishSequenceNumber;
+    this->openSegment->complete = true;
+    this->SignalWorkerOf(this->openSegment);
+    this->openSegment = nullptr;
+}
+
+void SegmentParallelNode::EmitProcessedOutput()
+{
+    while(true)
+    {
+        LinkedList<NodeData> output;
+        LinkedList<uint64> processedSequenceNumbers;
+
+        this->mutex.Lock();
+        if(this->segments.IsEmpty())
+        {
+            this->mutex.Unlock();
+            return;
+        }
+        ProcessingSegment& head = *this->segments.GetFront();
+        while(!head.output.IsEmpty())
+            output.InsertTail(head.output.PopFront());
+        for(; head.nProcessedEntities != 0; head.nProcessedEntities--)
+            processedSequenceNumbers.InsertTail(head.sequenceNumbers.PopFront());
+
+        bool headDone = head.processed;
+        uint64 finishSequenceNumber = head.finishSequenceNumber;
+        if(headDone)
+            this->segments.PopFront();
+        this->mutex.Unlock();
+
+        while(!output.IsEmpty())
+        {
+            NodeData data = output.PopFront();
+            this->currentSequenceNumber = data.sequenceNumber;
+            this->Emit(0, Move(data));
+        }
+
+        //only now that their output is queued, merging points may pass the processed entities
+        while(!processedSequenceNumbers.IsEmpty())
+            this->ReleaseDeferredSequence(processedSequenceNumbers.PopFront());
+        if(!headDone)
+            return;
+        if(finishSequenceNumber != SequenceTracker::EndOfStream)
+            this->ReleaseDeferredSequence(finishSequenceNumber);
+    }
+}
+
+SegmentWorker* SegmentParallelNode::FindIdleWorker() const
+{
+    //bound the output that waits for a slow segment before it
+    if(this->segments.GetNumberOfElements() >= 2 * this->workers.GetNumberOfElements())
+        return nullptr;
+
+    for(const auto& worker : this->workers)
+    {
+        if(worker->segment == nullptr)
+            return worker.operator->();
+    }
+    return nullptr;
+}
+
+bool SegmentParallelNode::IsNewSegmentRequired(const NodeData& data) const
+{
+    if(this->openSegment == nullptr)
+        return true;
+    return this->StartsNewSegment(data, this->openSegment->nInputEntities);
+}
+
+void SegmentParallelNode::QueuePendingData()
+{
+    AutoLock lock(this->mutex);
+
+    if(this->IsNewSegmentRequired(this->pendingData))
+    {
+        if(this->openSegment)
+        {
+            /*
+             * Complete it right away, even if no worker is idle, since merging points might wait for its output. Its finishing output is
+             * placed where the pending entity is, so that one is deferred until then, additionally to being deferred as input.
+             */
+            this->DeferSequence(this->pendingData.sequenceNumber);
+            this->CompleteOpenSegment(this->pendingData.sequenceNumber);
+        }
+
+        SegmentWorker* worker = this->FindIdleWorker();
+        if(worker == nullptr)
+            return; //the worker notifies us when it is done
+
+        ProcessingSegment* segment = new ProcessingSegment;
+        this->segments.InsertTail(segment);
+        this->openSegment = segment;
+        worker->segment = segment;
+    }
+
+    this->OnSegmentEntityQueued(this->pendingData);
+    this->openSegment->sequenceNumbers.InsertTail(this->pendingData.sequenceNumber);
+    this->openSegment->input.InsertTail(Move(this->pendingData));
+    this->openSegment->nInputEntities++;
+    this->hasPendingData = false;
+
+    this->SignalWorkerOf(this->openSegment);
+}
+
+void SegmentParallelNode::SignalWorkerOf(const ProcessingSegment* segment)
+{
+    for(const auto& worker : this->workers)
+    {
+        if(worker->segment == segment)
+            worker->workAvailable.Signal();
+    }
+}
\ No newline at end of file
@@ -0,0 +1,170 @@
+/*
+ * Copyright (c) 2023-2024 Amir Czwink (amir130@hotmail.de)
+ *
+ * This file is part of AVTools.
+ *
+ * AVTools is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * AVTools is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with AVTools.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#pragma once
+#include <StdXX.hpp>
+//Local
+#include "Node.hpp"
+//Namespaces
+using namespace StdXX;
+
+/**
+ * Consecutive input entities that can be processed independently of all others (e.g. a group of pictures).
+ */
+struct ProcessingSegment
+{
+    /**
+     * Entities that were not processed yet
+     */
+    LinkedList<NodeData> input;
+    uint32 nInputEntities = 0;
+    /**
+     * Deferred sequence numbers of the input entities that were not released yet, in input order
+     */
+    LinkedList<uint64> sequenceNumbers;
+    /**
+     * Number of entities at the front of sequenceNumbers that were processed, i.e. whose output is in output
+     */
+    uint32 nProcessedEntities = 0;
+    /**
+     * Carried by the output of FinishSegment. The sequence number of the entity that started the next segment (deferred as well) or
+     * SequenceTracker::EndOfStream for the last segment.
+     */
+    uint64 finishSequenceNumber = SequenceTracker::EndOfStream;
+    /**
+     * Entities that were produced but not emitted yet. They carry the sequence number of the input entity whose processing produced them.
+     */
+    LinkedList<NodeData> output;
+    /**
+     * No more input is added to this segment
+     */
+    bool complete = false;
+    /**
+     * All input was processed and the segment was finished
+     */
+    bool processed = false;
+};
+
+class SegmentParallelNode;
+
+class SegmentWorker : public Thread
+{
+public:
+    //Members
+    const uint32 index;
+    /**
+     * The segment that this worker processes or nullptr if idle. Guarded by the mutex of the node.
+     */
+    ProcessingSegment* segment;
+    ConditionVariable workAvailable;
+
+    //Constructor
+    inline SegmentWorker(SegmentParallelNode& node, uint32 index) : index(index), node(node)
+    {
+        this->segment = nullptr;
+    }
+
+protected:
+    //Methods
+    int32 ThreadMain() override;
+
+private:
+    //Members
+    SegmentParallelNode& node;
+};
+
+/**
+ * Splits the input into segments and processes them on several worker threads. Each segment is processed by one worker, in order.
+ * Output is emitted segment by segment, so the order of the output entities is the same as if all segments were processed one after another.
+ * At most two segments per worker are buffered.
+ * The interleaving with other streams at merging points does not depend on scheduling either. The sequence number of every input entity is
+ * deferred (see Node::DeferSequence) until the output that its processing produced was emitted. This never requires further input. The output
+ * of finishing a segment can only be produced once the next segment starts, so it carries the sequence number of the entity that started it.
+ * The last segment is finished when the input ends and its remaining output is consumed by merging points after all other streams.
+ */
+class SegmentParallelNode : public Node
+{
+public:
+    //Constructor
+    SegmentParallelNode(uint32 nThreads);
+
+    //Destructor
+    ~SegmentParallelNode();
+
+    //Methods
+    bool CanProcess() const override;
+    void ProcessNextEntity() override;
+    /**
+     * Called by the worker threads until the node is destroyed.
+     */
+    void ProcessSegments(SegmentWorker& worker);
+
+protected:
+    //Abstract
+    /**
+     * Called on the thread of the worker. Output must be appended to output.
+     */
+    virtual void FinishSegment(uint32 workerIndex, LinkedList<NodeData>& output) = 0;
+    /**
+     * Called on the thread of the worker. Output must be appended to output.
+     */
+    virtual void ProcessSegmentEntity(uint32 workerIndex, NodeData&& data, LinkedList<NodeData>& output) = 0;
+    virtual bool StartsNewSegment(const NodeData& data, uint32 nSegmentEntities) const = 0;
+
+    //Overrideable
+    /**
+     * Called with the mutex of the node held after data was added to a segment, in input order. StartsNewSegment may depend on state that
+     * is updated here.
+     */
+    virtual void OnSegmentEntityQueued(const NodeData& data)
+    {
+    }
+
+    //Methods
+    bool HasBufferedData() const override;
+
+private:
+    //Members
+    DynamicArray<UniquePointer<SegmentWorker>> workers;
+    mutable Mutex mutex;
+    bool shutdown;
+    LinkedList<UniquePointer<ProcessingSegment>> segments;
+    /**
+     * Last segment of segments if it is not complete yet
+     */
+    ProcessingSegment* openSegment;
+    /**
+     * An entity that starts a new segment while all workers are busy
+     */
+    NodeData pendingData;
+    bool hasPendingData;
+
+    //Methods
+    void CompleteOpenSegment(uint64 finishSequenceNumber);
+    void EmitProcessedOutput();
+    /**
+     * @return nullptr if no worker is idle or too many segments are buffered
+     */
+    SegmentWorker* FindIdleWorker() const;
+    bool IsNewSegmentRequired(const NodeData& data) const;
+    /**
+     * Hands the pending entity off to a segment, unless it starts a new segment and no worker is available.
+     */
+    void QueuePendingData();
+    void SignalWorkerOf(const ProcessingSegment* segment);
+};
\ No newline at end of file
@@ -0,0 +1,172 @@
+/*
+ * Copyright (c) 2023-2024 Amir Czwink (amir130@hotmail.de)
+ *
+ * This file is part of AVTools.
+ *
+ * AVTools is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * AVTools is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with AVTools.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#pragma once
+#include <StdXX.hpp>
+//Namespaces
+using namespace StdXX;
+
+//Forward declarations
+class Node;
+
+/*
+ * Every entity that the source reads gets a sequence number. Everything derived from it (frames, re-encoded packets) carries the same number.
+ * The tracker counts how many entities of each sequence number are still travelling through the graph (i.e. are queued in or processed by a node).
+ * A merging point (the sink) may only consume an entity once no entity with a smaller sequence number is still travelling.
+ * This makes the order in which the sink writes packets independent of how the nodes are scheduled.
+ */
+class SequenceTracker
+{
+public:
+	/**
+	 * Carried by output that is produced when a stream ends (e.g. an encoder that is flushed) and that does not belong to any entity of the
+	 * source. Merging points consume it after everything else.
+	 */
+	static const uint64 EndOfStream = 0xFFFFFFFFFFFFFFFF;
+
+	//Methods
+	/**
+	 * @return true if retained sequence numbers were given up and this changed the smallest travelling sequence number (see SetRetentionLimit)
+	 */
+	inline bool Acquire(uint64 sequenceNumber)
+	{
+		AutoLock lock(this->mutex);
+		this->openSequences[sequenceNumber]++;
+		if(sequenceNumber == EndOfStream)
+			return false; //the source did not read any further
+
+		this->largestSequenceNumber = Math::Max(this->largestSequenceNumber, sequenceNumber);
+
+		bool changed = false;
+		while(!this->retainedSequences.IsEmpty())
+		{
+			const uint64 retainedSequenceNumber = (*this->retainedSequences.begin()).key;
+			if(retainedSequenceNumber + this->retentionLimit > sequenceNumber)
+				break;
+
+			const uint32 nRetentions = (*this->retainedSequences.begin()).value;
+			this->retainedSequences.Remove(retainedSequenceNumber);
+			changed |= this->Decrease(retainedSequenceNumber, nRetentions);
+		}
+		return changed;
+	}
+
+	inline void AddMergingNode(Node* node)
+	{
+		this->mergingNodes.Push(node);
+	}
+
+	inline const DynamicArray<Node*>& GetMergingNodes() const
+	{
+		return this->mergingNodes;
+	}
+
+	/**
+	 * Keeps a sequence number open until it is released with Release, for output that will be emitted later with this sequence number.
+	 * Unlike a retention it is never given up. Therefore the caller must be able to emit the output without receiving further input.
+	 */
+	inline void Defer(uint64 sequenceNumber)
+	{
+		AutoLock lock(this->mutex);
+		this->openSequences[sequenceNumber]++;
+	}
+
+	inline bool GetSmallestOpenSequenceNumber(uint64& sequenceNumber) const
+	{
+		AutoLock lock(this->mutex);
+		if(this->openSequences.IsEmpty())
+			return false;
+		sequenceNumber = (*this->openSequences.begin()).key;
+		return true;
+	}
+
+	/**
+	 * @return true if the smallest travelling sequence number changed, i.e. merging points might be able to continue
+	 */
+	inline bool Release(uint64 sequenceNumber)
+	{
+		AutoLock lock(this->mutex);
+		return this->Decrease(sequenceNumber, 1);
+	}
+
+	/**
+	 * Releases a sequence number that was retained with Retain, unless it was given up already.
+	 * @return see Release
+	 */
+	inline bool ReleaseRetained(uint64 sequenceNumber)
+	{
+		AutoLock lock(this->mutex);
+		if(!this->retainedSequences.Contains(sequenceNumber))
+			return false;
+
+		uint32& nRetentions = this->retainedSequences[sequenceNumber];
+		if(--nRetentions == 0)
+			this->retainedSequences.Remove(sequenceNumber);
+		return this->Decrease(sequenceNumber, 1);
+	}
+
+	/**
+	 * Keeps a sequence number open after the entity that carried it was processed.
+	 */
+	inline void Retain(uint64 sequenceNumber)
+	{
+		AutoLock lock(this->mutex);
+		//the source might have read ahead while the entity was processed
+		if(sequenceNumber + this->retentionLimit <= this->largestSequenceNumber)
+			return;
+
+		this->openSequences[sequenceNumber]++;
+		this->retainedSequences[sequenceNumber]++;
+	}
+
+	/**
+	 * A retained sequence number holds back the merging points, while the input that makes the retaining node release it might only be read
+	 * after the merging points continued. Once the source read retentionLimit entities past a retained sequence number, the sequence number is
+	 * given up. By then the ports between the source and the merging points are full, i.e. the graph would stall otherwise.
+	 * Should therefore be the maximum number of entities per port.
+	 */
+	inline void SetRetentionLimit(uint64 retentionLimit)
+	{
+		this->retentionLimit = retentionLimit;
+	}
+
+private:
+	//State
+	mutable Mutex mutex;
+	BinaryTreeMap<uint64, uint32> openSequences;
+	/**
+	 * Number of retentions per sequence number. They are also counted in openSequences.
+	 */
+	BinaryTreeMap<uint64, uint32> retainedSequences;
+	uint64 retentionLimit = 64;
+	uint64 largestSequenceNumber = 0;
+	DynamicArray<Node*> mergingNodes;
+
+	//Methods
+	inline bool Decrease(uint64 sequenceNumber, uint32 amount)
+	{
+		uint32& count = this->openSequences[sequenceNumber];
+		count -= amount;
+		if(count != 0)
+			return false;
+
+		bool wasSmallest = (*this->openSequences.begin()).key == sequenceNumber;
+		this->openSequences.Remove(sequenceNumber);
+		return wasSmallest;
+	}
+};
\ No newline at end of file
@@ -18,15 +18,69 @@
  */
 //Class Header
 #include "SinkNode.hpp"
+//Local
+#include "SourceNode.hpp"
+
+//Local classes
+/**
+ * Passes everything through except for the stream index, without copying the payload
+ */
+class StreamIndexMappingPacket : public IPacket
+{
+public:
+    //Constructor
+    inline StreamIndexMappingPacket(const IPacket& packet, uint32 streamIndex) : packet(packet), streamIndex(streamIndex)
+    {
+    }
+
+    //Methods
+    bool ContainsKeyframe() const override
+    {
+        return this->packet.ContainsKeyframe();
+    }
+
+    const uint8* GetData() const override
+    {
+        return this->packet.GetData();
+    }
+
+    uint64 GetDecodeTimestamp() const override
+    {
+        return this->packet.GetDecodeTimestamp();
+    }
+
+    uint64 GetPresentationTimestamp() const override
+    {
+        return this->packet.GetPresentationTimestamp();
+    }
+
+    uint32 GetSize() const override
+    {
+        return this->packet.GetSize();
+    }
+
+    uint32 GetStreamIndex() const override
+    {
+        return this->streamIndex;
+    }
+
+private:
+    //Members
+    const IPacket& packet;
+    uint32 streamIndex;
+};
 
 //Constructor
-SinkNode::SinkNode(const ContainerFormat *pFormat, FileOutputStream *pFile, class Muxer *pMuxer)
+SinkNode::SinkNode(const ContainerFormat *pFormat, SeekableOutputStream *pFile, class Muxer *pMuxer)
 {
     this->format = pFormat;
     this->pFile = pFile;
     this->muxer = pMuxer;
     this->headerWritten = false;
     this->finalized = false;
+    this->directSource = nullptr;
+    //packets of the different streams are written in the order in which the source read them, regardless of how the graph is scheduled
+    this->mergesInputs = true;
 }
 
 //Destructor
@@ -39,7 +93,24 @@ SinkNode::~SinkNode()
 //Public methods
 bool SinkNode::CanProcess() const
 {
-    return !this->finalized;
+    if(this->finalized)
+        return false;
+    if(this->directSource)
+        return this->directSource->EndOfPacketsReached();
+    return !this->IsMoreInputFromInputsPortsExpected() || this->IsDataAvailable();
+}
+
+void SinkNode::ConnectDirectly(const SourceNode* source, const BinaryTreeMap<uint32, uint32>& muxerStreamIndices)
+{
+    //HasBufferedData keeps the sink from finishing, which only works if no input port makes it wait for upstream nodes instead
+    ASSERT(!this->IsAnyInputPortConnected(), u8"Input ports of a directly connected sink must be disconnected");
+    this->directSource = source;
+    this->directStreamIndices = muxerStreamIndices;
+}
+
+String SinkNode::GetName() const
+{
+    return u8"SinkNode";
 }
 
 PortFormat SinkNode::GetInputFormat(uint32 inputPortNumber) const
@@ -58,6 +129,9 @@ PortFormat SinkNode::GetOutputFormat(uint32 outputPortNumber) const
 
 void SinkNode::ProcessNextEntity()
 {
+    //must be evaluated before checking for data, else data that arrives in between might be missed
+    bool moreInputExpected = this->IsMoreInputFromInputsPortsExpected();
+
     if(!this->headerWritten)
     {
         this->muxer->WriteHeader();
@@ -66,14 +140,45 @@ void SinkNode::ProcessNextEntity()
 
     if(this->IsDataAvailable())
     {
-        //we are getting packets
-        NodeData nodeData = this->GetNextData();
+        //we are getting packets. Every input port feeds the muxer stream with the same index
+        uint32 inputPortNumber;
+        NodeData nodeData = this->GetNextData(inputPortNumber);
 
-        this->muxer->WritePacket(*nodeData.packet);
+        this->WritePacket(nodeData.GetPacket(), inputPortNumber);
     }
-    else if(!this->IsMoreInputFromInputsPortsExpected())
+    else if(!moreInputExpected)
     {
         this->muxer->Finalize();
+        //a write-behind stream might still be writing in the background
+        this->pFile->Flush();
         this->finalized = true;
     }
+}
+
+void SinkNode::WritePacketDirectly(const IPacket& packet, uint64 size)
+{
+    if(!this->headerWritten)
+    {
+        this->muxer->WriteHeader();
+        this->headerWritten = true;
+    }
+
+    this->CountDirectInput(size);
+    this->WritePacket(packet, this->directStreamIndices[packet.GetStreamIndex()]);
+}
+
+//Private methods
+void SinkNode::WritePacket(const IPacket& packet, uint32 muxerStreamIndex)
+{
+    if(packet.GetStreamIndex() == muxerStreamIndex)
+        this->muxer->WritePacket(packet);
+    else
+        this->muxer->WritePacket(StreamIndexMappingPacket(packet, muxerStreamIndex));
+}
+
+//Protected methods
+bool SinkNode::HasBufferedData() const
+{
+    //a directly connected source is not an upstream node, it only notifies once it reached the end. Until then the sink must not finish
+    return this->directSource && !this->finalized;
 }
\ No newline at end of file
@@ -20,11 +20,14 @@
 //Local
 #include "Node.hpp"
 
+//Forward declarations
+class SourceNode;
+
 class SinkNode : public Node
 {
 public:
     //Constructor
-    SinkNode(const ContainerFormat *pFormat, FileOutputStream *pFile, Muxer *pMuxer);
+    SinkNode(const ContainerFormat *pFormat, SeekableOutputStream *pFile, Muxer *pMuxer);
 
     //Destructor
     ~SinkNode();
@@ -42,15 +45,38 @@ public:
 
     //Methods
 	bool CanProcess() const override;
+	/**
+	 * Stream copy: source writes its packets with WritePacketDirectly. The sink finalizes the output once source reached the end.
+	 * @param muxerStreamIndices maps the index of every copied source stream to the index of its stream in the muxer
+	 */
+	void ConnectDirectly(const SourceNode* source, const BinaryTreeMap<uint32, uint32>& muxerStreamIndices);
+	String GetName() const override;
 	PortFormat GetInputFormat(uint32 inputPortNumber) const override;
 	PortFormat GetOutputFormat(uint32 outputPortNumber) const;
     void ProcessNextEntity() override;
+	/**
+	 * Called by the directly connected source on its thread. The sink itself only finalizes after the source reached the end,
+	 * so the muxer is never used concurrently.
+	 */
+	void WritePacketDirectly(const IPacket& packet, uint64 size);
+
+protected:
+    //Methods
+    bool HasBufferedData() const override;
 
 private:
+    //Methods
+    /**
+     * Packets carry the index of the stream that they were read from or 0 if an encoder produced them. The muxer expects the index of its own stream.
+     */
+    void WritePacket(const IPacket& packet, uint32 muxerStreamIndex);
+
     //Members
     bool headerWritten;
     bool finalized;
+    const SourceNode* directSource;
+    BinaryTreeMap<uint32, uint32> directStreamIndices;
     const ContainerFormat *format;
-    FileOutputStream *pFile;
+    SeekableOutputStream *pFile;
     class Muxer *muxer;
 };
\ No newline at end of file
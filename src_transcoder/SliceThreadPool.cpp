@@ -0,0 +1,107 @@
+/*
+ * Copyright (c) 2023-2024 Amir Czwink (amir130@hotmail.de)
+ *
+ * This file is part of AVTools.
+ *
+ * AVTools is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * AVTools is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with AVTools.  If not, see <http://www.gnu.org/licenses/>.
+ */
+//Class Header
+#include "SliceThreadPool.hpp"
+
+//SliceWorker protected methods
+int32 SliceWorker::ThreadMain()
+{
+    this->pool.ProcessSlices(*this);
+    return EXIT_SUCCESS;
+}
+
+//Constructor
+SliceThreadPool::SliceThreadPool(uint32 nThreads)
+{
+    this->shutdown = false;
+    this->task = nullptr;
+    this->nSlices = 0;
+    this->nextSlice = 0;
+    this->nUnfinishedSlices = 0;
+
+    for(uint32 i = 1; i < nThreads; i++)
+    {
+        SliceWorker* worker = new SliceWorker(*this);
+        this->workers.Push(worker);
+        worker->Start();
+    }
+}
+
+//Destructor
+SliceThreadPool::~SliceThreadPool()
+{
+    this->mutex.Lock();
+    this->shutdown = true;
+    for(const auto& worker : this->workers)
+        worker->workAvailable.Signal();
+    this->mutex.Unlock();
+
+    for(const auto& worker : this->workers)
+        worker->Join();
+}
+
+//Public methods
+void SliceThreadPool::ProcessSlices(SliceWorker& worker)
+{
+    this->mutex.Lock();
+    while(true)
+    {
+        while(!this->shutdown && (this->nextSlice >= this->nSlices))
+            worker.workAvailable.Wait(this->mutex);
+        if(this->shutdown)
+            break;
+
+        uint32 sliceIndex = this->nextSlice++;
+        SliceTask* task = this->task;
+        this->mutex.Unlock();
+
+        task->ProcessSlice(sliceIndex);
+
+        this->mutex.Lock();
+        if(--this->nUnfinishedSlices == 0)
+            this->allSlicesProcessed.Signal();
+    }
+    this->mutex.Unlock();
+}
+
+void SliceThreadPool::Run(SliceTask& task, uint32 nSlices)
+{
+    this->mutex.Lock();
+    this->task = &task;
+    this->nSlices = nSlices;
+    this->nextSlice = 0;
+    this->nUnfinishedSlices = nSlices;
+    for(const auto& worker : this->workers)
+        worker->workAvailable.Signal();
+
+    while(this->nextSlice < this->nSlices)
+    {
+        uint32 sliceIndex = this->nextSlice++;
+        this->mutex.Unlock();
+
+        task.ProcessSlice(sliceIndex);
+
+        this->mutex.Lock();
+        this->nUnfinishedSlices--;
+    }
+
+    while(this->nUnfinishedSlices != 0)
+        this->allSlicesProcessed.Wait(this->mutex);
+    this->mutex.Unlock();
+}
\ No newline at end of file
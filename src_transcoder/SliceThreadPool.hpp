@@ -0,0 +1,97 @@
+/*
+ * Copyright (c) 2023-2024 Amir Czwink (amir130@hotmail.de)
+ *
+ * This file is part of AVTools.
+ *
+ * AVTools is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * AVTools is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with AVTools.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#pragma once
+#include <StdXX.hpp>
+//Namespaces
+using namespace StdXX;
+
+class SliceTask
+{
+public:
+    //Destructor
+    virtual ~SliceTask(){}
+
+    //Abstract
+    /**
+     * Called concurrently for different slices.
+     */
+    virtual void ProcessSlice(uint32 sliceIndex) = 0;
+};
+
+class SliceThreadPool;
+
+class SliceWorker : public Thread
+{
+public:
+    //Members
+    ConditionVariable workAvailable;
+
+    //Constructor
+    inline SliceWorker(SliceThreadPool& pool) : pool(pool)
+    {
+    }
+
+protected:
+    //Methods
+    int32 ThreadMain() override;
+
+private:
+    //Members
+    SliceThreadPool& pool;
+};
+
+/**
+ * Runs the slices of a task (e.g. horizontal stripes of an image) in parallel. The calling thread works on slices too.
+ */
+class SliceThreadPool
+{
+public:
+    //Constructor
+    SliceThreadPool(uint32 nThreads);
+
+    //Destructor
+    ~SliceThreadPool();
+
+    //Methods
+    /**
+     * Called by the worker threads until the pool is destroyed.
+     */
+    void ProcessSlices(SliceWorker& worker);
+    /**
+     * Returns after all slices were processed. Must not be called concurrently.
+     */
+    void Run(SliceTask& task, uint32 nSlices);
+
+    //Properties
+    inline uint32 GetNumberOfThreads() const
+    {
+        return this->workers.GetNumberOfElements() + 1;
+    }
+
+private:
+    //Members
+    DynamicArray<UniquePointer<SliceWorker>> workers;
+    Mutex mutex;
+    ConditionVariable allSlicesProcessed;
+    bool shutdown;
+    SliceTask* task;
+    uint32 nSlices;
+    uint32 nextSlice;
+    uint32 nUnfinishedSlices;
+};
\ No newline at end of file
@@ -18,23 +18,26 @@
  */
 //Class Header
 #include "SourceNode.hpp"
+//Local
+#include "SinkNode.hpp"
 
 //Constructor
-SourceNode::SourceNode(FileInputStream* fileInputStream, Demuxer* demuxer)
+SourceNode::SourceNode(SeekableInputStream* inputStream, Demuxer* demuxer)
 {
-    this->fileInputStream = fileInputStream;
+    this->inputStream = inputStream;
     this->demuxer = demuxer;
     this->endOfPacketsReached = false;
+    this->nextSequenceNumber = 0;
+    this->directSink = nullptr;
+    this->nEndedStreams = 0;
 
     this->outputPorts.Resize(this->demuxer->GetNumberOfStreams());
-    for(auto& ptr : this->outputPorts)
-        ptr = nullptr;
 }
 
 //Destructor
 SourceNode::~SourceNode()
 {
-    delete this->fileInputStream;
+    delete this->inputStream;
     delete this->demuxer;
 }
 
@@ -44,6 +47,17 @@ bool SourceNode::CanProcess() const
     return !this->endOfPacketsReached;
 }
 
+void SourceNode::ConnectDirectly(SinkNode* sink, const BinaryTreeMap<uint32, uint32>& muxerStreamIndices)
+{
+    this->directSink = sink;
+    sink->ConnectDirectly(this, muxerStreamIndices);
+}
+
+String SourceNode::GetName() const
+{
+    return u8"SourceNode";
+}
+
 PortFormat SourceNode::GetInputFormat(uint32 inputPortNumber) const
 {
     //has no input port
@@ -60,15 +74,116 @@ PortFormat SourceNode::GetOutputFormat(uint32 outputPortNumber) const
 
 void SourceNode::ProcessNextEntity()
 {
+    //every packet is allocated by the demuxer. Std++ can't read into a caller-provided buffer, so packets can't be recycled from the sink
     auto packet = this->demuxer->ReadFrame();
     if(packet == nullptr)
     {
-        this->endOfPacketsReached = true;
+        this->EndPackets();
+        return;
+    }
+
+    //unselected streams are dropped before they are wrapped or get a sequence number
+    if(!this->selectedStreamIndices.Contains(packet->GetStreamIndex()))
+        return;
+
+    if(this->trimmedStreams.IsEmpty())
+        this->ForwardPacket(Move(packet));
+    else
+        this->TrimPacket(Move(packet));
+}
+
+void SourceNode::SelectStreams(const BinaryTreeSet<uint32>& streamIndices)
+{
+    this->selectedStreamIndices = streamIndices;
+}
+
+void SourceNode::Trim(uint32 streamIndex, uint64 startTime, uint64 endTime)
+{
+    StreamTrim& trim = this->trimmedStreams[streamIndex];
+    trim.startTime = startTime;
+    trim.endTime = endTime;
+}
+
+//Private methods
+void SourceNode::EndPackets()
+{
+    this->endOfPacketsReached = true;
+    if(this->directSink)
+        this->directSink->NotifyScheduler();
+}
+
+void SourceNode::ForwardPacket(UniquePointer<IPacket>&& packet)
+{
+    if(this->directSink)
+    {
+        //the packet is neither wrapped nor queued, the muxer reads the payload right from where the demuxer put it
+        uint64 size = packet->GetSize();
+        this->CountDirectOutput(size);
+        this->directSink->WritePacketDirectly(*packet, size);
         return;
     }
 
+    uint32 streamIndex = packet->GetStreamIndex();
+    this->currentSequenceNumber = this->nextSequenceNumber++;
+
     NodeData nodeData;
     nodeData.packet = Move(packet);
 
-    this->outputPorts[nodeData.packet->GetStreamIndex()]->AddData(Move(nodeData));
+    this->Emit(streamIndex, Move(nodeData));
+}
+
+void SourceNode::TrimPacket(UniquePointer<IPacket>&& packet)
+{
+    uint32 streamIndex = packet->GetStreamIndex();
+    if(!this->trimmedStreams.Contains(streamIndex))
+        return;
+    StreamTrim& trim = this->trimmedStreams[streamIndex];
+    if(trim.ended)
+        return;
+
+    /*
+     * The end is checked in decoding order. With reordered frames a packet that is presented after the end can still be a reference of
+     * one that is presented before it, so the stream only ends with the first packet that is decoded after the end.
+     */
+    uint64 pts = packet->GetPresentationTimestamp();
+    bool hasPts = pts != Unsigned<uint64>::Max();
+    uint64 dts = packet->GetDecodeTimestamp();
+    if(dts == Unsigned<uint64>::Max())
+        dts = pts;
+
+    if((dts != Unsigned<uint64>::Max()) && (dts >= trim.endTime))
+    {
+        trim.ended = true;
+        while(!trim.pendingPackets.IsEmpty())
+            trim.pendingPackets.PopFront();
+
+        //no need to read any further
+        if(++this->nEndedStreams == this->trimmedStreams.GetNumberOfElements())
+            this->EndPackets();
+        return;
+    }
+
+    if(!trim.started)
+    {
+        if(packet->ContainsKeyframe())
+        {
+            while(!trim.pendingPackets.IsEmpty())
+                trim.pendingPackets.PopFront();
+        }
+
+        //a packet without timestamp can't start the range, it most likely belongs to the frame before
+        if(!hasPts || (pts < trim.startTime))
+        {
+            //packets that don't follow a keyframe can't be decoded anyway
+            if(packet->ContainsKeyframe() || !trim.pendingPackets.IsEmpty())
+                trim.pendingPackets.InsertTail(Move(packet));
+            return;
+        }
+
+        trim.started = true;
+        while(!trim.pendingPackets.IsEmpty())
+            this->ForwardPacket(trim.pendingPackets.PopFront());
+    }
+
+    this->ForwardPacket(Move(packet));
 }
\ No newline at end of file
@@ -17,6 +17,7 @@
  * along with AVTools.  If not, see <http://www.gnu.org/licenses/>.
  */
 #pragma once
+#include <atomic>
 #include <StdXX.hpp>
 //Local
 #include "Node.hpp"
@@ -24,30 +25,83 @@
 using namespace StdXX;
 using namespace StdXX::Multimedia;
 
+//Forward declarations
+class SinkNode;
+
 class SourceNode : public Node
 {
+    struct StreamTrim
+    {
+        uint64 startTime;
+        uint64 endTime;
+        bool started = false;
+        bool ended = false;
+        /**
+         * The packets since the last keyframe before startTime. Decoding has to begin with the keyframe.
+         */
+        LinkedList<UniquePointer<IPacket>> pendingPackets;
+    };
 public:
     //Constructor
-    SourceNode(FileInputStream *fileInputStream, Demuxer* demuxer);
+    SourceNode(SeekableInputStream* inputStream, Demuxer* demuxer);
 
     //Destructor
     ~SourceNode();
 
     //Methods
     bool CanProcess() const override;
+    /**
+     * Stream copy: packets of the selected streams are written by sink directly instead of being emitted.
+     * The output ports must not be connected.
+     * @param muxerStreamIndices see SinkNode::ConnectDirectly
+     */
+    void ConnectDirectly(SinkNode* sink, const BinaryTreeMap<uint32, uint32>& muxerStreamIndices);
+    String GetName() const override;
     PortFormat GetInputFormat(uint32 inputPortNumber) const override;
     PortFormat GetOutputFormat(uint32 outputPortNumber) const;
     void ProcessNextEntity() override;
+    /**
+     * Packets of all other streams are dropped as soon as they are read, i.e. they don't cost any work in the graph.
+     * Std++ demuxers have no way to skip the payload of a stream though, so it is still read from the input.
+     */
+    void SelectStreams(const BinaryTreeSet<uint32>& streamIndices);
+    /**
+     * Only passes on the packets of the stream with presentation timestamps from startTime on and decoding timestamps before endTime,
+     * given in the time scale of the stream.
+     * Packets from the last keyframe before startTime on are kept too, so that they can be decoded. Once a stream is trimmed, packets of streams
+     * that are not trimmed are dropped and the source stops reading as soon as all trimmed streams passed their end time.
+     */
+    void Trim(uint32 streamIndex, uint64 startTime, uint64 endTime);
 
     //Inline
+    inline bool EndOfPacketsReached() const
+    {
+        return this->endOfPacketsReached;
+    }
+
     inline Demuxer *GetDemuxer()
     {
         return this->demuxer;
     }
 
+    inline bool IsConnectedDirectly() const
+    {
+        return this->directSink != nullptr;
+    }
+
 private:
     //Members
-    bool endOfPacketsReached;
-    FileInputStream* fileInputStream;
+    std::atomic<bool> endOfPacketsReached;
+    uint64 nextSequenceNumber;
+    SeekableInputStream* inputStream;
     Demuxer* demuxer;
+    SinkNode* directSink;
+    BinaryTreeSet<uint32> selectedStreamIndices;
+    BinaryTreeMap<uint32, StreamTrim> trimmedStreams;
+    uint32 nEndedStreams;
+
+    //Methods
+    void EndPackets();
+    void ForwardPacket(UniquePointer<IPacket>&& packet);
+    void TrimPacket(UniquePointer<IPacket>&& packet);
 };
\ No newline at end of file
@@ -0,0 +1,156 @@
+/*
+ * Copyright (c) 2023-2024 Amir Czwink (amir130@hotmail.de)
+ *
+ * This file is part of AVTools.
+ *
+ * AVTools is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * AVTools is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with AVTools.  If not, see <http://www.gnu.org/licenses/>.
+ */
+//Corresponding header
+#include "StatisticsReport.hpp"
+
+//Local functions
+static String FormatMilliseconds(uint64 nanoseconds)
+{
+	return String::Number(nanoseconds / 1000000) + u8"." + String::Number((nanoseconds / 1000) % 1000, 10, 3);
+}
+
+static String FormatMicroseconds(uint64 nanoseconds)
+{
+	return String::Number(nanoseconds / 1000) + u8"." + String::Number(nanoseconds % 1000, 10, 3);
+}
+
+static String FormatPort(const PortFormat& format)
+{
+	const DecodingParameters& parameters = format.frameParameters;
+	if(format.packetsOrFrames)
+		return u8"packets " + ((parameters.codingFormat == nullptr) ? String(u8"unknown") : parameters.codingFormat->GetName());
+
+	switch(parameters.dataType)
+	{
+		case DataType::Audio:
+			return u8"frames " + String::Number(parameters.audio.sampleFormat->nChannels) + u8" channels " + String::Number(parameters.audio.sampleRate) + u8" Hz";
+		case DataType::Video:
+			return u8"frames " + String::Number(parameters.video.size.width) + u8"x" + String::Number(parameters.video.size.height);
+		default:
+			return u8"frames";
+	}
+}
+
+static String ToJson(const Node& node)
+{
+	const NodeStatistics& statistics = node.GetStatistics();
+
+	return u8"{\"name\": \"" + node.GetName() + u8"\""
+		+ u8", \"entitiesIn\": " + String::Number(statistics.nEntitiesIn)
+		+ u8", \"entitiesOut\": " + String::Number(statistics.nEntitiesOut)
+		+ u8", \"bytesIn\": " + String::Number(statistics.nBytesIn)
+		+ u8", \"bytesOut\": " + String::Number(statistics.nBytesOut)
+		+ u8", \"processCalls\": " + String::Number(statistics.nProcessCalls)
+		+ u8", \"totalNanoseconds\": " + String::Number(statistics.totalProcessingTime)
+		+ u8", \"p50Nanoseconds\": " + String::Number(statistics.ComputePercentile(50))
+		+ u8", \"p99Nanoseconds\": " + String::Number(statistics.ComputePercentile(99))
+		+ u8", \"queueHighWaterMark\": " + String::Number(node.GetQueueHighWaterMark())
+		+ u8"}";
+}
+
+//Global functions
+void PrintGraph(const FilterGraph& filterGraph)
+{
+	const DynamicArray<UniquePointer<Node>>& nodes = filterGraph.Nodes();
+
+	//nodes of the same type are told apart by their index in the graph
+	BinaryTreeMap<const Node*, uint32> nodeIndices;
+	for(uint32 i = 0; i < nodes.GetNumberOfElements(); i++)
+		nodeIndices.Insert(nodes[i].operator->(), i);
+
+	for(uint32 i = 0; i < nodes.GetNumberOfElements(); i++)
+	{
+		const Node& node = *nodes[i];
+		stdOut << u8"  " << i << u8" " << node.GetName() << endl;
+		for(uint32 outputPortNumber = 0; outputPortNumber < node.GetOutputPortCount(); outputPortNumber++)
+		{
+			for(const PortLink& link : node.GetOutputLinks(outputPortNumber))
+			{
+				stdOut << u8"    " << outputPortNumber << u8" -> " << nodeIndices.Get(link.target) << u8" " << link.target->GetName() << u8":" << link.inputPortNumber
+					<< u8" (" << FormatPort(node.GetOutputFormat(outputPortNumber)) << u8")" << endl;
+			}
+		}
+	}
+	stdOut << endl;
+}
+
+void PrintStatistics(const FilterGraph& filterGraph)
+{
+	stdOut << u8"Node\t\t\tIn\tOut\tBytes in\tBytes out\tTotal (ms)\tp50 (us)\tp99 (us)\tMax queue" << endl;
+	for(const auto& node : filterGraph.Nodes())
+	{
+		const NodeStatistics& statistics = node->GetStatistics();
+
+		stdOut << node->GetName() << u8"\t\t"
+			<< statistics.nEntitiesIn << u8"\t"
+			<< statistics.nEntitiesOut << u8"\t"
+			<< statistics.nBytesIn << u8"\t"
+			<< statistics.nBytesOut << u8"\t"
+			<< FormatMilliseconds(statistics.totalProcessingTime) << u8"\t\t"
+			<< FormatMicroseconds(statistics.ComputePercentile(50)) << u8"\t\t"
+			<< FormatMicroseconds(statistics.ComputePercentile(99)) << u8"\t\t"
+			<< node->GetQueueHighWaterMark() << endl;
+	}
+	stdOut << endl;
+
+	const SchedulingStatistics& statistics = filterGraph.Statistics();
+
+	stdOut << u8"Scheduling statistics:" << endl
+		<< u8"  ProcessNextEntity calls: " << statistics.nProcessCalls << endl
+		<< u8"  Wasted calls: " << statistics.nWastedProcessCalls << endl;
+
+	FramePoolStatistics framePoolStatistics = filterGraph.Context().framePool.GetStatistics();
+	uint64 nRequests = framePoolStatistics.nHits + framePoolStatistics.nMisses;
+	stdOut << u8"Frame pool:" << endl
+		<< u8"  Requests: " << nRequests << endl
+		<< u8"  Hit rate: " << (nRequests ? (100 * framePoolStatistics.nHits / nRequests) : 0) << u8"%" << endl
+		<< u8"  Outstanding frames: " << framePoolStatistics.nOutstanding << endl;
+}
+
+void WriteStatisticsJson(const FilterGraph& filterGraph, const FileSystem::Path& path)
+{
+	String json = u8"{\"nodes\": [";
+	bool first = true;
+	for(const auto& node : filterGraph.Nodes())
+	{
+		if(!first)
+			json += u8", ";
+		json += ToJson(*node);
+		first = false;
+	}
+	json += u8"]";
+
+	const SchedulingStatistics& schedulingStatistics = filterGraph.Statistics();
+	json += u8", \"scheduling\": {\"processCalls\": " + String::Number(schedulingStatistics.nProcessCalls)
+		+ u8", \"wastedProcessCalls\": " + String::Number(schedulingStatistics.nWastedProcessCalls) + u8"}";
+
+	FramePoolStatistics framePoolStatistics = filterGraph.Context().framePool.GetStatistics();
+	json += u8", \"framePool\": {\"hits\": " + String::Number(framePoolStatistics.nHits)
+		+ u8", \"misses\": " + String::Number(framePoolStatistics.nMisses)
+		+ u8", \"outstanding\": " + String::Number(framePoolStatistics.nOutstanding) + u8"}";
+
+	const FilterGraphContext& context = filterGraph.Context();
+	json += u8", \"peakQueuedEntities\": " + String::Number(context.PeakQueuedEntities())
+		+ u8", \"peakQueuedBytes\": " + String::Number(context.PeakQueuedBytes())
+		+ u8"}";
+
+	FileOutputStream file(path);
+	TextWriter textWriter(file, TextCodecType::UTF8);
+	textWriter.WriteLine(json);
+}
\ No newline at end of file
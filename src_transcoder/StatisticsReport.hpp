@@ -0,0 +1,31 @@
+/*
+ * Copyright (c) 2023-2024 Amir Czwink (amir130@hotmail.de)
+ *
+ * This file is part of AVTools.
+ *
+ * AVTools is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * AVTools is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with AVTools.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#pragma once
+#include <StdXX.hpp>
+//Local
+#include "FilterGraph.hpp"
+//Namespaces
+using namespace StdXX;
+
+/**
+ * Prints the nodes of the graph and the links between them.
+ */
+void PrintGraph(const FilterGraph& filterGraph);
+void PrintStatistics(const FilterGraph& filterGraph);
+void WriteStatisticsJson(const FilterGraph& filterGraph, const FileSystem::Path& path);
\ No newline at end of file
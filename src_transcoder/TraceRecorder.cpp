@@ -0,0 +1,102 @@
+/*
+ * Copyright (c) 2023-2024 Amir Czwink (amir130@hotmail.de)
+ *
+ * This file is part of AVTools.
+ *
+ * AVTools is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * AVTools is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with AVTools.  If not, see <http://www.gnu.org/licenses/>.
+ */
+//Class Header
+#include "TraceRecorder.hpp"
+//Local
+#include "Node.hpp"
+
+//Local functions
+static String FormatTimestamp(uint64 nanoseconds)
+{
+	//the trace-event format expects microseconds
+	return String::Number(nanoseconds / 1000) + u8"." + String::Number(nanoseconds % 1000, 10, 3);
+}
+
+//Constructor
+TraceRecorder::TraceRecorder()
+{
+	static std::atomic<uint32> nextId(1);
+
+	this->id = nextId++;
+	this->startTimestamp = NodeStatistics::QueryTimestamp();
+}
+
+//Public methods
+void TraceRecorder::Write(const DynamicArray<UniquePointer<Node>>& nodes, OutputStream& outputStream) const
+{
+	//nodes of the same type are told apart by their index in the graph
+	BinaryTreeMap<const Node*, String> nodeLabels;
+	for(uint32 i = 0; i < nodes.GetNumberOfElements(); i++)
+		nodeLabels.Insert(nodes[i].operator->(), nodes[i]->GetName() + u8" " + String::Number(i));
+
+	TextWriter textWriter(outputStream, TextCodecType::UTF8);
+	textWriter.WriteLine(u8"{\"traceEvents\": [");
+	textWriter.WriteString(u8"{\"name\": \"process_name\", \"ph\": \"M\", \"pid\": 1, \"tid\": 0, \"args\": {\"name\": \"transcoder\"}}");
+
+	for(uint32 i = 0; i < this->buffers.GetNumberOfElements(); i++)
+	{
+		String tid = String::Number(i + 1);
+		textWriter.WriteString(u8",\n{\"name\": \"thread_name\", \"ph\": \"M\", \"pid\": 1, \"tid\": " + tid + u8", \"args\": {\"name\": \"worker " + tid + u8"\"}}");
+
+		for(const TraceEvent& event : this->buffers[i]->events)
+		{
+			const String& label = nodeLabels.Get(event.node);
+			String common = u8"\"pid\": 1, \"tid\": " + tid + u8", \"ts\": " + FormatTimestamp(event.timestamp - this->startTimestamp);
+
+			String line;
+			switch(event.type)
+			{
+				case TraceEventType::Begin:
+					line = u8"{\"name\": \"" + label + u8"\", \"ph\": \"B\", " + common + u8"}";
+					break;
+				case TraceEventType::End:
+					line = u8"{\"name\": \"" + label + u8"\", \"ph\": \"E\", " + common + u8"}";
+					break;
+				case TraceEventType::QueueDepth:
+					line = u8"{\"name\": \"queue " + label + u8" port " + String::Number(event.inputPortNumber) + u8"\", \"ph\": \"C\", " + common
+						+ u8", \"args\": {\"entities\": " + String::Number(event.value) + u8"}}";
+					break;
+				case TraceEventType::FlowStart:
+					line = u8"{\"name\": \"entity\", \"cat\": \"flow\", \"ph\": \"s\", \"id\": " + String::Number(event.value) + u8", " + common + u8"}";
+					break;
+				case TraceEventType::FlowStep:
+					line = u8"{\"name\": \"entity\", \"cat\": \"flow\", \"ph\": \"t\", \"bp\": \"e\", \"id\": " + String::Number(event.value) + u8", " + common + u8"}";
+					break;
+				case TraceEventType::FlowEnd:
+					line = u8"{\"name\": \"entity\", \"cat\": \"flow\", \"ph\": \"f\", \"bp\": \"e\", \"id\": " + String::Number(event.value) + u8", " + common + u8"}";
+					break;
+			}
+			textWriter.WriteString(u8",\n" + line);
+		}
+	}
+
+	textWriter.WriteLine(u8"");
+	textWriter.WriteLine(u8"]}");
+}
+
+//Private methods
+TraceRecorder::ThreadBuffer* TraceRecorder::CreateThreadBuffer()
+{
+	ThreadBuffer* buffer = new ThreadBuffer;
+
+	AutoLock lock(this->buffersLock);
+	this->buffers.Push(buffer);
+
+	return buffer;
+}
\ No newline at end of file
@@ -0,0 +1,107 @@
+/*
+ * Copyright (c) 2023-2024 Amir Czwink (amir130@hotmail.de)
+ *
+ * This file is part of AVTools.
+ *
+ * AVTools is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * AVTools is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with AVTools.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#pragma once
+#include <atomic>
+#include <StdXX.hpp>
+//Local
+#include "NodeStatistics.hpp"
+//Namespaces
+using namespace StdXX;
+
+//Forward declarations
+class Node;
+
+enum class TraceEventType
+{
+	Begin,
+	End,
+	QueueDepth,
+	FlowStart,
+	FlowStep,
+	FlowEnd,
+};
+
+struct TraceEvent
+{
+	TraceEventType type;
+	uint32 inputPortNumber;
+	uint64 timestamp;
+	const Node* node;
+	/**
+	 * Queue depth for QueueDepth events, sequence number for flow events
+	 */
+	uint64 value;
+};
+
+/**
+ * Records a timeline of the nodes' activity that can be written in the Chrome trace-event format (viewable in Perfetto or chrome://tracing).
+ * Every thread records into its own buffer, so recording never synchronizes the workers. Only the first event of a thread takes a lock to
+ * register its buffer.
+ * The buffers must only be written out after all workers have finished.
+ */
+class TraceRecorder
+{
+	struct ThreadBuffer
+	{
+		DynamicArray<TraceEvent> events;
+	};
+
+public:
+	//Constructor
+	TraceRecorder();
+
+	//Methods
+	void Write(const DynamicArray<UniquePointer<Node>>& nodes, OutputStream& outputStream) const;
+
+	//Inline
+	inline void Record(TraceEventType type, const Node& node, uint64 value = 0, uint32 inputPortNumber = 0)
+	{
+		this->GetThreadBuffer().events.Push({
+			.type = type,
+			.inputPortNumber = inputPortNumber,
+			.timestamp = NodeStatistics::QueryTimestamp(),
+			.node = &node,
+			.value = value
+		});
+	}
+
+private:
+	//State
+	uint32 id;
+	uint64 startTimestamp;
+	Mutex buffersLock;
+	DynamicArray<UniquePointer<ThreadBuffer>> buffers;
+
+	//Methods
+	ThreadBuffer* CreateThreadBuffer();
+
+	//Inline
+	inline ThreadBuffer& GetThreadBuffer()
+	{
+		thread_local ThreadBuffer* buffer = nullptr;
+		thread_local uint32 bufferOwnerId = 0;
+
+		if(bufferOwnerId != this->id)
+		{
+			buffer = this->CreateThreadBuffer();
+			bufferOwnerId = this->id;
+		}
+		return *buffer;
+	}
+};
\ No newline at end of file
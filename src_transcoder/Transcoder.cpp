@@ -0,0 +1,461 @@
+/*
+ * Copyright (c) 2023-2024 Amir Czwink (amir130@hotmail.de)
+ *
+ * This file is part of AVTools.
+ *
+ * AVTools is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * AVTools is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with AVTools.  If not, see <http://www.gnu.org/licenses/>.
+ */
+//Corresponding header
+#include "Transcoder.hpp"
+//Local
+#include "FilterGraph.hpp"
+#include "FilterGraphBuilder.hpp"
+#include "StatisticsReport.hpp"
+
+//Local functions
+static BinaryTreeMap<String, CodingFormatId> CreateCodecStringMap()
+{
+	BinaryTreeMap<String, CodingFormatId> codecStringMap;
+	codecStringMap.Insert(u8"pcm_f32le", CodingFormatId::PCM_Float32LE);
+	codecStringMap.Insert(u8"pcm_s16le", CodingFormatId::PCM_S16LE);
+	codecStringMap.Insert(u8"rawvideo", CodingFormatId::RawSinglePlaneVideo);
+	return codecStringMap;
+}
+
+static bool ParseEncodeFilter(const String& arguments, DataType dataType, FilterGraphBuilder* builder, const BinaryTreeMap<String, CodingFormatId>& codecStringMap)
+{
+	//codec[:threads]
+	DynamicArray<String> parts = arguments.Split(u8":");
+	if(!codecStringMap.Contains(parts[0]))
+		return false;
+
+	uint32 nThreads = 1;
+	if(parts.GetNumberOfElements() == 2)
+		nThreads = parts[1].ToUInt32();
+	if((parts.GetNumberOfElements() > 2) || (nThreads == 0))
+		return false;
+	if((nThreads > 1) && (dataType != DataType::Video))
+	{
+		stdErr << "Only video can be encoded in parallel segments. An audio encoder would insert its priming samples at every segment boundary." << endl;
+		return false;
+	}
+
+	return (builder == nullptr) || builder->InsertEncoder(dataType, codecStringMap.Get(parts[0]), nThreads);
+}
+
+static bool ParseRemixFilter(const String& arguments, FilterGraphBuilder* builder)
+{
+	//nChannels[:w,w,...]
+	DynamicArray<String> parts = arguments.Split(u8":");
+	if(parts.GetNumberOfElements() > 2)
+		return false;
+
+	uint32 nChannels = parts[0].ToUInt32();
+	if((nChannels == 0) || (nChannels > 255))
+		return false;
+
+	DynamicArray<float32> matrix;
+	if(parts.GetNumberOfElements() == 2)
+	{
+		for(const String& weight : parts[1].Split(u8","))
+			matrix.Push(float32(weight.ToFloat()));
+	}
+
+	return (builder == nullptr) || builder->InsertChannelRemixer(nChannels, matrix);
+}
+
+static bool ParseAudioFilter(const String& filter, FilterGraphBuilder* builder, const BinaryTreeMap<String, CodingFormatId>& codecStringMap)
+{
+	if((builder != nullptr) && !builder->HasSelectedStream(DataType::Audio))
+	{
+		stdErr << "The audio filter '" << filter << "' can't be applied because no audio stream is selected." << endl;
+		return false;
+	}
+
+	if(filter == u8"decode")
+		return (builder == nullptr) || builder->InsertDecoder(DataType::Audio);
+	else if(filter.StartsWith(u8"encode="))
+		return ParseEncodeFilter(filter.SubString(7), DataType::Audio, builder, codecStringMap);
+	else if(filter.StartsWith(u8"remix="))
+		return ParseRemixFilter(filter.SubString(6), builder);
+	else if(filter.StartsWith(u8"rate="))
+		return (builder == nullptr) || builder->InsertSampleRateConverter(filter.SubString(5).ToUInt32());
+	else
+		return false;
+	return true;
+}
+
+static bool ParseFormatFilter(const String& arguments, FilterGraphBuilder* builder)
+{
+	//pixelFormat[:threads]
+	DynamicArray<String> parts = arguments.Split(u8":");
+
+	NamedPixelFormat namedPixelFormat;
+	if(parts[0] == u8"bgr24")
+		namedPixelFormat = NamedPixelFormat::BGR_24;
+	else if(parts[0] == u8"rgb24")
+		namedPixelFormat = NamedPixelFormat::RGB_24;
+	else if(parts[0] == u8"yuv420p")
+		namedPixelFormat = NamedPixelFormat::YCbCr_420_P;
+	else if(parts[0] == u8"yuv422p")
+		namedPixelFormat = NamedPixelFormat::YCbCr_422_P;
+	else if(parts[0] == u8"yuv444p")
+		namedPixelFormat = NamedPixelFormat::YCbCr_444_P;
+	else
+		return false;
+
+	uint32 nThreads = 1;
+	if(parts.GetNumberOfElements() == 2)
+		nThreads = parts[1].ToUInt32();
+	if((parts.GetNumberOfElements() > 2) || (nThreads == 0))
+		return false;
+
+	return (builder == nullptr) || builder->InsertPixelFormatConverter(PixelFormat(namedPixelFormat), nThreads);
+}
+
+static bool ParseScaleFilter(const String& arguments, FilterGraphBuilder* builder)
+{
+	//WIDTHxHEIGHT[:kernel[:threads]]
+	DynamicArray<String> parts = arguments.Split(u8":");
+	if(parts.GetNumberOfElements() > 3)
+		return false;
+
+	DynamicArray<String> dimensions = parts[0].Split(u8"x");
+	if(dimensions.GetNumberOfElements() != 2)
+		return false;
+	uint32 width = dimensions[0].ToUInt32();
+	uint32 height = dimensions[1].ToUInt32();
+	if((width == 0) || (height == 0) || (width > Unsigned<uint16>::Max()) || (height > Unsigned<uint16>::Max()))
+		return false;
+
+	ScalingKernel kernel = ScalingKernel::Bicubic;
+	if(parts.GetNumberOfElements() >= 2)
+	{
+		if(parts[1] == u8"bilinear")
+			kernel = ScalingKernel::Bilinear;
+		else if(parts[1] == u8"bicubic")
+			kernel = ScalingKernel::Bicubic;
+		else if(parts[1] == u8"lanczos")
+			kernel = ScalingKernel::Lanczos;
+		else
+			return false;
+	}
+
+	uint32 nThreads = 1;
+	if(parts.GetNumberOfElements() == 3)
+		nThreads = parts[2].ToUInt32();
+	if(nThreads == 0)
+		return false;
+
+	return (builder == nullptr) || builder->InsertScaler(Math::Size<uint16>(width, height), kernel, nThreads);
+}
+
+static bool ParseVideoFilter(const String& filter, FilterGraphBuilder* builder, const BinaryTreeMap<String, CodingFormatId>& codecStringMap)
+{
+	if((builder != nullptr) && !builder->HasSelectedStream(DataType::Video))
+	{
+		stdErr << "The video filter '" << filter << "' can't be applied because no video stream is selected." << endl;
+		return false;
+	}
+
+	if(filter == u8"decode")
+		return (builder == nullptr) || builder->InsertDecoder(DataType::Video);
+	else if(filter.StartsWith(u8"decode="))
+	{
+		uint32 nThreads = filter.SubString(7).ToUInt32();
+		if(nThreads == 0)
+			return false;
+		return (builder == nullptr) || builder->InsertDecoder(DataType::Video, nThreads);
+	}
+	else if(filter.StartsWith(u8"encode="))
+		return ParseEncodeFilter(filter.SubString(7), DataType::Video, builder, codecStringMap);
+	else if(filter.StartsWith(u8"format="))
+		return ParseFormatFilter(filter.SubString(7), builder);
+	else if(filter.StartsWith(u8"scale="))
+		return ParseScaleFilter(filter.SubString(6), builder);
+	else
+		return false;
+	return true;
+}
+
+/**
+ * Parses the filters in args[begin] to args[end - 1]
+ * @param builder nullptr to only check the arguments
+ */
+static bool ParseFilters(const FixedArray<String>& args, uint32 begin, uint32 end, FilterGraphBuilder* builder, const BinaryTreeMap<String, CodingFormatId>& codecStringMap)
+{
+	for(uint32 i = begin; i < end; i++)
+	{
+		const auto& arg = args[i];
+
+		if(arg == u8"--f:a")
+		{
+			if(!ParseAudioFilter(args[i+1], builder, codecStringMap))
+				return false;
+			i++;
+		}
+		else if(arg == u8"--f:v")
+		{
+			if(!ParseVideoFilter(args[i+1], builder, codecStringMap))
+				return false;
+			i++;
+		}
+	}
+
+	return true;
+}
+
+/**
+ * @param builder nullptr to only check the arguments
+ */
+static bool BuildOutputs(const FixedArray<String>& args, const TranscoderOptions& options, FilterGraphBuilder* builder)
+{
+	const BinaryTreeMap<String, CodingFormatId> codecStringMap = CreateCodecStringMap();
+	const uint32 lastIndex = args.GetNumberOfElements() - 1;
+
+	//every --tee starts a branch that ends with its output file
+	DynamicArray<uint32> teePositions;
+	for(uint32 i = 1; i < lastIndex; i++)
+	{
+		if(args[i] == u8"--tee")
+			teePositions.Push(i);
+	}
+
+	if(teePositions.IsEmpty())
+	{
+		if(!ParseFilters(args, 1, lastIndex, builder, codecStringMap))
+			return false;
+		return (builder == nullptr) || builder->LoadSink(args[lastIndex], options.writeBehindSize);
+	}
+
+	//the filters in front of the first branch are shared by all outputs
+	if(!ParseFilters(args, 1, teePositions[0], builder, codecStringMap))
+		return false;
+
+	teePositions.Push(lastIndex + 1);
+	for(uint32 i = 0; i + 1 < teePositions.GetNumberOfElements(); i++)
+	{
+		uint32 outputIndex = teePositions[i + 1] - 1;
+		if(outputIndex == teePositions[i])
+			return false; //branch without output file
+
+		if(builder)
+			builder->BeginBranch();
+		if(!ParseFilters(args, teePositions[i] + 1, outputIndex, builder, codecStringMap))
+			return false;
+		if(builder && !builder->LoadSink(args[outputIndex], options.writeBehindSize))
+			return false;
+	}
+
+	return true;
+}
+
+static bool ParseTime(const String& string, uint64& time)
+{
+	//[[hours:]minutes:]seconds[.fraction]
+	DynamicArray<String> parts = string.Split(u8":");
+	if(parts.GetNumberOfElements() > 3)
+		return false;
+
+	float64 seconds = 0;
+	for(const String& part : parts)
+	{
+		if(part.IsEmpty())
+			return false;
+		seconds = seconds * 60 + part.ToFloat();
+	}
+	if(seconds < 0)
+		return false;
+
+	time = uint64(seconds * 1000000000.0 + 0.5);
+	return true;
+}
+
+/**
+ * Only counts what waited in the port queues at the same time, not the memory of the process (e.g. buffers inside codecs or frame pools)
+ */
+static void PrintPeakQueuedData(const FilterGraph& filterGraph)
+{
+	const FilterGraphContext& context = filterGraph.Context();
+	stdOut << u8"Peak queued data in port queues: " << context.PeakQueuedEntities() << u8" entities, " << context.PeakQueuedBytes() << u8" bytes" << endl;
+}
+
+//Global functions
+bool CheckArguments(const FixedArray<String>& args)
+{
+	TranscoderOptions options;
+	if(!ParseOptions(args, options))
+		return false;
+	return BuildOutputs(args, options, nullptr);
+}
+
+bool ParseOptions(const FixedArray<String>& args, TranscoderOptions& options)
+{
+	for(uint32 i = 1; i < args.GetNumberOfElements() - 1; i++)
+	{
+		const auto& arg = args[i];
+
+		if(arg == u8"--threads")
+		{
+			if(i + 1 >= args.GetNumberOfElements() - 1)
+				return false;
+			options.nThreads = args[i+1].ToUInt32();
+			if(options.nThreads == 0)
+				return false;
+			i++;
+		}
+		else if(arg == u8"--explain")
+			options.explain = true;
+		else if(arg == u8"--mmap")
+			options.memoryMappedInput = true;
+		else if(arg == u8"--read-ahead")
+		{
+			if(i + 1 >= args.GetNumberOfElements() - 1)
+				return false;
+			options.readAheadSize = args[i+1].ToUInt32();
+			i++;
+		}
+		else if(arg == u8"--map")
+		{
+			//inputIndex:streamIndex, there is only one input
+			if(i + 1 >= args.GetNumberOfElements() - 1)
+				return false;
+			DynamicArray<String> parts = args[i+1].Split(u8":");
+			if((parts.GetNumberOfElements() != 2) || (parts[0] != u8"0"))
+				return false;
+			options.mappedStreams.Push(parts[1].ToUInt32());
+			i++;
+		}
+		else if(arg == u8"--start")
+		{
+			if((i + 1 >= args.GetNumberOfElements() - 1) || !ParseTime(args[i+1], options.startTime))
+				return false;
+			i++;
+		}
+		else if(arg == u8"--end")
+		{
+			if((i + 1 >= args.GetNumberOfElements() - 1) || !ParseTime(args[i+1], options.endTime))
+				return false;
+			i++;
+		}
+		else if(arg == u8"--queue-bytes")
+		{
+			if(i + 1 >= args.GetNumberOfElements() - 1)
+				return false;
+			options.portCapacity.maxBytes = args[i+1].ToUInt64();
+			i++;
+		}
+		else if(arg == u8"--queue-entities")
+		{
+			if(i + 1 >= args.GetNumberOfElements() - 1)
+				return false;
+			options.portCapacity.maxEntities = args[i+1].ToUInt32();
+			i++;
+		}
+		else if(arg == u8"--stats")
+			options.printStatistics = true;
+		else if(arg == u8"--stats-json")
+		{
+			if(i + 1 >= args.GetNumberOfElements() - 1)
+				return false;
+			options.statisticsJsonPath = args[i+1];
+			i++;
+		}
+		else if(arg == u8"--write-behind")
+		{
+			if(i + 1 >= args.GetNumberOfElements() - 1)
+				return false;
+			options.writeBehindSize = args[i+1].ToUInt32();
+			i++;
+		}
+		else if(arg == u8"--trace")
+		{
+			if(i + 1 >= args.GetNumberOfElements() - 1)
+				return false;
+			options.tracePath = args[i+1];
+			i++;
+		}
+	}
+
+	return options.startTime < options.endTime;
+}
+
+TranscodingResult Transcode(const FixedArray<String>& args, const TranscoderOptions& options, bool printReport, Mutex* outputMutex)
+{
+	TranscodingResult result;
+	uint64 start = NodeStatistics::QueryTimestamp();
+
+	FilterGraph filterGraph;
+	filterGraph.SetPortCapacity(options.portCapacity);
+	filterGraph.SetProfiling(options.printStatistics || !options.statisticsJsonPath.IsEmpty());
+	if(!options.tracePath.IsEmpty())
+		filterGraph.EnableTracing();
+	FilterGraphBuilder builder(filterGraph);
+
+	if(!builder.LoadSource(args[0], options.memoryMappedInput, options.readAheadSize))
+		return result;
+	if(!options.mappedStreams.IsEmpty() && !builder.SelectStreams(options.mappedStreams))
+		return result;
+	if(!BuildOutputs(args, options, &builder))
+		return result;
+	if((options.startTime != 0) || (options.endTime != Unsigned<uint64>::Max()))
+		builder.Trim(options.startTime, options.endTime);
+
+	if(options.explain)
+	{
+		if(outputMutex)
+			outputMutex->Lock();
+		stdOut << u8"Filter graph as built:" << endl;
+		PrintGraph(filterGraph);
+		if(outputMutex)
+			outputMutex->Unlock();
+	}
+	builder.Optimize();
+	if(options.explain)
+	{
+		if(outputMutex)
+			outputMutex->Lock();
+		stdOut << u8"Optimized filter graph:" << endl;
+		PrintGraph(filterGraph);
+		if(builder.GetSourceNode()->IsConnectedDirectly())
+			stdOut << u8"The source writes its packets directly to the sink (stream copy)." << endl << endl;
+		if(outputMutex)
+			outputMutex->Unlock();
+	}
+
+	if(options.nThreads > 1)
+		filterGraph.RunParallel(options.nThreads);
+	else
+		filterGraph.Run();
+
+	if(printReport && options.printStatistics)
+	{
+		PrintPeakQueuedData(filterGraph);
+		PrintStatistics(filterGraph);
+	}
+	if(!options.statisticsJsonPath.IsEmpty())
+		WriteStatisticsJson(filterGraph, options.statisticsJsonPath);
+	if(!options.tracePath.IsEmpty())
+	{
+		FileOutputStream file(FileSystem::Path(options.tracePath));
+		filterGraph.WriteTrace(file);
+	}
+
+	result.succeeded = true;
+	result.duration = NodeStatistics::QueryTimestamp() - start;
+	result.nBytesRead = builder.GetSourceNode()->GetStatistics().nBytesOut;
+	for(const SinkNode* sinkNode : builder.GetSinkNodes())
+		result.nBytesWritten += sinkNode->GetStatistics().nBytesIn;
+	return result;
+}
\ No newline at end of file
@@ -0,0 +1,75 @@
+/*
+ * Copyright (c) 2023-2024 Amir Czwink (amir130@hotmail.de)
+ *
+ * This file is part of AVTools.
+ *
+ * AVTools is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * AVTools is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with AVTools.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#pragma once
+#include <StdXX.hpp>
+//Local
+#include "FilterGraphContext.hpp"
+//Namespaces
+using namespace StdXX;
+
+struct TranscoderOptions
+{
+	uint32 nThreads = 1;
+	/**
+	 * Source streams given by --map. Empty to select one stream per data type automatically.
+	 */
+	DynamicArray<uint32> mappedStreams;
+	/**
+	 * Range [startTime, endTime) of the input that is transcoded, in nanoseconds
+	 */
+	uint64 startTime = 0;
+	uint64 endTime = Unsigned<uint64>::Max();
+	bool explain = false;
+	bool memoryMappedInput = false;
+	bool printStatistics = false;
+	uint32 readAheadSize = 0;
+	uint32 writeBehindSize = 0;
+	String statisticsJsonPath;
+	String tracePath;
+	PortCapacity portCapacity;
+};
+
+struct TranscodingResult
+{
+	bool succeeded = false;
+	/**
+	 * Wall time in nanoseconds
+	 */
+	uint64 duration = 0;
+	uint64 nBytesRead = 0;
+	uint64 nBytesWritten = 0;
+};
+
+/**
+ * Checks the options and the syntax of the filters without opening any file. Whether the filters fit the streams of the input is only known
+ * when the graph is built.
+ * @param args see ParseOptions
+ */
+bool CheckArguments(const FixedArray<String>& args);
+/**
+ * @param args inputFile [options] outputFile or inputFile [options] --tee [options] outputFile [--tee [options] outputFile]...
+ */
+bool ParseOptions(const FixedArray<String>& args, TranscoderOptions& options);
+/**
+ * Builds and runs the filter graph for one input and one or more outputs.
+ * @param args see ParseOptions
+ * @param printReport print the peak amount of queued data and the statistics table to stdOut if requested by the options
+ * @param outputMutex if not nullptr, is held while the graph is printed to stdOut, so that concurrent transcodings don't mix their output
+ */
+TranscodingResult Transcode(const FixedArray<String>& args, const TranscoderOptions& options, bool printReport, Mutex* outputMutex = nullptr);
\ No newline at end of file
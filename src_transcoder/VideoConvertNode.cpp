@@ -0,0 +1,282 @@
+/*
+ * Copyright (c) 2023-2024 Amir Czwink (amir130@hotmail.de)
+ *
+ * This file is part of AVTools.
+ *
+ * AVTools is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * AVTools is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with AVTools.  If not, see <http://www.gnu.org/licenses/>.
+ */
+//Class Header
+#include "VideoConvertNode.hpp"
+//Local
+#include "PixelConversionKernels.hpp"
+
+//Constants
+/**
+ * Pixels per chunk. Must be even so that horizontally subsampled chroma never straddles two chunks.
+ */
+static const uint32 c_chunkWidth = 512;
+
+//Local functions
+static inline const uint8* GetRow(const Pixmap& pixmap, uint8 planeIndex, uint32 row)
+{
+    return static_cast<const uint8*>(pixmap.GetPlane(planeIndex)) + uint64(row) * pixmap.GetLineSize(planeIndex);
+}
+
+static inline uint8* GetRow(Pixmap& pixmap, uint8 planeIndex, uint32 row)
+{
+    return static_cast<uint8*>(pixmap.GetPlane(planeIndex)) + uint64(row) * pixmap.GetLineSize(planeIndex);
+}
+
+//Constructor
+VideoConvertNode::VideoConvertNode(const DecodingParameters& sourceParameters, const PixelFormat& targetPixelFormat, uint32 nThreads)
+    : sourceParameters(sourceParameters), targetPixelFormat(targetPixelFormat), nThreads(nThreads)
+{
+    this->outputPorts.Resize(1);
+
+    bool isSupported = GetPixelLayout(*sourceParameters.video.pixelFormat, this->sourceLayout) && GetPixelLayout(targetPixelFormat, this->targetLayout);
+    ASSERT(isSupported, u8"Unsupported pixel format conversion");
+    this->rgbIntermediate = this->sourceLayout.packedRgb && this->targetLayout.packedRgb;
+
+    if(nThreads > 1)
+        this->threadPool = new SliceThreadPool(nThreads);
+}
+
+//Public methods
+bool VideoConvertNode::CanProcess() const
+{
+    return this->IsDataAvailable();
+}
+
+Node* VideoConvertNode::Fuse(const Node& next) const
+{
+    const VideoConvertNode* nextConverter = dynamic_cast<const VideoConvertNode*>(&next);
+    if(nextConverter == nullptr)
+        return nullptr;
+
+    /*
+     * Converting directly gives the same result only if nothing was lost in between. That's the case if this conversion is lossless
+     * (the next one sees the same samples, just in another layout) or if the next one only reorders the RGB components.
+     */
+    const bool nextOnlyReorders = this->targetLayout.packedRgb && nextConverter->targetLayout.packedRgb;
+    if(!IsLossless(this->sourceLayout, this->targetLayout) && !nextOnlyReorders)
+        return nullptr;
+    return new VideoConvertNode(this->sourceParameters, nextConverter->targetPixelFormat, Math::Max(this->nThreads, nextConverter->nThreads));
+}
+
+String VideoConvertNode::GetName() const
+{
+    return u8"VideoConvertNode";
+}
+
+PortFormat VideoConvertNode::GetInputFormat(uint32 inputPortNumber) const
+{
+    return {
+        .packetsOrFrames = false,
+        .frameParameters = this->sourceParameters,
+    };
+}
+
+PortFormat VideoConvertNode::GetOutputFormat(uint32 outputPortNumber) const
+{
+    DecodingParameters codingParameters = this->sourceParameters;
+    codingParameters.video.pixelFormat = this->targetPixelFormat;
+    return {
+        .packetsOrFrames = false,
+        .frameParameters = codingParameters,
+    };
+}
+
+bool VideoConvertNode::IsIdentity() const
+{
+    return *this->sourceParameters.video.pixelFormat == this->targetPixelFormat;
+}
+
+void VideoConvertNode::ProcessNextEntity()
+{
+    NodeData data = this->GetNextData();
+    const Pixmap* sourcePixmap = data.GetFrame().GetPixmap();
+
+    FramePool& framePool = this->Context().framePool;
+    NodeData outputData;
+    framePool.AcquireVideoFrame(outputData, this->targetPixelFormat, sourcePixmap->GetSize());
+    outputData.frame->pts = data.GetFrame().pts;
+
+    this->sourcePixmap = sourcePixmap;
+    this->targetPixmap = outputData.frame->GetPixmap();
+
+    //a few more slices than threads balance the load, slices start at even rows so that 4:2:0 chroma rows are not shared
+    const uint32 nRows = sourcePixmap->GetSize().height;
+    const uint32 nSlices = (this->threadPool == nullptr) ? 1 : (2 * this->threadPool->GetNumberOfThreads());
+    this->nRowsPerSlice = (((nRows + nSlices - 1) / nSlices) + 1) & ~1u;
+
+    if(this->threadPool == nullptr)
+        this->ProcessSlice(0);
+    else
+        this->threadPool->Run(*this, (nRows + this->nRowsPerSlice - 1) / this->nRowsPerSlice);
+
+    this->Emit(0, Move(outputData));
+}
+
+//Class functions
+bool VideoConvertNode::GetPixelLayout(const PixelFormat& pixelFormat, PixelLayout& layout)
+{
+    if(pixelFormat == PixelFormat(NamedPixelFormat::RGB_24))
+        layout = { .packedRgb = true, .bgr = false, .chromaShiftX = 0, .chromaShiftY = 0 };
+    else if(pixelFormat == PixelFormat(NamedPixelFormat::BGR_24))
+        layout = { .packedRgb = true, .bgr = true, .chromaShiftX = 0, .chromaShiftY = 0 };
+    else if(pixelFormat == PixelFormat(NamedPixelFormat::YCbCr_420_P))
+        layout = { .packedRgb = false, .bgr = false, .chromaShiftX = 1, .chromaShiftY = 1 };
+    else if(pixelFormat == PixelFormat(NamedPixelFormat::YCbCr_422_P))
+        layout = { .packedRgb = false, .bgr = false, .chromaShiftX = 1, .chromaShiftY = 0 };
+    else if(pixelFormat == PixelFormat(NamedPixelFormat::YCbCr_444_P))
+        layout = { .packedRgb = false, .bgr = false, .chromaShiftX = 0, .chromaShiftY = 0 };
+    else
+        return false;
+    return true;
+}
+
+bool VideoConvertNode::IsSupported(const PixelFormat& sourcePixelFormat, const PixelFormat& targetPixelFormat)
+{
+    PixelLayout sourceLayout, targetLayout;
+    return GetPixelLayout(sourcePixelFormat, sourceLayout) && GetPixelLayout(targetPixelFormat, targetLayout);
+}
+
+//Private class functions
+bool VideoConvertNode::IsLossless(const PixelLayout& sourceLayout, const PixelLayout& targetLayout)
+{
+    //RGB to RGB only reorders. Chroma is upsampled by repeating samples, which the target subsampling averages back exactly
+    if(sourceLayout.packedRgb || targetLayout.packedRgb)
+        return sourceLayout.packedRgb && targetLayout.packedRgb;
+    return (targetLayout.chromaShiftX <= sourceLayout.chromaShiftX) && (targetLayout.chromaShiftY <= sourceLayout.chromaShiftY);
+}
+
+//Private methods
+void VideoConvertNode::ProcessSlice(uint32 sliceIndex)
+{
+    const Math::Size<uint16> size = this->sourcePixmap->GetSize();
+    const uint32 firstRow = sliceIndex * this->nRowsPerSlice;
+    const uint32 endRow = Math::Min(firstRow + this->nRowsPerSlice, uint32(size.height));
+    //rows that share chroma samples in the target are converted together
+    const uint32 rowStep = 1u << this->targetLayout.chromaShiftY;
+
+    uint8 buffer[2][3][c_chunkWidth];
+    uint8* samples[2][3];
+    for(uint8 r = 0; r < 2; r++)
+    {
+        for(uint8 c = 0; c < 3; c++)
+            samples[r][c] = buffer[r][c];
+    }
+
+    for(uint32 row = firstRow; row < endRow; row += rowStep)
+    {
+        const uint32 nRows = Math::Min(rowStep, endRow - row);
+        for(uint32 x = 0; x < size.width; x += c_chunkWidth)
+        {
+            const uint32 nPixels = Math::Min(c_chunkWidth, size.width - x);
+            for(uint32 r = 0; r < nRows; r++)
+                this->ReadChunk(row + r, x, nPixels, samples[r]);
+            this->WriteChunk(row, nRows, x, nPixels, samples);
+        }
+    }
+}
+
+void VideoConvertNode::ReadChunk(uint32 row, uint32 x, uint32 nPixels, uint8* const* samples) const
+{
+    const PixelLayout& layout = this->sourceLayout;
+    if(layout.packedRgb)
+    {
+        uint8* r = samples[layout.bgr ? 2 : 0];
+        uint8* g = samples[1];
+        uint8* b = samples[layout.bgr ? 0 : 2];
+
+        const uint8* source = GetRow(*this->sourcePixmap, 0, row) + 3 * x;
+        for(uint32 i = 0; i < nPixels; i++)
+        {
+            r[i] = source[3*i];
+            g[i] = source[3*i + 1];
+            b[i] = source[3*i + 2];
+        }
+
+        if(!this->rgbIntermediate)
+            PixelConversionKernels::Get().rgbToYCbCr(samples[0], samples[1], samples[2], samples[0], samples[1], samples[2], nPixels);
+        return;
+    }
+
+    MemCopy(samples[0], GetRow(*this->sourcePixmap, 0, row) + x, nPixels);
+
+    const uint32 chromaRow = row >> layout.chromaShiftY;
+    for(uint8 c = 1; c < 3; c++)
+    {
+        const uint8* source = GetRow(*this->sourcePixmap, c, chromaRow);
+        if(layout.chromaShiftX == 0)
+            MemCopy(samples[c], source + x, nPixels);
+        else
+        {
+            for(uint32 i = 0; i < nPixels; i++)
+                samples[c][i] = source[(x + i) >> layout.chromaShiftX];
+        }
+    }
+}
+
+void VideoConvertNode::WriteChunk(uint32 row, uint32 nRows, uint32 x, uint32 nPixels, uint8* const (*samples)[3])
+{
+    const PixelLayout& layout = this->targetLayout;
+    if(layout.packedRgb)
+    {
+        for(uint32 r = 0; r < nRows; r++)
+        {
+            if(!this->rgbIntermediate)
+                PixelConversionKernels::Get().yCbCrToRgb(samples[r][0], samples[r][1], samples[r][2], samples[r][0], samples[r][1], samples[r][2], nPixels);
+
+            const uint8* first = samples[r][layout.bgr ? 2 : 0];
+            const uint8* second = samples[r][1];
+            const uint8* third = samples[r][layout.bgr ? 0 : 2];
+
+            uint8* target = GetRow(*this->targetPixmap, 0, row + r) + 3 * x;
+            for(uint32 i = 0; i < nPixels; i++)
+            {
+                target[3*i] = first[i];
+                target[3*i + 1] = second[i];
+                target[3*i + 2] = third[i];
+            }
+        }
+        return;
+    }
+
+    for(uint32 r = 0; r < nRows; r++)
+        MemCopy(GetRow(*this->targetPixmap, 0, row + r) + x, samples[r][0], nPixels);
+
+    //average all samples of a chroma block
+    const uint32 blockWidth = 1u << layout.chromaShiftX;
+    const uint32 chromaX = x >> layout.chromaShiftX;
+    const uint32 nChromaSamples = (nPixels + blockWidth - 1) >> layout.chromaShiftX;
+    for(uint8 c = 1; c < 3; c++)
+    {
+        uint8* target = GetRow(*this->targetPixmap, c, row >> layout.chromaShiftY) + chromaX;
+        for(uint32 i = 0; i < nChromaSamples; i++)
+        {
+            const uint32 first = i << layout.chromaShiftX;
+            const uint32 end = Math::Min(first + blockWidth, nPixels);
+
+            uint32 sum = 0;
+            for(uint32 r = 0; r < nRows; r++)
+            {
+                for(uint32 j = first; j < end; j++)
+                    sum += samples[r][c][j];
+            }
+            const uint32 count = nRows * (end - first);
+            target[i] = uint8((sum + count / 2) / count);
+        }
+    }
+}
\ No newline at end of file
@@ -0,0 +1,98 @@
+/*
+ * Copyright (c) 2023-2024 Amir Czwink (amir130@hotmail.de)
+ *
+ * This file is part of AVTools.
+ *
+ * AVTools is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * AVTools is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with AVTools.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#pragma once
+//Local
+#include "Node.hpp"
+#include "SliceThreadPool.hpp"
+
+/**
+ * Memory layout of the pixel formats that VideoConvertNode supports (8 bit per sample)
+ */
+struct PixelLayout
+{
+    /**
+     * Packed RGB in one plane, else planar YCbCr in three planes
+     */
+    bool packedRgb;
+    /**
+     * For packed RGB: blue comes first
+     */
+    bool bgr;
+    /**
+     * For planar YCbCr: log2 of the chroma subsampling factors
+     */
+    uint8 chromaShiftX;
+    uint8 chromaShiftY;
+};
+
+/**
+ * Converts frames between RGB24, BGR24 and planar YCbCr 4:2:0, 4:2:2 and 4:4:4 (BT.601 limited range) on the CPU.
+ * Rows are converted in chunks of a few hundred pixels that stay in the L1 cache, horizontal slices of a frame are distributed over threads.
+ */
+class VideoConvertNode : public Node, private SliceTask
+{
+public:
+    //Constructor
+    VideoConvertNode(const DecodingParameters& sourceParameters, const PixelFormat& targetPixelFormat, uint32 nThreads);
+
+    //Methods
+    bool CanProcess() const override;
+    Node* Fuse(const Node& next) const override;
+    String GetName() const override;
+    PortFormat GetInputFormat(uint32 inputPortNumber) const override;
+    PortFormat GetOutputFormat(uint32 outputPortNumber) const override;
+    bool IsIdentity() const override;
+    void ProcessNextEntity() override;
+
+    //Functions
+    /**
+     * @return false if the pixel format is not supported
+     */
+    static bool GetPixelLayout(const PixelFormat& pixelFormat, PixelLayout& layout);
+    static bool IsSupported(const PixelFormat& sourcePixelFormat, const PixelFormat& targetPixelFormat);
+
+private:
+    //Members
+    DecodingParameters sourceParameters;
+    PixelFormat targetPixelFormat;
+    uint32 nThreads;
+    PixelLayout sourceLayout;
+    PixelLayout targetLayout;
+    /**
+     * Rows are carried as R, G, B between two RGB formats, else as full resolution Y, Cb, Cr
+     */
+    bool rgbIntermediate;
+    UniquePointer<SliceThreadPool> threadPool;
+
+    //State
+    const Pixmap* sourcePixmap;
+    Pixmap* targetPixmap;
+    uint32 nRowsPerSlice;
+
+    //Functions
+    /**
+     * Whether a conversion between the layouts keeps every sample, i.e. all information reaches the target.
+     */
+    static bool IsLossless(const PixelLayout& sourceLayout, const PixelLayout& targetLayout);
+
+    //Methods
+    void ProcessSlice(uint32 sliceIndex) override;
+    void ReadChunk(uint32 row, uint32 x, uint32 nPixels, uint8* const* samples) const;
+    void WriteChunk(uint32 row, uint32 nRows, uint32 x, uint32 nPixels, uint8* const (*samples)[3]);
+};
\ No newline at end of file
@@ -0,0 +1,130 @@
+/*
+ * Copyright (c) 2023-2024 Amir Czwink (amir130@hotmail.de)
+ *
+ * This file is part of AVTools.
+ *
+ * AVTools is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * AVTools is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with AVTools.  If not, see <http://www.gnu.org/licenses/>.
+ */
+//Class Header
+#include "VideoScaleKernels.hpp"
+//Global
+#if defined(__x86_64__) || defined(__i386__)
+#define VIDEOSCALEKERNELS_X86
+#include <immintrin.h>
+#endif
+
+//Scalar kernels
+/**
+ * Computes the outputs from begin on, so that the vector variants can finish their rows with it
+ */
+static void FilterRowScalar(const float32* source, const uint32* offsets, const float32* weights, uint32 nTaps, float32* target, uint32 nTargetSamples, uint32 begin)
+{
+	for(uint32 i = begin; i < nTargetSamples; i++)
+	{
+		const float32* taps = source + offsets[i];
+		float32 sum = 0;
+		for(uint32 k = 0; k < nTaps; k++)
+			sum += weights[k * nTargetSamples + i] * taps[k];
+		target[i] = sum;
+	}
+}
+
+static void FilterRowScalar(const float32* source, const uint32* offsets, const float32* weights, uint32 nTaps, float32* target, uint32 nTargetSamples)
+{
+	FilterRowScalar(source, offsets, weights, nTaps, target, nTargetSamples, 0);
+}
+
+#ifdef VIDEOSCALEKERNELS_X86
+//SSE2 kernels
+__attribute__((target("sse2")))
+static void FilterRowSSE2(const float32* source, const uint32* offsets, const float32* weights, uint32 nTaps, float32* target, uint32 nTargetSamples)
+{
+	//SSE2 has no gather, but the products and sums of four outputs are still computed together
+	uint32 i = 0;
+	for(; i + 4 <= nTargetSamples; i += 4)
+	{
+		const float32* taps0 = source + offsets[i];
+		const float32* taps1 = source + offsets[i + 1];
+		const float32* taps2 = source + offsets[i + 2];
+		const float32* taps3 = source + offsets[i + 3];
+
+		__m128 sum = _mm_setzero_ps();
+		for(uint32 k = 0; k < nTaps; k++)
+		{
+			__m128 samples = _mm_setr_ps(taps0[k], taps1[k], taps2[k], taps3[k]);
+			sum = _mm_add_ps(sum, _mm_mul_ps(_mm_loadu_ps(weights + k * nTargetSamples + i), samples));
+		}
+		_mm_storeu_ps(target + i, sum);
+	}
+	FilterRowScalar(source, offsets, weights, nTaps, target, nTargetSamples, i);
+}
+
+//AVX2 kernels
+__attribute__((target("avx2")))
+static void FilterRowAVX2(const float32* source, const uint32* offsets, const float32* weights, uint32 nTaps, float32* target, uint32 nTargetSamples)
+{
+	uint32 i = 0;
+	for(; i + 8 <= nTargetSamples; i += 8)
+	{
+		//the offsets are far below 2^31, so they can be used as signed indices
+		__m256i indices = _mm256_loadu_si256((const __m256i*)(offsets + i));
+
+		__m256 sum = _mm256_setzero_ps();
+		for(uint32 k = 0; k < nTaps; k++)
+		{
+			__m256 samples = _mm256_i32gather_ps(source + k, indices, 4);
+			sum = _mm256_add_ps(sum, _mm256_mul_ps(_mm256_loadu_ps(weights + k * nTargetSamples + i), samples));
+		}
+		_mm256_storeu_ps(target + i, sum);
+	}
+	FilterRowScalar(source, offsets, weights, nTaps, target, nTargetSamples, i);
+}
+#endif
+
+static VideoScaleKernels CreateScalarKernels()
+{
+	VideoScaleKernels kernels;
+
+	kernels.filterRow = FilterRowScalar;
+
+	return kernels;
+}
+
+static VideoScaleKernels SelectKernels()
+{
+	VideoScaleKernels kernels = CreateScalarKernels();
+
+#ifdef VIDEOSCALEKERNELS_X86
+	__builtin_cpu_init();
+	if(__builtin_cpu_supports("sse2"))
+		kernels.filterRow = FilterRowSSE2;
+	if(__builtin_cpu_supports("avx2"))
+		kernels.filterRow = FilterRowAVX2;
+#endif
+
+	return kernels;
+}
+
+//Class functions
+const VideoScaleKernels& VideoScaleKernels::Get()
+{
+	static const VideoScaleKernels kernels = SelectKernels();
+	return kernels;
+}
+
+const VideoScaleKernels& VideoScaleKernels::GetScalar()
+{
+	static const VideoScaleKernels kernels = CreateScalarKernels();
+	return kernels;
+}
\ No newline at end of file
@@ -0,0 +1,42 @@
+/*
+ * Copyright (c) 2023-2024 Amir Czwink (amir130@hotmail.de)
+ *
+ * This file is part of AVTools.
+ *
+ * AVTools is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * AVTools is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with AVTools.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#pragma once
+#include <StdXX.hpp>
+//Namespaces
+using namespace StdXX;
+
+/**
+ * Inner loops of VideoScaleNode. Vectorized variants are chosen at runtime depending on the features of the CPU and produce bit-exact the
+ * same results as the scalar ones. This relies on the compiler not fusing multiplications and additions, see the build flags of this file.
+ */
+struct VideoScaleKernels
+{
+	/**
+	 * One pass of a separable filter: target[i] is the sum of weights[k * nTargetSamples + i] * source[offsets[i] + k] over all k < nTaps.
+	 * The weights are stored tap by tap, so that the vector variants compute neighbouring outputs together.
+	 */
+	void (*filterRow)(const float32* source, const uint32* offsets, const float32* weights, uint32 nTaps, float32* target, uint32 nTargetSamples);
+
+	//Functions
+	/**
+	 * The fastest kernels that the CPU supports
+	 */
+	static const VideoScaleKernels& Get();
+	static const VideoScaleKernels& GetScalar();
+};
\ No newline at end of file
@@ -0,0 +1,295 @@
+/*
+ * Copyright (c) 2023-2024 Amir Czwink (amir130@hotmail.de)
+ *
+ * This file is part of AVTools.
+ *
+ * AVTools is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * AVTools is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with AVTools.  If not, see <http://www.gnu.org/licenses/>.
+ */
+//Class Header
+#include "VideoScaleNode.hpp"
+//Global
+#include <cmath>
+//Local
+#include "AudioSampleKernels.hpp"
+#include "VideoConvertNode.hpp"
+#include "VideoScaleKernels.hpp"
+
+//Local functions
+static float64 EvaluateKernel(ScalingKernel kernel, float64 x)
+{
+    x = fabs(x);
+    switch(kernel)
+    {
+        case ScalingKernel::Bilinear:
+            return (x < 1) ? (1 - x) : 0;
+        case ScalingKernel::Bicubic:
+        {
+            //Keys cubic convolution with a = -0.5
+            const float64 a = -0.5;
+            if(x < 1)
+                return ((a + 2) * x - (a + 3)) * x * x + 1;
+            if(x < 2)
+                return ((a * x - 5 * a) * x + 8 * a) * x - 4 * a;
+            return 0;
+        }
+        case ScalingKernel::Lanczos:
+        {
+            //three lobes
+            if(x == 0)
+                return 1;
+            if(x >= 3)
+                return 0;
+            const float64 px = PI * x;
+            return 3 * sin(px) * sin(px / 3) / (px * px);
+        }
+    }
+    return 0;
+}
+
+static float64 GetKernelSupport(ScalingKernel kernel)
+{
+    switch(kernel)
+    {
+        case ScalingKernel::Bilinear:
+            return 1;
+        case ScalingKernel::Bicubic:
+            return 2;
+        case ScalingKernel::Lanczos:
+            return 3;
+    }
+    return 0;
+}
+
+static void ComputeFilter(ScaleFilter& filter, uint32 sourceLength, uint32 targetLength, ScalingKernel kernel)
+{
+    //when downscaling, the kernel is stretched so that it also acts as low pass filter
+    const float64 scale = float64(sourceLength) / targetLength;
+    const float64 stretch = Math::Max(1.0, scale);
+    const float64 support = GetKernelSupport(kernel) * stretch;
+
+    filter.nTaps = Math::Min(uint32(ceil(2 * support)), sourceLength);
+    filter.offsets.Resize(targetLength);
+    filter.weights.Resize(targetLength * filter.nTaps);
+
+    DynamicArray<float32> weights;
+    weights.Resize(filter.nTaps);
+    for(uint32 i = 0; i < targetLength; i++)
+    {
+        //pixel centers are at half-integer positions
+        const float64 center = (i + 0.5) * scale - 0.5;
+        const int64 first = int64(floor(center - support)) + 1;
+        const int64 last = int64(ceil(center + support)) - 1;
+        const uint32 offset = uint32(Math::Min(Math::Max(first, int64(0)), int64(sourceLength - filter.nTaps)));
+        filter.offsets[i] = offset;
+
+        for(uint32 k = 0; k < filter.nTaps; k++)
+            weights[k] = 0;
+
+        float64 sum = 0;
+        for(int64 j = first; j <= last; j++)
+        {
+            const float64 weight = EvaluateKernel(kernel, (j - center) / stretch);
+            const int64 clamped = Math::Min(Math::Max(j, int64(0)), int64(sourceLength) - 1);
+            const int64 tap = Math::Min(Math::Max(clamped - int64(offset), int64(0)), int64(filter.nTaps) - 1);
+            weights[tap] += float32(weight);
+            sum += weight;
+        }
+
+        //stored tap by tap, see ScaleFilter
+        for(uint32 k = 0; k < filter.nTaps; k++)
+            filter.weights[k * targetLength + i] = float32(weights[k] / sum);
+    }
+}
+
+static inline const uint8* GetRow(const Pixmap& pixmap, uint8 planeIndex, uint32 row)
+{
+    return static_cast<const uint8*>(pixmap.GetPlane(planeIndex)) + uint64(row) * pixmap.GetLineSize(planeIndex);
+}
+
+static inline uint8* GetRow(Pixmap& pixmap, uint8 planeIndex, uint32 row)
+{
+    return static_cast<uint8*>(pixmap.GetPlane(planeIndex)) + uint64(row) * pixmap.GetLineSize(planeIndex);
+}
+
+//Constructor
+VideoScaleNode::VideoScaleNode(const DecodingParameters& sourceParameters, const Math::Size<uint16>& targetSize, ScalingKernel kernel, uint32 nThreads)
+    : sourceParameters(sourceParameters), targetSize(targetSize)
+{
+    this->outputPorts.Resize(1);
+
+    PixelLayout layout;
+    bool isSupported = VideoConvertNode::GetPixelLayout(*sourceParameters.video.pixelFormat, layout);
+    ASSERT(isSupported, u8"Unsupported pixel format");
+
+    const Math::Size<uint16>& sourceSize = sourceParameters.video.size;
+    const uint8 nPlanes = layout.packedRgb ? 1 : 3;
+    for(uint8 p = 0; p < nPlanes; p++)
+    {
+        const uint8 shiftX = (p == 0) ? 0 : layout.chromaShiftX;
+        const uint8 shiftY = (p == 0) ? 0 : layout.chromaShiftY;
+
+        PlaneScaling plane;
+        plane.planeIndex = p;
+        plane.nComponents = layout.packedRgb ? 3 : 1;
+        plane.sourceWidth = (sourceSize.width + (1u << shiftX) - 1) >> shiftX;
+        plane.targetWidth = (targetSize.width + (1u << shiftX) - 1) >> shiftX;
+        plane.targetHeight = (targetSize.height + (1u << shiftY) - 1) >> shiftY;
+
+        const uint32 sourceHeight = (sourceSize.height + (1u << shiftY) - 1) >> shiftY;
+        ComputeFilter(plane.horizontal, plane.sourceWidth, plane.targetWidth, kernel);
+        ComputeFilter(plane.vertical, sourceHeight, plane.targetHeight, kernel);
+
+        this->planes.Push(plane);
+    }
+
+    if(nThreads > 1)
+        this->threadPool = new SliceThreadPool(nThreads);
+    //a few more slices than threads balance the load
+    this->nSlicesPerPlane = (this->threadPool == nullptr) ? 1 : (2 * nThreads);
+}
+
+//Public methods
+bool VideoScaleNode::CanProcess() const
+{
+    return this->IsDataAvailable();
+}
+
+String VideoScaleNode::GetName() const
+{
+    return u8"VideoScaleNode";
+}
+
+PortFormat VideoScaleNode::GetInputFormat(uint32 inputPortNumber) const
+{
+    return {
+        .packetsOrFrames = false,
+        .frameParameters = this->sourceParameters,
+    };
+}
+
+PortFormat VideoScaleNode::GetOutputFormat(uint32 outputPortNumber) const
+{
+    DecodingParameters codingParameters = this->sourceParameters;
+    codingParameters.video.size = this->targetSize;
+    return {
+        .packetsOrFrames = false,
+        .frameParameters = codingParameters,
+    };
+}
+
+bool VideoScaleNode::IsIdentity() const
+{
+    /*
+     * At the same size every kernel is sampled at integer distances from the source pixels, i.e. the center weight is 1 and all others are 0.
+     * Only the Lanczos lobes come out as about 1e-17 instead of 0 (sin(pi) in floating point), which can't move a sample by 0.5.
+     */
+    const Math::Size<uint16>& sourceSize = this->sourceParameters.video.size;
+    return (sourceSize.width == this->targetSize.width) && (sourceSize.height == this->targetSize.height);
+}
+
+void VideoScaleNode::ProcessNextEntity()
+{
+    NodeData data = this->GetNextData();
+
+    FramePool& framePool = this->Context().framePool;
+    NodeData outputData;
+    framePool.AcquireVideoFrame(outputData, *this->sourceParameters.video.pixelFormat, this->targetSize);
+    outputData.frame->pts = data.GetFrame().pts;
+
+    this->sourcePixmap = data.GetFrame().GetPixmap();
+    this->targetPixmap = outputData.frame->GetPixmap();
+
+    const uint32 nSlices = this->planes.GetNumberOfElements() * this->nSlicesPerPlane;
+    if(this->threadPool == nullptr)
+    {
+        for(uint32 i = 0; i < nSlices; i++)
+            this->ProcessSlice(i);
+    }
+    else
+        this->threadPool->Run(*this, nSlices);
+
+    this->Emit(0, Move(outputData));
+}
+
+//Private methods
+void VideoScaleNode::ProcessSlice(uint32 sliceIndex)
+{
+    const PlaneScaling& plane = this->planes[sliceIndex / this->nSlicesPerPlane];
+    const uint32 part = sliceIndex % this->nSlicesPerPlane;
+
+    const uint32 nRowsPerSlice = (plane.targetHeight + this->nSlicesPerPlane - 1) / this->nSlicesPerPlane;
+    const uint32 firstRow = part * nRowsPerSlice;
+    const uint32 endRow = Math::Min(firstRow + nRowsPerSlice, plane.targetHeight);
+
+    for(uint8 c = 0; c < plane.nComponents; c++)
+        this->ScaleComponent(plane, c, firstRow, endRow);
+}
+
+void VideoScaleNode::ScaleComponent(const PlaneScaling& plane, uint8 component, uint32 firstRow, uint32 endRow)
+{
+    if(firstRow >= endRow)
+        return;
+
+    const auto filterRow = VideoScaleKernels::Get().filterRow;
+    const auto multiplyAccumulate = AudioSampleKernels::Get().multiplyAccumulate;
+    const ScaleFilter& horizontal = plane.horizontal;
+    const ScaleFilter& vertical = plane.vertical;
+    const uint32 nComponents = plane.nComponents;
+
+    //one input row, the output row and a ring of the last vertical.nTaps horizontally scaled rows
+    DynamicArray<float32> buffer;
+    buffer.Resize(plane.sourceWidth + (vertical.nTaps + 1) * plane.targetWidth);
+    float32* sourceRow = &buffer[0];
+    float32* accumulator = sourceRow + plane.sourceWidth;
+    float32* ring = accumulator + plane.targetWidth;
+
+    DynamicArray<uint32> ringRows;
+    ringRows.Resize(vertical.nTaps);
+    for(uint32 i = 0; i < vertical.nTaps; i++)
+        ringRows[i] = Unsigned<uint32>::Max();
+
+    for(uint32 row = firstRow; row < endRow; row++)
+    {
+        const uint32 offset = vertical.offsets[row];
+
+        MemZero(accumulator, plane.targetWidth * sizeof(float32));
+        for(uint32 k = 0; k < vertical.nTaps; k++)
+        {
+            //the offsets never decrease, so a ring slot is only overwritten once its row is not needed anymore
+            const uint32 sourceRowIndex = offset + k;
+            const uint32 slot = sourceRowIndex % vertical.nTaps;
+            float32* scaledRow = ring + slot * plane.targetWidth;
+            if(ringRows[slot] != sourceRowIndex)
+            {
+                const uint8* source = GetRow(*this->sourcePixmap, plane.planeIndex, sourceRowIndex) + component;
+                for(uint32 x = 0; x < plane.sourceWidth; x++)
+                    sourceRow[x] = source[x * nComponents];
+
+                filterRow(sourceRow, &horizontal.offsets[0], &horizontal.weights[0], horizontal.nTaps, scaledRow, plane.targetWidth);
+                ringRows[slot] = sourceRowIndex;
+            }
+
+            const float32 weight = vertical.weights[k * plane.targetHeight + row];
+            if(weight != 0)
+                multiplyAccumulate(scaledRow, weight, accumulator, plane.targetWidth);
+        }
+
+        uint8* target = GetRow(*this->targetPixmap, plane.planeIndex, row) + component;
+        for(uint32 x = 0; x < plane.targetWidth; x++)
+        {
+            const float32 value = accumulator[x] + 0.5f;
+            target[x * nComponents] = (value <= 0) ? 0 : ((value >= 255) ? 255 : uint8(value));
+        }
+    }
+}
\ No newline at end of file
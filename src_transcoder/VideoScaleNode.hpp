@@ -0,0 +1,91 @@
+/*
+ * Copyright (c) 2023-2024 Amir Czwink (amir130@hotmail.de)
+ *
+ * This file is part of AVTools.
+ *
+ * AVTools is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * AVTools is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with AVTools.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#pragma once
+//Local
+#include "Node.hpp"
+#include "SliceThreadPool.hpp"
+
+enum class ScalingKernel
+{
+    Bilinear,
+    Bicubic,
+    Lanczos
+};
+
+/**
+ * Precomputed taps of a one-dimensional resampling filter. Output sample i is the weighted sum of nTaps consecutive input samples,
+ * starting at offsets[i], with the weights weights[k * nOutputs + i] for k < nTaps. The weights are stored tap by tap so that VideoScaleKernels::filterRow
+ * can compute neighbouring outputs together. The taps never leave the input, weights beyond the edges are folded back onto them.
+ */
+struct ScaleFilter
+{
+    uint32 nTaps;
+    DynamicArray<uint32> offsets;
+    DynamicArray<float32> weights;
+};
+
+struct PlaneScaling
+{
+    uint8 planeIndex;
+    /**
+     * Interleaved samples per pixel
+     */
+    uint8 nComponents;
+    uint32 sourceWidth;
+    uint32 targetWidth;
+    uint32 targetHeight;
+    ScaleFilter horizontal;
+    ScaleFilter vertical;
+};
+
+/**
+ * Scales frames with a separable filter. Every output row is the weighted sum of horizontally scaled input rows, of which only the last few
+ * are kept in a ring buffer, so that the working set of a slice stays in the cache. Slices of output rows are distributed over threads.
+ * Supports the pixel formats of VideoConvertNode.
+ */
+class VideoScaleNode : public Node, private SliceTask
+{
+public:
+    //Constructor
+    VideoScaleNode(const DecodingParameters& sourceParameters, const Math::Size<uint16>& targetSize, ScalingKernel kernel, uint32 nThreads);
+
+    //Methods
+    bool CanProcess() const override;
+    String GetName() const override;
+    PortFormat GetInputFormat(uint32 inputPortNumber) const override;
+    PortFormat GetOutputFormat(uint32 outputPortNumber) const override;
+    bool IsIdentity() const override;
+    void ProcessNextEntity() override;
+
+private:
+    //Members
+    DecodingParameters sourceParameters;
+    Math::Size<uint16> targetSize;
+    DynamicArray<PlaneScaling> planes;
+    uint32 nSlicesPerPlane;
+    UniquePointer<SliceThreadPool> threadPool;
+
+    //State
+    const Pixmap* sourcePixmap;
+    Pixmap* targetPixmap;
+
+    //Methods
+    void ProcessSlice(uint32 sliceIndex) override;
+    void ScaleComponent(const PlaneScaling& plane, uint8 component, uint32 firstRow, uint32 endRow);
+};
\ No newline at end of file
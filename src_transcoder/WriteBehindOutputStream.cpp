@@ -0,0 +1,158 @@
+/*
+ * Copyright (c) 2023-2024 Amir Czwink (amir130@hotmail.de)
+ *
+ * This file is part of AVTools.
+ *
+ * AVTools is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * AVTools is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with AVTools.  If not, see <http://www.gnu.org/licenses/>.
+ */
+//Class Header
+#include "WriteBehindOutputStream.hpp"
+
+//WriteBehindWorker protected methods
+int32 WriteBehindWorker::ThreadMain()
+{
+    this->stream.WriteChunks();
+    return EXIT_SUCCESS;
+}
+
+//Constructor
+WriteBehindOutputStream::WriteBehindOutputStream(SeekableOutputStream* target, uint32 chunkSize, uint32 nChunks) : target(target)
+{
+    this->chunkSize = chunkSize;
+    this->targetOffset = this->target->QueryCurrentOffset();
+
+    this->shutdown = false;
+    this->writing = false;
+    for(uint32 i = 1; i < nChunks; i++)
+        this->freeBuffers.InsertTail(new uint8[chunkSize]);
+
+    this->current.data = new uint8[chunkSize];
+    this->current.offset = this->targetOffset;
+    this->current.size = 0;
+    this->position = 0;
+    this->capacity = this->chunkSize - (this->current.offset % this->chunkSize);
+
+    this->worker = new WriteBehindWorker(*this);
+    this->worker->Start();
+}
+
+//Destructor
+WriteBehindOutputStream::~WriteBehindOutputStream()
+{
+    this->Flush();
+
+    this->mutex.Lock();
+    this->shutdown = true;
+    this->chunkSubmitted.Signal();
+    this->mutex.Unlock();
+
+    this->worker->Join();
+
+    delete[] this->current.data;
+    while(!this->freeBuffers.IsEmpty())
+        delete[] this->freeBuffers.PopFront();
+}
+
+//Public methods
+void WriteBehindOutputStream::Flush()
+{
+    this->SubmitCurrentChunk(this->current.offset + this->position);
+
+    this->mutex.Lock();
+    while(!this->submittedChunks.IsEmpty() || this->writing)
+        this->chunkWritten.Wait(this->mutex);
+    this->mutex.Unlock();
+
+    this->target->Flush();
+}
+
+uint64 WriteBehindOutputStream::QueryCurrentOffset() const
+{
+    return this->current.offset + this->position;
+}
+
+void WriteBehindOutputStream::SeekTo(uint64 offset)
+{
+    if((offset >= this->current.offset) && (offset <= this->current.offset + this->current.size))
+        this->position = offset - this->current.offset;
+    else
+        this->SubmitCurrentChunk(offset);
+}
+
+uint32 WriteBehindOutputStream::WriteBytes(const void* source, uint32 size)
+{
+    const uint8* data = static_cast<const uint8*>(source);
+    uint32 nBytesWritten = 0;
+    while(nBytesWritten < size)
+    {
+        if(this->position == this->capacity)
+            this->SubmitCurrentChunk(this->current.offset + this->position);
+
+        uint32 nBytesToCopy = Math::Min(size - nBytesWritten, this->capacity - this->position);
+        MemCopy(this->current.data + this->position, data + nBytesWritten, nBytesToCopy);
+        nBytesWritten += nBytesToCopy;
+        this->position += nBytesToCopy;
+        this->current.size = Math::Max(this->current.size, this->position);
+    }
+
+    return nBytesWritten;
+}
+
+void WriteBehindOutputStream::WriteChunks()
+{
+    this->mutex.Lock();
+    while(true)
+    {
+        while(!this->shutdown && this->submittedChunks.IsEmpty())
+            this->chunkSubmitted.Wait(this->mutex);
+        if(this->submittedChunks.IsEmpty())
+            break;
+
+        Chunk chunk = this->submittedChunks.PopFront();
+        this->writing = true;
+        this->mutex.Unlock();
+
+        if(chunk.offset != this->targetOffset)
+            this->target->SeekTo(chunk.offset);
+        this->target->WriteBytes(chunk.data, chunk.size);
+        this->targetOffset = chunk.offset + chunk.size;
+
+        this->mutex.Lock();
+        this->freeBuffers.InsertTail(chunk.data);
+        this->writing = false;
+        this->chunkWritten.Signal();
+    }
+    this->mutex.Unlock();
+}
+
+//Private methods
+void WriteBehindOutputStream::SubmitCurrentChunk(uint64 nextOffset)
+{
+    if(this->current.size != 0)
+    {
+        AutoLock lock(this->mutex);
+        this->submittedChunks.InsertTail(this->current);
+        this->chunkSubmitted.Signal();
+
+        while(this->freeBuffers.IsEmpty())
+            this->chunkWritten.Wait(this->mutex);
+        this->current.data = this->freeBuffers.PopFront();
+    }
+
+    this->current.offset = nextOffset;
+    this->current.size = 0;
+    this->position = 0;
+    //a chunk that doesn't start at a multiple of the chunk size ends at the next one, so that the following chunks are aligned again
+    this->capacity = this->chunkSize - (nextOffset % this->chunkSize);
+}
\ No newline at end of file
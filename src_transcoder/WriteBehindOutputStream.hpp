@@ -0,0 +1,106 @@
+/*
+ * Copyright (c) 2023-2024 Amir Czwink (amir130@hotmail.de)
+ *
+ * This file is part of AVTools.
+ *
+ * AVTools is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * AVTools is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with AVTools.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#pragma once
+#include <StdXX.hpp>
+//Namespaces
+using namespace StdXX;
+
+class WriteBehindOutputStream;
+
+class WriteBehindWorker : public Thread
+{
+public:
+    //Constructor
+    inline WriteBehindWorker(WriteBehindOutputStream& stream) : stream(stream)
+    {
+    }
+
+protected:
+    //Methods
+    int32 ThreadMain() override;
+
+private:
+    //Members
+    WriteBehindOutputStream& stream;
+};
+
+/**
+ * Gathers the writes of the muxer in large chunks and writes them to the underlying stream on a background thread.
+ * Chunks end at multiples of the chunk size, so that the file is written in aligned blocks as long as the muxer writes sequentially.
+ * Seeking (e.g. to patch a header in Finalize) within the current chunk is free. Any other seek submits the current chunk and starts a new one
+ * at the target offset. Chunks are written in the order in which they were submitted, so later patches overwrite earlier data as expected.
+ *
+ * All methods of the stream interface must be called by one thread only.
+ */
+class WriteBehindOutputStream : public SeekableOutputStream
+{
+    struct Chunk
+    {
+        uint8* data;
+        uint64 offset;
+        uint32 size;
+    };
+public:
+    //Constructor
+    /**
+     * @param target is owned by the new stream
+     */
+    WriteBehindOutputStream(SeekableOutputStream* target, uint32 chunkSize, uint32 nChunks);
+
+    //Destructor
+    ~WriteBehindOutputStream();
+
+    //Methods
+    /**
+     * Blocks until all data is written to the underlying stream.
+     */
+    void Flush() override;
+    uint64 QueryCurrentOffset() const override;
+    void SeekTo(uint64 offset) override;
+    /**
+     * Called by the worker thread until the stream is destroyed.
+     */
+    void WriteChunks();
+    uint32 WriteBytes(const void* source, uint32 size) override;
+
+private:
+    //Members
+    UniquePointer<SeekableOutputStream> target;
+    uint32 chunkSize;
+    UniquePointer<WriteBehindWorker> worker;
+    Mutex mutex;
+    ConditionVariable chunkSubmitted;
+    ConditionVariable chunkWritten;
+
+    //State
+    //producer
+    Chunk current;
+    uint32 position;
+    uint32 capacity;
+    //shared, protected by mutex
+    bool shutdown;
+    bool writing;
+    LinkedList<Chunk> submittedChunks;
+    LinkedList<uint8*> freeBuffers;
+    //worker
+    uint64 targetOffset;
+
+    //Methods
+    void SubmitCurrentChunk(uint64 nextOffset);
+};
\ No newline at end of file
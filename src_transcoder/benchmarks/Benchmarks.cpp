@@ -0,0 +1,424 @@
+/*
+ * Copyright (c) 2023-2024 Amir Czwink (amir130@hotmail.de)
+ *
+ * This file is part of AVTools.
+ *
+ * AVTools is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * AVTools is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with AVTools.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include <StdXX.hpp>
+//Global
+#include <cmath>
+#include <type_traits>
+//Local
+#include "../AudioSampleKernels.hpp"
+#include "../AudioSampleRateNode.hpp"
+#include "../FilterGraph.hpp"
+#include "../FilterGraphBuilder.hpp"
+#include "../PortQueue.hpp"
+//Namespaces
+using namespace StdXX;
+
+//Constants
+static const uint32 c_nSamplesPerFrame = 1024;
+
+//Local classes
+/**
+ * Emits a fixed number of frames with a sine tone
+ */
+class AudioGeneratorNode : public Node
+{
+public:
+	//Constructor
+	inline AudioGeneratorNode(const DecodingParameters& parameters, uint32 nFrames) : parameters(parameters), nFrames(nFrames)
+	{
+		this->outputPorts.Resize(1);
+		this->nEmittedFrames = 0;
+
+		this->samples.Resize(c_nSamplesPerFrame);
+		for(uint32 i = 0; i < c_nSamplesPerFrame; i++)
+			this->samples[i] = float32(0.5 * sin(2 * PI * 1000 * i / parameters.audio.sampleRate));
+	}
+
+	//Methods
+	bool CanProcess() const override
+	{
+		return this->nEmittedFrames < this->nFrames;
+	}
+
+	String GetName() const override
+	{
+		return u8"AudioGeneratorNode";
+	}
+
+	PortFormat GetInputFormat(uint32 inputPortNumber) const override
+	{
+		//has no input port
+		return PortFormat();
+	}
+
+	PortFormat GetOutputFormat(uint32 outputPortNumber) const override
+	{
+		return {
+			.packetsOrFrames = false,
+			.frameParameters = this->parameters,
+		};
+	}
+
+	void ProcessNextEntity() override
+	{
+		const AudioSampleFormat& sampleFormat = *this->parameters.audio.sampleFormat;
+		FramePool& framePool = this->Context().framePool;
+
+		NodeData data;
+		framePool.AcquireAudioFrame(data, sampleFormat, c_nSamplesPerFrame);
+		data.frame->pts = uint64(this->nEmittedFrames) * c_nSamplesPerFrame;
+
+		AudioBuffer* audioBuffer = data.frame->GetAudioBuffer();
+		for(uint8 ch = 0; ch < sampleFormat.nChannels; ch++)
+			MemCopy(audioBuffer->GetPlane(ch), &this->samples[0], c_nSamplesPerFrame * sizeof(float32));
+
+		this->currentSequenceNumber = this->nEmittedFrames++;
+		this->Emit(0, Move(data));
+	}
+
+private:
+	//Members
+	DecodingParameters parameters;
+	uint32 nFrames;
+	DynamicArray<float32> samples;
+
+	//State
+	uint32 nEmittedFrames;
+};
+
+/**
+ * Counts the samples of the frames that it receives
+ */
+class SampleCounterNode : public Node
+{
+public:
+	//Constructor
+	inline SampleCounterNode(const DecodingParameters& parameters) : parameters(parameters)
+	{
+		this->nSamplesPerChannel = 0;
+	}
+
+	//Properties
+	inline uint64 GetNumberOfSamplesPerChannel() const
+	{
+		return this->nSamplesPerChannel;
+	}
+
+	//Methods
+	bool CanProcess() const override
+	{
+		return this->IsDataAvailable();
+	}
+
+	String GetName() const override
+	{
+		return u8"SampleCounterNode";
+	}
+
+	PortFormat GetInputFormat(uint32 inputPortNumber) const override
+	{
+		return {
+			.packetsOrFrames = false,
+			.frameParameters = this->parameters,
+		};
+	}
+
+	PortFormat GetOutputFormat(uint32 outputPortNumber) const override
+	{
+		//has no output port
+		return PortFormat();
+	}
+
+	void ProcessNextEntity() override
+	{
+		NodeData data = this->GetNextData();
+		this->nSamplesPerChannel += data.GetFrame().GetAudioBuffer()->GetNumberOfSamplesPerChannel();
+	}
+
+private:
+	//Members
+	DecodingParameters parameters;
+
+	//State
+	uint64 nSamplesPerChannel;
+};
+
+/**
+ * Counts the frames that it receives
+ */
+class FrameCounterNode : public Node
+{
+public:
+	//Constructor
+	inline FrameCounterNode(const DecodingParameters& parameters) : parameters(parameters)
+	{
+		this->nFrames = 0;
+	}
+
+	//Properties
+	inline uint64 GetNumberOfFrames() const
+	{
+		return this->nFrames;
+	}
+
+	//Methods
+	bool CanProcess() const override
+	{
+		return this->IsDataAvailable();
+	}
+
+	String GetName() const override
+	{
+		return u8"FrameCounterNode";
+	}
+
+	PortFormat GetInputFormat(uint32 inputPortNumber) const override
+	{
+		return {
+			.packetsOrFrames = false,
+			.frameParameters = this->parameters,
+		};
+	}
+
+	PortFormat GetOutputFormat(uint32 outputPortNumber) const override
+	{
+		//has no output port
+		return PortFormat();
+	}
+
+	void ProcessNextEntity() override
+	{
+		this->GetNextData();
+		this->nFrames++;
+	}
+
+private:
+	//Members
+	DecodingParameters parameters;
+
+	//State
+	uint64 nFrames;
+};
+
+//Local functions
+static bool BenchmarkDecoding(const String& inputPath)
+{
+	if(inputPath.IsEmpty())
+	{
+		stdErr << u8"The decoding benchmark needs an input file with a video stream." << endl;
+		return false;
+	}
+
+	for(uint32 nThreads : {1, 2, 4, 8})
+	{
+		FilterGraph filterGraph;
+		FilterGraphBuilder builder(filterGraph);
+		if(!builder.LoadSource(FileSystem::Path(inputPath)) || !builder.InsertDecoder(DataType::Video, nThreads))
+			return false;
+		FrameCounterNode* counterNode = new FrameCounterNode(builder.GetOutputFormat(DataType::Video).frameParameters);
+		builder.InsertNode(DataType::Video, counterNode);
+
+		uint64 start = NodeStatistics::QueryTimestamp();
+		filterGraph.Run();
+		float64 seconds = float64(NodeStatistics::QueryTimestamp() - start) / 1000000000;
+
+		stdOut << nThreads << u8" decoding threads: " << uint64(counterNode->GetNumberOfFrames() / seconds) << u8" frames/s ("
+			<< counterNode->GetNumberOfFrames() << u8" frames)" << endl;
+	}
+	return true;
+}
+
+template<typename SourceType, typename TargetType>
+static void BenchmarkSampleConversionKernel(const char* name, SampleConversionKernel<SourceType, TargetType> scalarKernel, SampleConversionKernel<SourceType, TargetType> kernel)
+{
+	//one second of stereo audio at 48 kHz, which stays in the cache
+	const uint32 nSamples = 2 * 48000;
+	const uint32 nRepetitions = 2000;
+
+	DynamicArray<SourceType> source;
+	DynamicArray<TargetType> target;
+	source.Resize(nSamples);
+	target.Resize(nSamples);
+	for(uint32 i = 0; i < nSamples; i++)
+	{
+		float64 value = sin(2 * PI * i / 97);
+		if constexpr (std::is_floating_point_v<SourceType>)
+			source[i] = SourceType(value);
+		else
+			source[i] = SourceType(value * Signed<SourceType>::Max());
+	}
+
+	stdOut << name << u8":";
+	for(auto currentKernel : {scalarKernel, kernel})
+	{
+		uint64 start = NodeStatistics::QueryTimestamp();
+		for(uint32 i = 0; i < nRepetitions; i++)
+			currentKernel(&source[0], &target[0], nSamples);
+		float64 seconds = float64(NodeStatistics::QueryTimestamp() - start) / 1000000000;
+
+		stdOut << u8" " << uint64(float64(nSamples) * nRepetitions / seconds / 1000000) << u8"M samples/s " << ((currentKernel == scalarKernel) ? u8"(scalar)" : u8"(dispatched)");
+	}
+	stdOut << endl;
+}
+
+static void BenchmarkSampleConversions()
+{
+	const AudioSampleKernels& scalar = AudioSampleKernels::GetScalar();
+	const AudioSampleKernels& kernels = AudioSampleKernels::Get();
+
+	BenchmarkSampleConversionKernel("float -> s16", scalar.floatToS16, kernels.floatToS16);
+	BenchmarkSampleConversionKernel("float -> s32", scalar.floatToS32, kernels.floatToS32);
+	BenchmarkSampleConversionKernel("s16 -> float", scalar.s16ToFloat, kernels.s16ToFloat);
+	BenchmarkSampleConversionKernel("s16 -> s32", scalar.s16ToS32, kernels.s16ToS32);
+	BenchmarkSampleConversionKernel("s32 -> float", scalar.s32ToFloat, kernels.s32ToFloat);
+	BenchmarkSampleConversionKernel("s32 -> s16", scalar.s32ToS16, kernels.s32ToS16);
+}
+
+static void BenchmarkPortQueues()
+{
+	const uint32 nBatches = 100000;
+	//the default port capacity
+	const uint32 nEntitiesPerBatch = 64;
+	const float64 nOperations = float64(nBatches) * nEntitiesPerBatch;
+
+	//what the input ports used before PortQueue: a locked linked list
+	{
+		Mutex lock;
+		LinkedList<NodeData> queue;
+		uint64 nQueuedBytes = 0;
+
+		uint64 start = NodeStatistics::QueryTimestamp();
+		for(uint32 i = 0; i < nBatches; i++)
+		{
+			for(uint32 j = 0; j < nEntitiesPerBatch; j++)
+			{
+				lock.Lock();
+				queue.InsertTail(NodeData());
+				nQueuedBytes += j;
+				lock.Unlock();
+			}
+			for(uint32 j = 0; j < nEntitiesPerBatch; j++)
+			{
+				lock.Lock();
+				NodeData data = queue.PopFront();
+				nQueuedBytes -= j;
+				lock.Unlock();
+			}
+		}
+		float64 seconds = float64(NodeStatistics::QueryTimestamp() - start) / 1000000000;
+
+		stdOut << u8"LinkedList with mutex: " << uint64(nOperations / seconds) << u8" push/pop pairs/s" << endl;
+	}
+
+	{
+		PortQueue<NodeData> queue(2 * nEntitiesPerBatch);
+
+		uint64 start = NodeStatistics::QueryTimestamp();
+		for(uint32 i = 0; i < nBatches; i++)
+		{
+			for(uint32 j = 0; j < nEntitiesPerBatch; j++)
+				queue.Push(NodeData(), j);
+			for(uint32 j = 0; j < nEntitiesPerBatch; j++)
+			{
+				NodeData data;
+				queue.Pop(data);
+			}
+		}
+		float64 seconds = float64(NodeStatistics::QueryTimestamp() - start) / 1000000000;
+
+		stdOut << u8"PortQueue: " << uint64(nOperations / seconds) << u8" push/pop pairs/s" << endl;
+	}
+}
+
+static void BenchmarkSampleRateConversion()
+{
+	const uint32 sourceSampleRate = 44100;
+	const uint32 targetSampleRate = 48000;
+	//one minute of audio
+	const uint32 nFrames = 60 * sourceSampleRate / c_nSamplesPerFrame;
+
+	for(uint8 nChannels : {2, 6})
+	{
+		DecodingParameters parameters;
+		parameters.dataType = DataType::Audio;
+		parameters.audio.sampleRate = sourceSampleRate;
+		parameters.audio.sampleFormat = AudioSampleFormat(nChannels, AudioSampleType::Float, true);
+
+		FilterGraph filterGraph;
+		AudioGeneratorNode* generatorNode = new AudioGeneratorNode(parameters, nFrames);
+		AudioSampleRateNode* sampleRateNode = new AudioSampleRateNode(parameters, targetSampleRate, TimeScale(1, sourceSampleRate));
+		SampleCounterNode* counterNode = new SampleCounterNode(sampleRateNode->GetOutputFormat(0).frameParameters);
+		filterGraph.AddNode(generatorNode);
+		filterGraph.AddNode(sampleRateNode);
+		filterGraph.AddNode(counterNode);
+		generatorNode->ConnectOutputPortTo(0, sampleRateNode, 0);
+		sampleRateNode->ConnectOutputPortTo(0, counterNode, 0);
+
+		uint64 start = NodeStatistics::QueryTimestamp();
+		filterGraph.Run();
+		float64 seconds = float64(NodeStatistics::QueryTimestamp() - start) / 1000000000;
+
+		const float64 nInputSamples = float64(nFrames) * c_nSamplesPerFrame;
+		stdOut << sourceSampleRate << u8" Hz -> " << targetSampleRate << u8" Hz, " << nChannels << u8" channels: "
+			<< uint64(nInputSamples / seconds) << u8" input samples/s per channel ("
+			<< uint64(nInputSamples / sourceSampleRate / seconds) << u8"x realtime, "
+			<< counterNode->GetNumberOfSamplesPerChannel() << u8" output samples per channel)" << endl;
+	}
+}
+
+static void PrintManual()
+{
+	stdOut
+			<< u8"Usage: " << endl
+			<< u8"  transcoder_benchmarks" << " benchmark [inputFile]" << endl << endl
+			<< u8"Benchmarks:" << endl
+			<< u8"  conversions\t\taudio sample type conversion kernels, scalar and dispatched" << endl
+			<< u8"  decoding\t\tdecoding the video stream of inputFile with 1, 2, 4 and 8 threads" << endl
+			<< u8"  queues\t\t\tpush/pop of the input port queues vs. a locked linked list" << endl
+			<< u8"  resampling\t\tsample rate conversion from 44.1 kHz to 48 kHz, stereo and 5.1" << endl << endl;
+}
+
+//Functions
+/**
+ * Runs one of the micro benchmarks of the transcoder and prints the throughput to stdOut. Except for decoding, they generate their input themselves.
+ */
+int32 Main(const String& programName, const FixedArray<String>& args)
+{
+	if((args.GetNumberOfElements() != 1) && (args.GetNumberOfElements() != 2))
+	{
+		PrintManual();
+		return EXIT_FAILURE;
+	}
+
+	const String& name = args[0];
+	if(name == u8"conversions")
+		BenchmarkSampleConversions();
+	else if(name == u8"decoding")
+		return BenchmarkDecoding((args.GetNumberOfElements() == 2) ? args[1] : String()) ? EXIT_SUCCESS : EXIT_FAILURE;
+	else if(name == u8"queues")
+		BenchmarkPortQueues();
+	else if(name == u8"resampling")
+		BenchmarkSampleRateConversion();
+	else
+	{
+		PrintManual();
+		return EXIT_FAILURE;
+	}
+	return EXIT_SUCCESS;
+}
\ No newline at end of file
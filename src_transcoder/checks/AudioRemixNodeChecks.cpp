@@ -0,0 +1,295 @@
+/*
+ * Copyright (c) 2023-2024 Amir Czwink (amir130@hotmail.de)
+ *
+ * This file is part of AVTools.
+ *
+ * AVTools is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * AVTools is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with AVTools.  If not, see <http://www.gnu.org/licenses/>.
+ */
+//Global
+#include <cmath>
+//Local
+#include "Checks.hpp"
+#include "../AudioRemixNode.hpp"
+#include "../FilterGraph.hpp"
+
+//Local classes
+/**
+ * Emits one frame per channel. Frame i is silent except for channel i, which is at full scale.
+ */
+class ChannelImpulseSourceNode : public Node
+{
+public:
+	//Constructor
+	inline ChannelImpulseSourceNode(const DecodingParameters& parameters) : parameters(parameters)
+	{
+		this->outputPorts.Resize(1);
+		this->nEmittedFrames = 0;
+	}
+
+	//Methods
+	bool CanProcess() const override
+	{
+		return this->nEmittedFrames < this->parameters.audio.sampleFormat->nChannels;
+	}
+
+	String GetName() const override
+	{
+		return u8"ChannelImpulseSourceNode";
+	}
+
+	PortFormat GetInputFormat(uint32 inputPortNumber) const override
+	{
+		//has no input port
+		return PortFormat();
+	}
+
+	PortFormat GetOutputFormat(uint32 outputPortNumber) const override
+	{
+		return {
+			.packetsOrFrames = false,
+			.frameParameters = this->parameters,
+		};
+	}
+
+	void ProcessNextEntity() override
+	{
+		const AudioSampleFormat& sampleFormat = *this->parameters.audio.sampleFormat;
+		FramePool& framePool = this->Context().framePool;
+
+		NodeData data;
+		framePool.AcquireAudioFrame(data, sampleFormat, 16);
+		data.frame->pts = this->nEmittedFrames;
+
+		AudioBuffer* audioBuffer = data.frame->GetAudioBuffer();
+		for(uint8 ch = 0; ch < sampleFormat.nChannels; ch++)
+		{
+			float32* samples = static_cast<float32*>(audioBuffer->GetPlane(ch));
+			for(uint32 i = 0; i < 16; i++)
+				samples[i] = (ch == this->nEmittedFrames) ? 1.0f : 0.0f;
+		}
+
+		this->currentSequenceNumber = this->nEmittedFrames++;
+		this->Emit(0, Move(data));
+	}
+
+private:
+	//Members
+	DecodingParameters parameters;
+
+	//State
+	uint32 nEmittedFrames;
+};
+
+/**
+ * Records the first sample of the left and right channel of every frame that it receives
+ */
+class StereoCollectorNode : public Node
+{
+public:
+	//Members
+	DynamicArray<float32> left;
+	DynamicArray<float32> right;
+
+	//Constructor
+	inline StereoCollectorNode(const DecodingParameters& parameters) : parameters(parameters)
+	{
+	}
+
+	//Methods
+	bool CanProcess() const override
+	{
+		return this->IsDataAvailable();
+	}
+
+	String GetName() const override
+	{
+		return u8"StereoCollectorNode";
+	}
+
+	PortFormat GetInputFormat(uint32 inputPortNumber) const override
+	{
+		return {
+			.packetsOrFrames = false,
+			.frameParameters = this->parameters,
+		};
+	}
+
+	PortFormat GetOutputFormat(uint32 outputPortNumber) const override
+	{
+		//has no output port
+		return PortFormat();
+	}
+
+	void ProcessNextEntity() override
+	{
+		NodeData data = this->GetNextData();
+		const AudioBuffer* audioBuffer = data.GetFrame().GetAudioBuffer();
+		this->left.Push(static_cast<const float32*>(audioBuffer->GetPlane(0))[0]);
+		this->right.Push(static_cast<const float32*>(audioBuffer->GetPlane(1))[0]);
+	}
+
+private:
+	//Members
+	DecodingParameters parameters;
+};
+
+//Local functions
+static DecodingParameters CreateParameters(uint8 nChannels)
+{
+	DecodingParameters parameters;
+	parameters.dataType = DataType::Audio;
+	parameters.audio.sampleRate = 48000;
+	parameters.audio.sampleFormat = AudioSampleFormat(nChannels, AudioSampleType::Float, true);
+	return parameters;
+}
+
+static inline bool IsClose(float32 a, float32 b)
+{
+	return fabs(a - b) < 1e-5f;
+}
+
+/**
+ * Runs every input channel through the default downmix to stereo. left[i] and right[i] are the weights of input channel i.
+ */
+static void DownmixToStereo(uint8 nChannels, DynamicArray<float32>& left, DynamicArray<float32>& right)
+{
+	DecodingParameters sourceParameters = CreateParameters(nChannels);
+	DecodingParameters targetParameters = CreateParameters(2);
+
+	FilterGraph filterGraph;
+	ChannelImpulseSourceNode* sourceNode = new ChannelImpulseSourceNode(sourceParameters);
+	AudioRemixNode* remixNode = new AudioRemixNode(sourceParameters, *targetParameters.audio.sampleFormat, {});
+	StereoCollectorNode* collectorNode = new StereoCollectorNode(targetParameters);
+	filterGraph.AddNode(sourceNode);
+	filterGraph.AddNode(remixNode);
+	filterGraph.AddNode(collectorNode);
+	sourceNode->ConnectOutputPortTo(0, remixNode, 0);
+	remixNode->ConnectOutputPortTo(0, collectorNode, 0);
+	filterGraph.Run();
+
+	left = collectorNode->left;
+	right = collectorNode->right;
+}
+
+/**
+ * Every channel folds into the front pair of its own side, the center and surrounds at -3 dB, LFE is dropped.
+ * The weights are scaled so that a full scale signal on all channels of one side doesn't clip.
+ */
+static void CheckDefaultDownmix(uint8 nChannels)
+{
+	const float32 c_minus3dB = 0.70710678f;
+	const AudioSampleFormat sourceFormat = *CreateParameters(nChannels).audio.sampleFormat;
+
+	DynamicArray<float32> left, right;
+	DownmixToStereo(nChannels, left, right);
+	CHECK((left.GetNumberOfElements() == nChannels) && (right.GetNumberOfElements() == nChannels));
+	if((left.GetNumberOfElements() != nChannels) || (right.GetNumberOfElements() != nChannels))
+		return;
+
+	float32 front = 0;
+	for(uint8 ch = 0; ch < nChannels; ch++)
+	{
+		if(sourceFormat.channels[ch].speaker == SpeakerPosition::Front_Left)
+			front = left[ch];
+	}
+
+	float32 leftSum = 0, rightSum = 0;
+	for(uint8 ch = 0; ch < nChannels; ch++)
+	{
+		leftSum += left[ch];
+		rightSum += right[ch];
+
+		switch(sourceFormat.channels[ch].speaker)
+		{
+			case SpeakerPosition::Front_Left:
+				CHECK(IsClose(right[ch], 0));
+				break;
+			case SpeakerPosition::Front_Right:
+				CHECK(IsClose(left[ch], 0) && IsClose(right[ch], front));
+				break;
+			case SpeakerPosition::Front_Center:
+				CHECK(IsClose(left[ch], front * c_minus3dB) && IsClose(right[ch], front * c_minus3dB));
+				break;
+			case SpeakerPosition::LowFrequency:
+				CHECK(IsClose(left[ch], 0) && IsClose(right[ch], 0));
+				break;
+			case SpeakerPosition::Side_Left:
+			case SpeakerPosition::Back_Left:
+				CHECK(IsClose(left[ch], front * c_minus3dB) && IsClose(right[ch], 0));
+				break;
+			case SpeakerPosition::Side_Right:
+			case SpeakerPosition::Back_Right:
+				CHECK(IsClose(left[ch], 0) && IsClose(right[ch], front * c_minus3dB));
+				break;
+			default:
+				CHECK(false);
+		}
+	}
+	CHECK(front > 0);
+	CHECK(IsClose(leftSum, 1) && IsClose(rightSum, 1));
+}
+
+/**
+ * The usual 5.1 to stereo coefficients, i.e. left = (FL + 0.7071 * (FC + SL)) / (1 + 2 * 0.7071) and right accordingly
+ */
+static void CheckKnownDownmixWeights()
+{
+	const float32 c_front = 0.41421356f;
+	const float32 c_centerAndSurround = 0.29289322f;
+	const AudioSampleFormat sourceFormat = *CreateParameters(6).audio.sampleFormat;
+
+	DynamicArray<float32> left, right;
+	DownmixToStereo(6, left, right);
+	CHECK((left.GetNumberOfElements() == 6) && (right.GetNumberOfElements() == 6));
+	if((left.GetNumberOfElements() != 6) || (right.GetNumberOfElements() != 6))
+		return;
+
+	for(uint8 ch = 0; ch < 6; ch++)
+	{
+		switch(sourceFormat.channels[ch].speaker)
+		{
+			case SpeakerPosition::Front_Left:
+				CHECK(IsClose(left[ch], c_front) && IsClose(right[ch], 0));
+				break;
+			case SpeakerPosition::Front_Right:
+				CHECK(IsClose(left[ch], 0) && IsClose(right[ch], c_front));
+				break;
+			case SpeakerPosition::Front_Center:
+				CHECK(IsClose(left[ch], c_centerAndSurround) && IsClose(right[ch], c_centerAndSurround));
+				break;
+			case SpeakerPosition::LowFrequency:
+				CHECK(IsClose(left[ch], 0) && IsClose(right[ch], 0));
+				break;
+			case SpeakerPosition::Side_Left:
+			case SpeakerPosition::Back_Left:
+				CHECK(IsClose(left[ch], c_centerAndSurround) && IsClose(right[ch], 0));
+				break;
+			case SpeakerPosition::Side_Right:
+			case SpeakerPosition::Back_Right:
+				CHECK(IsClose(left[ch], 0) && IsClose(right[ch], c_centerAndSurround));
+				break;
+			default:
+				CHECK(false);
+		}
+	}
+}
+
+//Functions
+void CheckAudioRemixNode()
+{
+	//5.1 and 7.1
+	CheckDefaultDownmix(6);
+	CheckDefaultDownmix(8);
+	CheckKnownDownmixWeights();
+}
\ No newline at end of file
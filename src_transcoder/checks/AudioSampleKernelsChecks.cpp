@@ -0,0 +1,120 @@
+/*
+ * Copyright (c) 2023-2024 Amir Czwink (amir130@hotmail.de)
+ *
+ * This file is part of AVTools.
+ *
+ * AVTools is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * AVTools is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with AVTools.  If not, see <http://www.gnu.org/licenses/>.
+ */
+//Global
+#include <cmath>
+#include <cstring>
+//Local
+#include "Checks.hpp"
+#include "../AudioSampleKernels.hpp"
+
+//Local functions
+/**
+ * The dispatched kernel must produce the same bits as the scalar one, for every length so that all tails are covered
+ */
+template<typename SourceType, typename TargetType>
+static bool IsBitExact(SampleConversionKernel<SourceType, TargetType> scalar, SampleConversionKernel<SourceType, TargetType> dispatched, const DynamicArray<SourceType>& source)
+{
+	DynamicArray<TargetType> expected, converted;
+	expected.Resize(source.GetNumberOfElements());
+	converted.Resize(source.GetNumberOfElements());
+
+	for(uint32 nSamples = 1; nSamples <= source.GetNumberOfElements(); nSamples += (nSamples < 70) ? 1 : 997)
+	{
+		scalar(&source[0], &expected[0], nSamples);
+		dispatched(&source[0], &converted[0], nSamples);
+		if(memcmp(&expected[0], &converted[0], nSamples * sizeof(TargetType)) != 0)
+			return false;
+	}
+	return true;
+}
+
+static void CheckSampleConversions()
+{
+	const AudioSampleKernels& scalar = AudioSampleKernels::GetScalar();
+	const AudioSampleKernels& dispatched = AudioSampleKernels::Get();
+	const uint32 c_nSamples = 4100;
+
+	//out of range values, the edges and everything in between
+	const float32 specialFloats[] = { NAN, INFINITY, -INFINITY, 1.0f, -1.0f, 1.5f, -1.5f, 0.99999994f, -0.99999994f, 0.5f / 32768, -0.5f / 32768, 0.0f, -0.0f };
+	DynamicArray<float32> floats;
+	DynamicArray<int16> s16;
+	DynamicArray<int32> s32;
+	floats.Resize(c_nSamples);
+	s16.Resize(c_nSamples);
+	s32.Resize(c_nSamples);
+	for(uint32 i = 0; i < c_nSamples; i++)
+	{
+		const uint32 nSpecialFloats = sizeof(specialFloats) / sizeof(specialFloats[0]);
+		floats[i] = (i % 3 == 0) ? specialFloats[(i / 3) % nSpecialFloats] : float32(sin(i * 0.37) * 1.1);
+		s16[i] = int16(i * 7919);
+		s32[i] = int32(i * 2654435761u);
+	}
+	s16[1] = Signed<int16>::Min();
+	s32[1] = Signed<int32>::Min();
+	s32[2] = Signed<int32>::Max();
+
+	CHECK(IsBitExact(scalar.floatToS16, dispatched.floatToS16, floats));
+	CHECK(IsBitExact(scalar.floatToS32, dispatched.floatToS32, floats));
+	CHECK(IsBitExact(scalar.s16ToFloat, dispatched.s16ToFloat, s16));
+	CHECK(IsBitExact(scalar.s16ToS32, dispatched.s16ToS32, s16));
+	CHECK(IsBitExact(scalar.s32ToFloat, dispatched.s32ToFloat, s32));
+	CHECK(IsBitExact(scalar.s32ToS16, dispatched.s32ToS16, s32));
+
+	//full scale is clipped to the positive maximum and NaN becomes the negative one
+	const float32 edges[] = { 1.0f, -1.0f, 0.5f, NAN, INFINITY };
+	int16 edgesS16[5];
+	int32 edgesS32[5];
+	scalar.floatToS16(edges, edgesS16, 5);
+	scalar.floatToS32(edges, edgesS32, 5);
+	CHECK((edgesS16[0] == 32767) && (edgesS16[1] == -32768) && (edgesS16[2] == 16384) && (edgesS16[3] == -32768) && (edgesS16[4] == 32767));
+	CHECK((edgesS32[0] == Signed<int32>::Max()) && (edgesS32[1] == Signed<int32>::Min()) && (edgesS32[2] == 1 << 30));
+}
+
+static void CheckMultiplyAccumulate()
+{
+	const AudioSampleKernels& scalar = AudioSampleKernels::GetScalar();
+	const AudioSampleKernels& dispatched = AudioSampleKernels::Get();
+	const uint32 c_nSamples = 4100;
+
+	DynamicArray<float32> source, expected, accumulated;
+	source.Resize(c_nSamples);
+	expected.Resize(c_nSamples);
+	accumulated.Resize(c_nSamples);
+
+	bool isBitExact = true;
+	for(uint32 nSamples = 1; nSamples <= c_nSamples; nSamples += (nSamples < 70) ? 1 : 997)
+	{
+		for(uint32 i = 0; i < nSamples; i++)
+		{
+			source[i] = float32(sin(i * 0.37));
+			expected[i] = accumulated[i] = float32(cos(i * 0.11));
+		}
+		scalar.multiplyAccumulate(&source[0], 0.70710678f, &expected[0], nSamples);
+		dispatched.multiplyAccumulate(&source[0], 0.70710678f, &accumulated[0], nSamples);
+		isBitExact = isBitExact && (memcmp(&expected[0], &accumulated[0], nSamples * sizeof(float32)) == 0);
+	}
+	CHECK(isBitExact);
+}
+
+//Functions
+void CheckAudioSampleKernels()
+{
+	CheckMultiplyAccumulate();
+	CheckSampleConversions();
+}
\ No newline at end of file
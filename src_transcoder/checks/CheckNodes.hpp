@@ -0,0 +1,134 @@
+/*
+ * Copyright (c) 2023-2024 Amir Czwink (amir130@hotmail.de)
+ *
+ * This file is part of AVTools.
+ *
+ * AVTools is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * AVTools is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with AVTools.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#pragma once
+#include <StdXX.hpp>
+//Local
+#include "../Node.hpp"
+//Namespaces
+using namespace StdXX;
+
+/**
+ * Emits nFrames short audio frames. Frame i has the timestamp and sequence number i and leaves through output port i % nOutputPorts.
+ */
+class FrameSourceNode : public Node
+{
+public:
+	//Constructor
+	inline FrameSourceNode(const DecodingParameters& parameters, uint32 nFrames, uint32 nOutputPorts) : parameters(parameters), nFrames(nFrames)
+	{
+		this->outputPorts.Resize(nOutputPorts);
+		this->nEmittedFrames = 0;
+	}
+
+	//Methods
+	bool CanProcess() const override
+	{
+		return this->nEmittedFrames < this->nFrames;
+	}
+
+	String GetName() const override
+	{
+		return u8"FrameSourceNode";
+	}
+
+	PortFormat GetInputFormat(uint32 inputPortNumber) const override
+	{
+		//has no input port
+		return PortFormat();
+	}
+
+	PortFormat GetOutputFormat(uint32 outputPortNumber) const override
+	{
+		return {
+			.packetsOrFrames = false,
+			.frameParameters = this->parameters,
+		};
+	}
+
+	void ProcessNextEntity() override
+	{
+		FramePool& framePool = this->Context().framePool;
+
+		NodeData data;
+		framePool.AcquireAudioFrame(data, *this->parameters.audio.sampleFormat, 16);
+		data.frame->pts = this->nEmittedFrames;
+
+		this->currentSequenceNumber = this->nEmittedFrames++;
+		this->Emit(this->currentSequenceNumber % this->outputPorts.GetNumberOfElements(), Move(data));
+	}
+
+private:
+	//Members
+	DecodingParameters parameters;
+	uint32 nFrames;
+
+	//State
+	uint32 nEmittedFrames;
+};
+
+/**
+ * Merges its inputs and records the timestamps of the frames in the order in which they arrive
+ */
+class FrameCollectorNode : public Node
+{
+public:
+	//Members
+	DynamicArray<uint64> timestamps;
+
+	//Constructor
+	inline FrameCollectorNode(const DecodingParameters& parameters) : parameters(parameters)
+	{
+		this->mergesInputs = true;
+	}
+
+	//Methods
+	bool CanProcess() const override
+	{
+		return this->IsDataAvailable();
+	}
+
+	String GetName() const override
+	{
+		return u8"FrameCollectorNode";
+	}
+
+	PortFormat GetInputFormat(uint32 inputPortNumber) const override
+	{
+		return {
+			.packetsOrFrames = false,
+			.frameParameters = this->parameters,
+		};
+	}
+
+	PortFormat GetOutputFormat(uint32 outputPortNumber) const override
+	{
+		//has no output port
+		return PortFormat();
+	}
+
+	void ProcessNextEntity() override
+	{
+		NodeData data = this->GetNextData();
+		this->timestamps.Push(data.GetFrame().pts);
+	}
+
+private:
+	//Members
+	DecodingParameters parameters;
+};
\ No newline at end of file
@@ -0,0 +1,58 @@
+/*
+ * Copyright (c) 2023-2024 Amir Czwink (amir130@hotmail.de)
+ *
+ * This file is part of AVTools.
+ *
+ * AVTools is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * AVTools is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with AVTools.  If not, see <http://www.gnu.org/licenses/>.
+ */
+//Corresponding header
+#include "Checks.hpp"
+
+//Global variables
+static uint32 g_nFailedChecks = 0;
+
+//Functions
+void ReportCheck(bool condition, const char* expression, const char* fileName, uint32 lineNumber)
+{
+	if(condition)
+		return;
+
+	stdErr << fileName << u8":" << lineNumber << u8": check failed: " << expression << endl;
+	g_nFailedChecks++;
+}
+
+int32 Main(const String& programName, const FixedArray<String>& args)
+{
+	CheckAudioRemixNode();
+	CheckAudioSampleKernels();
+	CheckFramePool();
+	CheckNodeFanOut();
+	CheckNodeFusion();
+	CheckNodeStatistics();
+	CheckPcmEncoderNode();
+	CheckPixelConversionKernels();
+	CheckPortQueue();
+	CheckSegmentParallelNode();
+	CheckSinkNode();
+	CheckVideoScaleKernels();
+	CheckWriteBehindOutputStream();
+
+	if(g_nFailedChecks != 0)
+	{
+		stdErr << g_nFailedChecks << u8" checks failed." << endl;
+		return EXIT_FAILURE;
+	}
+	stdOut << u8"All checks passed." << endl;
+	return EXIT_SUCCESS;
+}
\ No newline at end of file
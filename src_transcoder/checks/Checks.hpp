@@ -0,0 +1,45 @@
+/*
+ * Copyright (c) 2023-2024 Amir Czwink (amir130@hotmail.de)
+ *
+ * This file is part of AVTools.
+ *
+ * AVTools is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * AVTools is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with AVTools.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#pragma once
+#include <StdXX.hpp>
+//Namespaces
+using namespace StdXX;
+
+/**
+ * Reports the condition together with its location if it does not hold. The remaining checks still run, so that one run lists all failures.
+ */
+#define CHECK(condition) ReportCheck((condition), #condition, __FILE__, __LINE__)
+
+//Functions
+void ReportCheck(bool condition, const char* expression, const char* fileName, uint32 lineNumber);
+
+//Check groups
+void CheckAudioRemixNode();
+void CheckAudioSampleKernels();
+void CheckFramePool();
+void CheckNodeFanOut();
+void CheckNodeFusion();
+void CheckNodeStatistics();
+void CheckPcmEncoderNode();
+void CheckPixelConversionKernels();
+void CheckPortQueue();
+void CheckSegmentParallelNode();
+void CheckSinkNode();
+void CheckVideoScaleKernels();
+void CheckWriteBehindOutputStream();
\ No newline at end of file
@@ -0,0 +1,83 @@
+/*
+ * Copyright (c) 2023-2024 Amir Czwink (amir130@hotmail.de)
+ *
+ * This file is part of AVTools.
+ *
+ * AVTools is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * AVTools is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with AVTools.  If not, see <http://www.gnu.org/licenses/>.
+ */
+//Local
+#include "Checks.hpp"
+#include "../Node.hpp"
+
+//Constants
+static const uint32 c_nFrames = 65;
+
+//Functions
+void CheckFramePool()
+{
+	FramePool framePool;
+	const PixelFormat pixelFormat(NamedPixelFormat::YCbCr_420_P);
+	const Math::Size<uint16> size(16, 8);
+
+	//a returned frame is handed out again, before the ones that were returned earlier
+	const Frame* frames[2];
+	{
+		NodeData first, second;
+		framePool.AcquireVideoFrame(first, pixelFormat, size);
+		framePool.AcquireVideoFrame(second, pixelFormat, size);
+		frames[0] = first.frame.operator->();
+		frames[1] = second.frame.operator->();
+		CHECK(framePool.GetStatistics().nOutstanding == 2);
+	}
+	CHECK(framePool.GetStatistics().nOutstanding == 0);
+	{
+		NodeData data;
+		framePool.AcquireVideoFrame(data, pixelFormat, size);
+		CHECK(data.frame.operator->() == frames[0]);
+		CHECK(data.framePool == &framePool);
+	}
+
+	//frames of another format or size come from another bucket
+	{
+		NodeData otherSize, otherFormat, audio;
+		framePool.AcquireVideoFrame(otherSize, pixelFormat, Math::Size<uint16>(8, 8));
+		framePool.AcquireVideoFrame(otherFormat, PixelFormat(NamedPixelFormat::RGB_24), size);
+		framePool.AcquireAudioFrame(audio, AudioSampleFormat(2, AudioSampleType::Float, true), 16);
+		CHECK(otherSize.frame.operator->() != frames[0]);
+		CHECK(otherSize.frame->GetPixmap()->GetSize().width == 8);
+		CHECK(otherFormat.frame.operator->() != frames[0]);
+		CHECK(audio.frame->GetAudioBuffer()->GetNumberOfSamplesPerChannel() == 16);
+	}
+
+	FramePoolStatistics statistics = framePool.GetStatistics();
+	CHECK(statistics.nHits == 1);
+	CHECK(statistics.nMisses == 5);
+	CHECK(statistics.nOutstanding == 0);
+
+	//a bucket keeps at most 64 free frames, the remaining ones are freed
+	{
+		NodeData data[c_nFrames];
+		for(NodeData& entry : data)
+			framePool.AcquireAudioFrame(entry, AudioSampleFormat(1, AudioSampleType::S16, false), 4);
+	}
+	{
+		NodeData data[c_nFrames];
+		for(NodeData& entry : data)
+			framePool.AcquireAudioFrame(entry, AudioSampleFormat(1, AudioSampleType::S16, false), 4);
+	}
+	statistics = framePool.GetStatistics();
+	CHECK(statistics.nHits == 1 + (c_nFrames - 1));
+	CHECK(statistics.nMisses == 5 + c_nFrames + 1);
+	CHECK(statistics.nOutstanding == 0);
+}
\ No newline at end of file
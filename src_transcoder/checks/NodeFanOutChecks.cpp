@@ -0,0 +1,80 @@
+/*
+ * Copyright (c) 2023-2024 Amir Czwink (amir130@hotmail.de)
+ *
+ * This file is part of AVTools.
+ *
+ * AVTools is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * AVTools is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with AVTools.  If not, see <http://www.gnu.org/licenses/>.
+ */
+//Local
+#include "Checks.hpp"
+#include "CheckNodes.hpp"
+#include "../FilterGraph.hpp"
+
+//Local functions
+static inline bool IsComplete(const DynamicArray<uint64>& timestamps, uint32 nFrames)
+{
+	if(timestamps.GetNumberOfElements() != nFrames)
+		return false;
+	for(uint32 i = 0; i < nFrames; i++)
+	{
+		if(timestamps[i] != i)
+			return false;
+	}
+	return true;
+}
+
+/**
+ * One output port feeds three consumers, which share every frame
+ */
+static void CheckFanOut(uint32 nThreads)
+{
+	const uint32 c_nFrames = 2000;
+
+	DecodingParameters parameters;
+	parameters.dataType = DataType::Audio;
+	parameters.audio.sampleRate = 48000;
+	parameters.audio.sampleFormat = AudioSampleFormat(1, AudioSampleType::Float, true);
+
+	FilterGraph filterGraph;
+	FrameSourceNode* sourceNode = new FrameSourceNode(parameters, c_nFrames, 1);
+	filterGraph.AddNode(sourceNode);
+
+	FrameCollectorNode* collectorNodes[3];
+	for(FrameCollectorNode*& collectorNode : collectorNodes)
+	{
+		collectorNode = new FrameCollectorNode(parameters);
+		filterGraph.AddNode(collectorNode);
+		sourceNode->ConnectOutputPortTo(0, collectorNode, 0);
+	}
+
+	if(nThreads > 1)
+		filterGraph.RunParallel(nThreads);
+	else
+		filterGraph.Run();
+
+	for(FrameCollectorNode* collectorNode : collectorNodes)
+		CHECK(IsComplete(collectorNode->timestamps, c_nFrames));
+
+	//the last consumer returns a shared frame to the pool, exactly once
+	const FramePoolStatistics statistics = filterGraph.Context().framePool.GetStatistics();
+	CHECK(statistics.nOutstanding == 0);
+	CHECK(statistics.nHits + statistics.nMisses == c_nFrames);
+}
+
+//Functions
+void CheckNodeFanOut()
+{
+	CheckFanOut(1);
+	CheckFanOut(3);
+}
\ No newline at end of file
@@ -0,0 +1,441 @@
+/*
+ * Copyright (c) 2023-2024 Amir Czwink (amir130@hotmail.de)
+ *
+ * This file is part of AVTools.
+ *
+ * AVTools is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * AVTools is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with AVTools.  If not, see <http://www.gnu.org/licenses/>.
+ */
+//Local
+#include "Checks.hpp"
+#include "../AudioRemixNode.hpp"
+#include "../AudioResampleNode.hpp"
+#include "../AudioSampleRateNode.hpp"
+#include "../FilterGraph.hpp"
+#include "../VideoConvertNode.hpp"
+#include "../VideoScaleNode.hpp"
+
+//Constants
+static const uint32 c_nFrames = 4;
+static const uint32 c_nSamplesPerFrame = 333;
+
+//Local functions
+static uint8 GetNumberOfPlanes(const DecodingParameters& parameters)
+{
+	if(parameters.dataType == DataType::Audio)
+		return parameters.audio.sampleFormat->planar ? parameters.audio.sampleFormat->nChannels : 1;
+
+	PixelLayout layout;
+	VideoConvertNode::GetPixelLayout(*parameters.video.pixelFormat, layout);
+	return layout.packedRgb ? 1 : 3;
+}
+
+/**
+ * Only the samples of a plane, i.e. without the padding at the end of the rows
+ */
+static void GetPlaneExtent(const DecodingParameters& parameters, uint8 planeIndex, uint32& rowSize, uint32& nRows)
+{
+	if(parameters.dataType == DataType::Audio)
+	{
+		const AudioSampleFormat& sampleFormat = *parameters.audio.sampleFormat;
+		rowSize = c_nSamplesPerFrame * AudioSampleConverter::GetSampleSize(sampleFormat.sampleType) * (sampleFormat.planar ? 1 : sampleFormat.nChannels);
+		nRows = 1;
+		return;
+	}
+
+	PixelLayout layout;
+	VideoConvertNode::GetPixelLayout(*parameters.video.pixelFormat, layout);
+	const uint8 shiftX = (planeIndex == 0) ? 0 : layout.chromaShiftX;
+	const uint8 shiftY = (planeIndex == 0) ? 0 : layout.chromaShiftY;
+	const Math::Size<uint16>& size = parameters.video.size;
+	rowSize = ((size.width + (1u << shiftX) - 1) >> shiftX) * (layout.packedRgb ? 3 : 1);
+	nRows = (size.height + (1u << shiftY) - 1) >> shiftY;
+}
+
+static const uint8* GetRow(const Frame& frame, const DecodingParameters& parameters, uint8 planeIndex, uint32 row)
+{
+	if(parameters.dataType == DataType::Audio)
+		return static_cast<const uint8*>(frame.GetAudioBuffer()->GetPlane(planeIndex));
+	const Pixmap& pixmap = *frame.GetPixmap();
+	return static_cast<const uint8*>(pixmap.GetPlane(planeIndex)) + uint64(row) * pixmap.GetLineSize(planeIndex);
+}
+
+static uint8* GetRow(Frame& frame, const DecodingParameters& parameters, uint8 planeIndex, uint32 row)
+{
+	if(parameters.dataType == DataType::Audio)
+		return static_cast<uint8*>(frame.GetAudioBuffer()->GetPlane(planeIndex));
+	Pixmap& pixmap = *frame.GetPixmap();
+	return static_cast<uint8*>(pixmap.GetPlane(planeIndex)) + uint64(row) * pixmap.GetLineSize(planeIndex);
+}
+
+//Local classes
+/**
+ * Emits c_nFrames frames of pseudo random samples. The samples only depend on the frame parameters, so that two graphs get the same input.
+ */
+class PatternSourceNode : public Node
+{
+public:
+	//Constructor
+	inline PatternSourceNode(const DecodingParameters& parameters) : parameters(parameters)
+	{
+		this->outputPorts.Resize(1);
+		this->nEmittedFrames = 0;
+		this->state = 1;
+	}
+
+	//Methods
+	bool CanProcess() const override
+	{
+		return this->nEmittedFrames < c_nFrames;
+	}
+
+	String GetName() const override
+	{
+		return u8"PatternSourceNode";
+	}
+
+	PortFormat GetInputFormat(uint32 inputPortNumber) const override
+	{
+		//has no input port
+		return PortFormat();
+	}
+
+	PortFormat GetOutputFormat(uint32 outputPortNumber) const override
+	{
+		return {
+			.packetsOrFrames = false,
+			.frameParameters = this->parameters,
+		};
+	}
+
+	void ProcessNextEntity() override
+	{
+		FramePool& framePool = this->Context().framePool;
+
+		NodeData data;
+		if(this->parameters.dataType == DataType::Audio)
+			framePool.AcquireAudioFrame(data, *this->parameters.audio.sampleFormat, c_nSamplesPerFrame);
+		else
+			framePool.AcquireVideoFrame(data, *this->parameters.video.pixelFormat, this->parameters.video.size);
+		data.frame->pts = this->nEmittedFrames;
+
+		//floats must stay in the nominal range, everything else may have any bit pattern
+		const bool isFloat = (this->parameters.dataType == DataType::Audio) && (this->parameters.audio.sampleFormat->sampleType == AudioSampleType::Float);
+		for(uint8 p = 0; p < GetNumberOfPlanes(this->parameters); p++)
+		{
+			uint32 rowSize, nRows;
+			GetPlaneExtent(this->parameters, p, rowSize, nRows);
+			for(uint32 row = 0; row < nRows; row++)
+			{
+				uint8* target = GetRow(*data.frame, this->parameters, p, row);
+				if(isFloat)
+				{
+					float32* samples = reinterpret_cast<float32*>(target);
+					for(uint32 i = 0; i < rowSize / sizeof(float32); i++)
+						samples[i] = float32(this->NextRandom() & 0xFFFFFF) / 0x800000 - 1;
+				}
+				else
+				{
+					for(uint32 i = 0; i < rowSize; i++)
+						target[i] = uint8(this->NextRandom());
+				}
+			}
+		}
+
+		this->currentSequenceNumber = this->nEmittedFrames++;
+		this->Emit(0, Move(data));
+	}
+
+private:
+	//Members
+	DecodingParameters parameters;
+
+	//State
+	uint32 nEmittedFrames;
+	uint64 state;
+
+	//Inline
+	inline uint32 NextRandom()
+	{
+		this->state = this->state * 6364136223846793005ull + 1442695040888963407ull;
+		return uint32(this->state >> 33);
+	}
+};
+
+/**
+ * Appends the samples of all frames that it receives to one array
+ */
+class ByteCollectorNode : public Node
+{
+public:
+	//Members
+	DynamicArray<uint8> bytes;
+
+	//Constructor
+	inline ByteCollectorNode(const DecodingParameters& parameters) : parameters(parameters)
+	{
+	}
+
+	//Methods
+	bool CanProcess() const override
+	{
+		return this->IsDataAvailable();
+	}
+
+	String GetName() const override
+	{
+		return u8"ByteCollectorNode";
+	}
+
+	PortFormat GetInputFormat(uint32 inputPortNumber) const override
+	{
+		return {
+			.packetsOrFrames = false,
+			.frameParameters = this->parameters,
+		};
+	}
+
+	PortFormat GetOutputFormat(uint32 outputPortNumber) const override
+	{
+		//has no output port
+		return PortFormat();
+	}
+
+	void ProcessNextEntity() override
+	{
+		NodeData data = this->GetNextData();
+		for(uint8 p = 0; p < GetNumberOfPlanes(this->parameters); p++)
+		{
+			uint32 rowSize, nRows;
+			GetPlaneExtent(this->parameters, p, rowSize, nRows);
+			for(uint32 row = 0; row < nRows; row++)
+			{
+				const uint8* source = GetRow(data.GetFrame(), this->parameters, p, row);
+				for(uint32 i = 0; i < rowSize; i++)
+					this->bytes.Push(source[i]);
+			}
+		}
+	}
+
+private:
+	//Members
+	DecodingParameters parameters;
+};
+
+//Local functions
+static DecodingParameters CreateAudioParameters(uint8 nChannels, AudioSampleType sampleType, bool planar)
+{
+	DecodingParameters parameters;
+	parameters.dataType = DataType::Audio;
+	parameters.audio.sampleRate = 48000;
+	parameters.audio.sampleFormat = AudioSampleFormat(nChannels, sampleType, planar);
+	return parameters;
+}
+
+static DecodingParameters CreateVideoParameters(NamedPixelFormat pixelFormat)
+{
+	//odd, so that the last chroma samples cover only part of a block
+	DecodingParameters parameters;
+	parameters.dataType = DataType::Video;
+	parameters.video.size = Math::Size<uint16>(37, 21);
+	parameters.video.pixelFormat = PixelFormat(pixelFormat);
+	return parameters;
+}
+
+static DynamicArray<float32> CreateMatrix(float32 a, float32 b, float32 c, float32 d)
+{
+	DynamicArray<float32> matrix;
+	matrix.Push(a);
+	matrix.Push(b);
+	matrix.Push(c);
+	matrix.Push(d);
+	return matrix;
+}
+
+/**
+ * Runs the pattern through the chain of nodes, which the graph takes the ownership of, and returns the samples that leave it
+ */
+static DynamicArray<uint8> Process(const DecodingParameters& sourceParameters, Node* first = nullptr, Node* second = nullptr)
+{
+	FilterGraph filterGraph;
+	Node* last = new PatternSourceNode(sourceParameters);
+	filterGraph.AddNode(last);
+	for(Node* node : {first, second})
+	{
+		if(node == nullptr)
+			continue;
+		filterGraph.AddNode(node);
+		last->ConnectOutputPortTo(0, node, 0);
+		last = node;
+	}
+
+	ByteCollectorNode* collectorNode = new ByteCollectorNode(last->GetOutputFormat(0).frameParameters);
+	filterGraph.AddNode(collectorNode);
+	last->ConnectOutputPortTo(0, collectorNode, 0);
+	filterGraph.Run();
+
+	return collectorNode->bytes;
+}
+
+static bool IsEqual(const DynamicArray<uint8>& a, const DynamicArray<uint8>& b)
+{
+	if(a.GetNumberOfElements() != b.GetNumberOfElements())
+		return false;
+	for(uint32 i = 0; i < a.GetNumberOfElements(); i++)
+	{
+		if(a[i] != b[i])
+			return false;
+	}
+	return true;
+}
+
+/**
+ * Whether the two nodes fuse and the fused node produces exactly the same output as both of them in a row. Takes the ownership of the nodes.
+ */
+static bool FusesExactly(Node* first, Node* second)
+{
+	Node* fused = first->Fuse(*second);
+	if(fused == nullptr)
+	{
+		delete first;
+		delete second;
+		return false;
+	}
+
+	const DecodingParameters sourceParameters = first->GetInputFormat(0).frameParameters;
+	const DynamicArray<uint8> expected = Process(sourceParameters, first, second);
+	return !expected.IsEmpty() && IsEqual(Process(sourceParameters, fused), expected);
+}
+
+/**
+ * Whether the node claims to be an identity and indeed reproduces its input. Takes the ownership of the node.
+ */
+static bool IsExactIdentity(Node* node)
+{
+	const DecodingParameters sourceParameters = node->GetInputFormat(0).frameParameters;
+	if(!node->IsIdentity())
+	{
+		delete node;
+		return false;
+	}
+	return IsEqual(Process(sourceParameters, node), Process(sourceParameters));
+}
+
+static bool DoesNotFuse(const Node& first, const Node& second)
+{
+	return UniquePointer<Node>(first.Fuse(second)).IsNull();
+}
+
+static void CheckAudioResampleNodes()
+{
+	const DecodingParameters s16Interleaved = CreateAudioParameters(2, AudioSampleType::S16, false);
+	const DecodingParameters s16Planar = CreateAudioParameters(2, AudioSampleType::S16, true);
+	const DecodingParameters s32Planar = CreateAudioParameters(2, AudioSampleType::S32, true);
+	const DecodingParameters floatInterleaved = CreateAudioParameters(2, AudioSampleType::Float, false);
+	const DecodingParameters floatPlanar = CreateAudioParameters(2, AudioSampleType::Float, true);
+
+	//16 bit integers are widened exactly
+	CHECK(FusesExactly(new AudioResampleNode(s16Interleaved, *floatPlanar.audio.sampleFormat), new AudioResampleNode(floatPlanar, AudioSampleFormat(2, AudioSampleType::S32, false))));
+	CHECK(FusesExactly(new AudioResampleNode(s16Planar, *s32Planar.audio.sampleFormat), new AudioResampleNode(s32Planar, *s16Interleaved.audio.sampleFormat)));
+	CHECK(FusesExactly(new AudioResampleNode(s16Planar, *floatPlanar.audio.sampleFormat), new AudioResampleNode(floatPlanar, *s16Interleaved.audio.sampleFormat)));
+
+	//one of the steps only changes the layout
+	CHECK(FusesExactly(new AudioResampleNode(floatInterleaved, *floatPlanar.audio.sampleFormat), new AudioResampleNode(floatPlanar, *s16Planar.audio.sampleFormat)));
+	CHECK(FusesExactly(new AudioResampleNode(floatPlanar, *s16Planar.audio.sampleFormat), new AudioResampleNode(s16Planar, *s16Interleaved.audio.sampleFormat)));
+
+	//round trips through a narrower type are lossy
+	CHECK(DoesNotFuse(AudioResampleNode(floatPlanar, *s16Planar.audio.sampleFormat), AudioResampleNode(s16Planar, *floatPlanar.audio.sampleFormat)));
+	CHECK(DoesNotFuse(AudioResampleNode(s32Planar, *s16Planar.audio.sampleFormat), AudioResampleNode(s16Planar, *s32Planar.audio.sampleFormat)));
+
+	//the filter also runs at the same rate, so two converters never collapse
+	DecodingParameters rate44100 = floatPlanar;
+	rate44100.audio.sampleRate = 44100;
+	CHECK(DoesNotFuse(AudioSampleRateNode(floatPlanar, 44100, TimeScale(1, 48000)), AudioSampleRateNode(rate44100, 48000, TimeScale(1, 48000))));
+}
+
+static void CheckAudioRemixNodes()
+{
+	const DecodingParameters stereo = CreateAudioParameters(2, AudioSampleType::Float, true);
+	const DecodingParameters surround = CreateAudioParameters(6, AudioSampleType::Float, true);
+	const DynamicArray<float32> swapMatrix = CreateMatrix(0, 1, 1, 0);
+
+	CHECK(IsExactIdentity(new AudioRemixNode(stereo, *stereo.audio.sampleFormat, CreateMatrix(1, 0, 0, 1))));
+	CHECK(!AudioRemixNode(stereo, *stereo.audio.sampleFormat, swapMatrix).IsIdentity());
+
+	//swapping the channels twice leaves them where they were
+	AudioRemixNode swapNode(stereo, *stereo.audio.sampleFormat, swapMatrix);
+	UniquePointer<Node> fused(swapNode.Fuse(swapNode));
+	CHECK(!fused.IsNull() && fused->IsIdentity());
+	CHECK(FusesExactly(new AudioRemixNode(stereo, *stereo.audio.sampleFormat, swapMatrix), new AudioRemixNode(stereo, *stereo.audio.sampleFormat, swapMatrix)));
+
+	//selecting channels after a downmix only picks rows of its matrix
+	CHECK(FusesExactly(new AudioRemixNode(surround, *stereo.audio.sampleFormat, {}), new AudioRemixNode(stereo, *stereo.audio.sampleFormat, swapMatrix)));
+
+	//mixing twice rounds differently than mixing with the product of both matrices
+	DynamicArray<float32> average;
+	average.Push(0.5f);
+	average.Push(0.5f);
+	CHECK(DoesNotFuse(AudioRemixNode(surround, *stereo.audio.sampleFormat, {}), AudioRemixNode(stereo, AudioSampleFormat(1, AudioSampleType::Float, true), average)));
+
+	CHECK(DoesNotFuse(swapNode, AudioSampleRateNode(stereo, 44100, TimeScale(1, 48000))));
+}
+
+static void CheckVideoConvertNodes()
+{
+	const DecodingParameters yCbCr420 = CreateVideoParameters(NamedPixelFormat::YCbCr_420_P);
+	const DecodingParameters yCbCr422 = CreateVideoParameters(NamedPixelFormat::YCbCr_422_P);
+	const DecodingParameters yCbCr444 = CreateVideoParameters(NamedPixelFormat::YCbCr_444_P);
+	const DecodingParameters rgb = CreateVideoParameters(NamedPixelFormat::RGB_24);
+
+	//upsampling chroma loses nothing
+	CHECK(FusesExactly(new VideoConvertNode(yCbCr420, PixelFormat(NamedPixelFormat::YCbCr_444_P), 1), new VideoConvertNode(yCbCr444, PixelFormat(NamedPixelFormat::RGB_24), 1)));
+	CHECK(FusesExactly(new VideoConvertNode(yCbCr422, PixelFormat(NamedPixelFormat::YCbCr_444_P), 1), new VideoConvertNode(yCbCr444, PixelFormat(NamedPixelFormat::YCbCr_420_P), 2)));
+	CHECK(FusesExactly(new VideoConvertNode(yCbCr420, PixelFormat(NamedPixelFormat::YCbCr_422_P), 1), new VideoConvertNode(yCbCr422, PixelFormat(NamedPixelFormat::YCbCr_420_P), 1)));
+
+	//reordering the components afterwards neither
+	CHECK(FusesExactly(new VideoConvertNode(yCbCr420, PixelFormat(NamedPixelFormat::RGB_24), 1), new VideoConvertNode(rgb, PixelFormat(NamedPixelFormat::BGR_24), 1)));
+
+	//round trips are lossy
+	CHECK(DoesNotFuse(VideoConvertNode(rgb, PixelFormat(NamedPixelFormat::YCbCr_420_P), 1), VideoConvertNode(yCbCr420, PixelFormat(NamedPixelFormat::RGB_24), 1)));
+	CHECK(DoesNotFuse(VideoConvertNode(yCbCr420, PixelFormat(NamedPixelFormat::RGB_24), 1), VideoConvertNode(rgb, PixelFormat(NamedPixelFormat::YCbCr_420_P), 1)));
+	CHECK(DoesNotFuse(VideoConvertNode(yCbCr444, PixelFormat(NamedPixelFormat::YCbCr_420_P), 1), VideoConvertNode(yCbCr420, PixelFormat(NamedPixelFormat::YCbCr_444_P), 1)));
+}
+
+static void CheckVideoScaleNodes()
+{
+	const DecodingParameters yCbCr420 = CreateVideoParameters(NamedPixelFormat::YCbCr_420_P);
+	const DecodingParameters rgb = CreateVideoParameters(NamedPixelFormat::RGB_24);
+
+	for(ScalingKernel kernel : {ScalingKernel::Bilinear, ScalingKernel::Bicubic, ScalingKernel::Lanczos})
+	{
+		CHECK(IsExactIdentity(new VideoScaleNode(yCbCr420, yCbCr420.video.size, kernel, 1)));
+		CHECK(IsExactIdentity(new VideoScaleNode(rgb, rgb.video.size, kernel, 2)));
+
+		//scaling down and up again loses the details
+		DecodingParameters halfSize = yCbCr420;
+		halfSize.video.size = Math::Size<uint16>(19, 11);
+		VideoScaleNode downscaleNode(yCbCr420, halfSize.video.size, kernel, 1);
+		CHECK(!downscaleNode.IsIdentity());
+		CHECK(DoesNotFuse(downscaleNode, VideoScaleNode(halfSize, yCbCr420.video.size, kernel, 1)));
+		CHECK(DoesNotFuse(downscaleNode, VideoConvertNode(halfSize, PixelFormat(NamedPixelFormat::RGB_24), 1)));
+	}
+}
+
+//Functions
+void CheckNodeFusion()
+{
+	CheckAudioResampleNodes();
+	CheckAudioRemixNodes();
+	CheckVideoConvertNodes();
+	CheckVideoScaleNodes();
+}
\ No newline at end of file
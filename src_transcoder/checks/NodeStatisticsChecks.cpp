@@ -0,0 +1,61 @@
+/*
+ * Copyright (c) 2023-2024 Amir Czwink (amir130@hotmail.de)
+ *
+ * This file is part of AVTools.
+ *
+ * AVTools is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * AVTools is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with AVTools.  If not, see <http://www.gnu.org/licenses/>.
+ */
+//Local
+#include "Checks.hpp"
+#include "../NodeStatistics.hpp"
+
+//Local functions
+static uint64 ComputeUpperBound(uint64 processingTime)
+{
+	NodeStatistics statistics;
+	statistics.AddProcessingTime(processingTime);
+	return statistics.ComputePercentile(100);
+}
+
+//Functions
+void CheckNodeStatistics()
+{
+	NodeStatistics empty;
+	CHECK(empty.ComputePercentile(50) == 0);
+
+	//the bucket of a time must contain it and may be at most 25% wider
+	for(uint64 time = 0; time < 100000; time++)
+	{
+		uint64 upperBound = ComputeUpperBound(time);
+		CHECK((upperBound >= time) && (upperBound <= time + time / 4));
+	}
+	for(uint32 exponent = 17; exponent < 63; exponent++)
+	{
+		uint64 time = (uint64(1) << exponent) + 12345;
+		uint64 upperBound = ComputeUpperBound(time);
+		CHECK((upperBound >= time) && (upperBound <= time + time / 4));
+	}
+
+	//99 fast calls and a slow one
+	NodeStatistics statistics;
+	for(uint32 i = 0; i < 99; i++)
+		statistics.AddProcessingTime(1000);
+	statistics.AddProcessingTime(1000000);
+
+	CHECK(statistics.nProcessCalls == 100);
+	CHECK(statistics.totalProcessingTime == 99 * 1000 + 1000000);
+	CHECK(statistics.ComputePercentile(50) == ComputeUpperBound(1000));
+	CHECK(statistics.ComputePercentile(99) == ComputeUpperBound(1000));
+	CHECK(statistics.ComputePercentile(100) == ComputeUpperBound(1000000));
+}
\ No newline at end of file
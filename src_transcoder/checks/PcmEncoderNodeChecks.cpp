@@ -0,0 +1,184 @@
+/*
+ * Copyright (c) 2023-2024 Amir Czwink (amir130@hotmail.de)
+ *
+ * This file is part of AVTools.
+ *
+ * AVTools is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * AVTools is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with AVTools.  If not, see <http://www.gnu.org/licenses/>.
+ */
+//Global
+#include <cstring>
+//Local
+#include "Checks.hpp"
+#include "../FilterGraph.hpp"
+#include "../PcmEncoderNode.hpp"
+
+//Local classes
+/**
+ * Emits a single planar stereo frame with the samples 0.5, -0.25 on the left and 1.0, 0.0 on the right channel
+ */
+class StereoFrameSourceNode : public Node
+{
+public:
+	//Constructor
+	inline StereoFrameSourceNode(const DecodingParameters& parameters) : parameters(parameters)
+	{
+		this->outputPorts.Resize(1);
+		this->emitted = false;
+	}
+
+	//Methods
+	bool CanProcess() const override
+	{
+		return !this->emitted;
+	}
+
+	String GetName() const override
+	{
+		return u8"StereoFrameSourceNode";
+	}
+
+	PortFormat GetInputFormat(uint32 inputPortNumber) const override
+	{
+		//has no input port
+		return PortFormat();
+	}
+
+	PortFormat GetOutputFormat(uint32 outputPortNumber) const override
+	{
+		return {
+			.packetsOrFrames = false,
+			.frameParameters = this->parameters,
+		};
+	}
+
+	void ProcessNextEntity() override
+	{
+		FramePool& framePool = this->Context().framePool;
+
+		NodeData data;
+		framePool.AcquireAudioFrame(data, *this->parameters.audio.sampleFormat, 2);
+		data.frame->pts = 0;
+
+		AudioBuffer* audioBuffer = data.frame->GetAudioBuffer();
+		float32* left = static_cast<float32*>(audioBuffer->GetPlane(0));
+		float32* right = static_cast<float32*>(audioBuffer->GetPlane(1));
+		left[0] = 0.5f;
+		left[1] = -0.25f;
+		right[0] = 1.0f;
+		right[1] = 0.0f;
+
+		this->emitted = true;
+		this->currentSequenceNumber = 0;
+		this->Emit(0, Move(data));
+	}
+
+private:
+	//Members
+	DecodingParameters parameters;
+
+	//State
+	bool emitted;
+};
+
+/**
+ * Appends the payload of all packets that it receives
+ */
+class PayloadCollectorNode : public Node
+{
+public:
+	//Members
+	DynamicArray<uint8> payload;
+
+	//Constructor
+	inline PayloadCollectorNode(const DecodingParameters& parameters) : parameters(parameters)
+	{
+	}
+
+	//Methods
+	bool CanProcess() const override
+	{
+		return this->IsDataAvailable();
+	}
+
+	String GetName() const override
+	{
+		return u8"PayloadCollectorNode";
+	}
+
+	PortFormat GetInputFormat(uint32 inputPortNumber) const override
+	{
+		return {
+			.packetsOrFrames = true,
+			.frameParameters = this->parameters,
+		};
+	}
+
+	PortFormat GetOutputFormat(uint32 outputPortNumber) const override
+	{
+		//has no output port
+		return PortFormat();
+	}
+
+	void ProcessNextEntity() override
+	{
+		NodeData data = this->GetNextData();
+		const IPacket& packet = data.GetPacket();
+		for(uint32 i = 0; i < packet.GetSize(); i++)
+			this->payload.Push(packet.GetData()[i]);
+	}
+
+private:
+	//Members
+	DecodingParameters parameters;
+};
+
+//Local functions
+static bool EncodesTo(AudioSampleType sampleType, const uint8* expected, uint32 size)
+{
+	DecodingParameters sourceParameters;
+	sourceParameters.dataType = DataType::Audio;
+	sourceParameters.audio.sampleRate = 48000;
+	sourceParameters.audio.sampleFormat = AudioSampleFormat(2, AudioSampleType::Float, true);
+
+	EncodingParameters encodingParameters = sourceParameters;
+	encodingParameters.audio.sampleFormat = AudioSampleFormat(2, sampleType, false);
+
+	FilterGraph filterGraph;
+	StereoFrameSourceNode* sourceNode = new StereoFrameSourceNode(sourceParameters);
+	PcmEncoderNode* encoderNode = new PcmEncoderNode(sourceParameters, encodingParameters);
+	PayloadCollectorNode* collectorNode = new PayloadCollectorNode(encodingParameters);
+	filterGraph.AddNode(sourceNode);
+	filterGraph.AddNode(encoderNode);
+	filterGraph.AddNode(collectorNode);
+	sourceNode->ConnectOutputPortTo(0, encoderNode, 0);
+	encoderNode->ConnectOutputPortTo(0, collectorNode, 0);
+	filterGraph.Run();
+
+	const DynamicArray<uint8>& payload = collectorNode->payload;
+	return (payload.GetNumberOfElements() == size) && (memcmp(&payload[0], expected, size) == 0);
+}
+
+//Functions
+void CheckPcmEncoderNode()
+{
+	AudioSampleType sampleType;
+	CHECK(PcmEncoderNode::IsSupported(CodingFormatId::PCM_S16LE, sampleType) && (sampleType == AudioSampleType::S16));
+	CHECK(PcmEncoderNode::IsSupported(CodingFormatId::PCM_Float32LE, sampleType) && (sampleType == AudioSampleType::Float));
+
+	//interleaved little endian, independent of the byte order of the host
+	const uint8 s16le[] = { 0x00, 0x40, 0xFF, 0x7F, 0x00, 0xE0, 0x00, 0x00 };
+	const uint8 f32le[] = { 0x00, 0x00, 0x00, 0x3F, 0x00, 0x00, 0x80, 0x3F, 0x00, 0x00, 0x80, 0xBE, 0x00, 0x00, 0x00, 0x00 };
+	CHECK(EncodesTo(AudioSampleType::S16, s16le, sizeof(s16le)));
+	CHECK(EncodesTo(AudioSampleType::Float, f32le, sizeof(f32le)));
+}
\ No newline at end of file
@@ -0,0 +1,83 @@
+/*
+ * Copyright (c) 2023-2024 Amir Czwink (amir130@hotmail.de)
+ *
+ * This file is part of AVTools.
+ *
+ * AVTools is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * AVTools is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with AVTools.  If not, see <http://www.gnu.org/licenses/>.
+ */
+//Global
+#include <cstring>
+//Local
+#include "Checks.hpp"
+#include "../PixelConversionKernels.hpp"
+
+//Local functions
+/**
+ * Runs all 2^24 combinations of the three input samples through both kernels, in rows of every length up to c_rowLength
+ */
+static bool IsBitExact(void (*scalar)(const uint8*, const uint8*, const uint8*, uint8*, uint8*, uint8*, uint32), void (*dispatched)(const uint8*, const uint8*, const uint8*, uint8*, uint8*, uint8*, uint32))
+{
+	const uint32 c_rowLength = 4096;
+	const uint32 c_nCombinations = 1 << 24;
+
+	DynamicArray<uint8> input, expected, converted;
+	input.Resize(3 * c_rowLength);
+	expected.Resize(3 * c_rowLength);
+	converted.Resize(3 * c_rowLength);
+
+	uint32 nPixels = 1;
+	for(uint32 first = 0; first < c_nCombinations; first += nPixels)
+	{
+		//short rows first, so that every tail length is covered
+		nPixels = Math::Min((first < 4096) ? (first % 70) + 1 : c_rowLength, c_nCombinations - first);
+		for(uint32 i = 0; i < nPixels; i++)
+		{
+			const uint32 combination = first + i;
+			input[i] = uint8(combination >> 16);
+			input[c_rowLength + i] = uint8(combination >> 8);
+			input[2 * c_rowLength + i] = uint8(combination);
+		}
+
+		scalar(&input[0], &input[c_rowLength], &input[2 * c_rowLength], &expected[0], &expected[c_rowLength], &expected[2 * c_rowLength], nPixels);
+		dispatched(&input[0], &input[c_rowLength], &input[2 * c_rowLength], &converted[0], &converted[c_rowLength], &converted[2 * c_rowLength], nPixels);
+		for(uint32 plane = 0; plane < 3; plane++)
+		{
+			if(memcmp(&expected[plane * c_rowLength], &converted[plane * c_rowLength], nPixels) != 0)
+				return false;
+		}
+	}
+	return true;
+}
+
+//Functions
+void CheckPixelConversionKernels()
+{
+	const PixelConversionKernels& scalar = PixelConversionKernels::GetScalar();
+	const PixelConversionKernels& dispatched = PixelConversionKernels::Get();
+
+	CHECK(IsBitExact(scalar.rgbToYCbCr, dispatched.rgbToYCbCr));
+	CHECK(IsBitExact(scalar.yCbCrToRgb, dispatched.yCbCrToRgb));
+
+	//black and white are at the limits of the limited range and survive the round trip
+	const uint8 r[] = { 0, 255 }, g[] = { 0, 255 }, b[] = { 0, 255 };
+	uint8 y[2], cb[2], cr[2];
+	scalar.rgbToYCbCr(r, g, b, y, cb, cr, 2);
+	CHECK((y[0] == 16) && (cb[0] == 128) && (cr[0] == 128));
+	CHECK((y[1] == 235) && (cb[1] == 128) && (cr[1] == 128));
+
+	uint8 red[2], green[2], blue[2];
+	scalar.yCbCrToRgb(y, cb, cr, red, green, blue, 2);
+	CHECK((red[0] == 0) && (green[0] == 0) && (blue[0] == 0));
+	CHECK((red[1] == 255) && (green[1] == 255) && (blue[1] == 255));
+}
\ No newline at end of file
@@ -0,0 +1,83 @@
+/*
+ * Copyright (c) 2023-2024 Amir Czwink (amir130@hotmail.de)
+ *
+ * This file is part of AVTools.
+ *
+ * AVTools is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * AVTools is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with AVTools.  If not, see <http://www.gnu.org/licenses/>.
+ */
+//Local
+#include "Checks.hpp"
+#include "../PortQueue.hpp"
+
+//Local functions
+/**
+ * Pops the next entity and compares it with entity nextExpected, see PushAndPop
+ */
+static bool PopNext(PortQueue<uint32>& queue, uint32& nextExpected, uint64& nQueuedBytes)
+{
+	bool same = (queue.Peek() == nextExpected);
+
+	uint32 data;
+	uint64 size = queue.Pop(data);
+	same = same && (data == nextExpected) && (size == nextExpected + 1);
+	nQueuedBytes -= size;
+	nextExpected++;
+
+	return same;
+}
+
+/**
+ * Pushes nEntities entities, popping one after every popInterval pushes, then drains the queue. Entity i is i with a size of i + 1.
+ * @return true if every entity came out in order with its size
+ */
+static bool PushAndPop(PortQueue<uint32>& queue, uint32 nEntities, uint32 popInterval)
+{
+	bool inOrder = true;
+	uint32 nextExpected = 0;
+	uint64 nQueuedBytes = 0;
+
+	for(uint32 i = 0; i < nEntities; i++)
+	{
+		uint32 data = i;
+		queue.Push(Move(data), i + 1);
+		nQueuedBytes += i + 1;
+		if((i % popInterval) == popInterval - 1)
+			inOrder = PopNext(queue, nextExpected, nQueuedBytes) && inOrder;
+		inOrder = inOrder && (queue.GetNumberOfQueuedBytes() == nQueuedBytes) && (queue.GetNumberOfElements() == i + 1 - nextExpected);
+	}
+	while(!queue.IsEmpty())
+		inOrder = PopNext(queue, nextExpected, nQueuedBytes) && inOrder;
+
+	return inOrder && (nextExpected == nEntities) && (queue.GetNumberOfQueuedBytes() == 0);
+}
+
+//Functions
+void CheckPortQueue()
+{
+	//fits into the ring
+	PortQueue<uint32> queue(4);
+	CHECK(PushAndPop(queue, 4, 1000));
+	CHECK(queue.GetHighWaterMark() == 4);
+
+	//overflows, and the overflow ring grows several times. The same queue is used again afterwards
+	CHECK(PushAndPop(queue, 100, 1000));
+	CHECK(queue.GetHighWaterMark() == 100);
+	CHECK(PushAndPop(queue, 100, 1000));
+
+	//the consumer drains the ring while the producer still has to append to the overflow ring
+	PortQueue<uint32> interleaved(4);
+	CHECK(PushAndPop(interleaved, 1000, 3));
+	CHECK(PushAndPop(interleaved, 1000, 2));
+	CHECK(PushAndPop(interleaved, 1000, 1));
+}
\ No newline at end of file
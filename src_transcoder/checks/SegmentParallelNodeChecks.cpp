@@ -0,0 +1,180 @@
+/*
+ * Copyright (c) 2023-2024 Amir Czwink (amir130@hotmail.de)
+ *
+ * This file is part of AVTools.
+ *
+ * AVTools is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * AVTools is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with AVTools.  If not, see <http://www.gnu.org/licenses/>.
+ */
+//Local
+#include "Checks.hpp"
+#include "CheckNodes.hpp"
+#include "../FilterGraph.hpp"
+#include "../SegmentParallelNode.hpp"
+
+//Local classes
+/**
+ * If holdBack is true, every entity is held back until its segment is finished, like an encoder whose lookahead is as long as the segment.
+ * Else every entity is passed through right away.
+ */
+class BufferingSegmentNode : public SegmentParallelNode
+{
+public:
+	//Constructor
+	inline BufferingSegmentNode(const DecodingParameters& parameters, uint32 nThreads, uint32 segmentLength, bool holdBack)
+		: SegmentParallelNode(nThreads), parameters(parameters), segmentLength(segmentLength), holdBack(holdBack)
+	{
+		this->outputPorts.Resize(1);
+		this->bufferedEntities.Resize(nThreads);
+	}
+
+	//Methods
+	String GetName() const override
+	{
+		return u8"BufferingSegmentNode";
+	}
+
+	PortFormat GetInputFormat(uint32 inputPortNumber) const override
+	{
+		return {
+			.packetsOrFrames = false,
+			.frameParameters = this->parameters,
+		};
+	}
+
+	PortFormat GetOutputFormat(uint32 outputPortNumber) const override
+	{
+		return this->GetInputFormat(0);
+	}
+
+protected:
+	//Methods
+	void FinishSegment(uint32 workerIndex, LinkedList<NodeData>& output) override
+	{
+		LinkedList<NodeData>& buffered = this->bufferedEntities[workerIndex];
+		while(!buffered.IsEmpty())
+			output.InsertTail(buffered.PopFront());
+	}
+
+	void ProcessSegmentEntity(uint32 workerIndex, NodeData&& data, LinkedList<NodeData>& output) override
+	{
+		if(this->holdBack)
+			this->bufferedEntities[workerIndex].InsertTail(Move(data));
+		else
+			output.InsertTail(Move(data));
+	}
+
+	bool StartsNewSegment(const NodeData& data, uint32 nSegmentEntities) const override
+	{
+		return nSegmentEntities >= this->segmentLength;
+	}
+
+private:
+	//Members
+	DecodingParameters parameters;
+	uint32 segmentLength;
+	bool holdBack;
+	DynamicArray<LinkedList<NodeData>> bufferedEntities;
+};
+
+//Local functions
+/**
+ * Order in which the merging node must receive the frames of CheckSegmentOrder, regardless of scheduling
+ */
+static DynamicArray<uint64> ComputeExpectedOrder(uint32 nFrames, uint32 segmentLength, bool holdBack)
+{
+	DynamicArray<uint64> order;
+	if(!holdBack)
+	{
+		//the output of each entity takes its place
+		for(uint64 pts = 0; pts < nFrames; pts++)
+			order.Push(pts);
+		return order;
+	}
+
+	//a held back segment takes the place of the entity that starts the next segment. The last one comes after everything else
+	uint64 segmentStart = 0;
+	for(uint64 pts = 0; pts < nFrames; pts++)
+	{
+		if((pts % 2) == 1)
+		{
+			order.Push(pts);
+			continue;
+		}
+
+		if((pts / 2 != 0) && ((pts / 2) % segmentLength == 0))
+		{
+			for(; segmentStart < pts; segmentStart += 2)
+				order.Push(segmentStart);
+		}
+	}
+	for(; segmentStart < nFrames; segmentStart += 2)
+		order.Push(segmentStart);
+
+	return order;
+}
+
+/**
+ * Every second frame goes through the segment node, the others bypass it to the same merging node
+ */
+static void CheckSegmentOrder(uint32 segmentLength, uint32 nWorkers, bool holdBack, uint32 nThreads)
+{
+	const uint32 c_nFrames = 3000;
+
+	DecodingParameters parameters;
+	parameters.dataType = DataType::Audio;
+	parameters.audio.sampleRate = 48000;
+	parameters.audio.sampleFormat = AudioSampleFormat(1, AudioSampleType::Float, true);
+
+	FilterGraph filterGraph;
+	FrameSourceNode* sourceNode = new FrameSourceNode(parameters, c_nFrames, 2);
+	BufferingSegmentNode* segmentNode = new BufferingSegmentNode(parameters, nWorkers, segmentLength, holdBack);
+	FrameCollectorNode* collectorNode = new FrameCollectorNode(parameters);
+	filterGraph.AddNode(sourceNode);
+	filterGraph.AddNode(segmentNode);
+	filterGraph.AddNode(collectorNode);
+	sourceNode->ConnectOutputPortTo(0, segmentNode, 0);
+	segmentNode->ConnectOutputPortTo(0, collectorNode, 0);
+	sourceNode->ConnectOutputPortTo(1, collectorNode, 1);
+
+	//segments are longer than the ports, so this must not require the merging node to pass them before they were emitted
+	if(nThreads > 1)
+		filterGraph.RunParallel(nThreads);
+	else
+		filterGraph.Run();
+
+	const DynamicArray<uint64>& timestamps = collectorNode->timestamps;
+	DynamicArray<uint64> expected = ComputeExpectedOrder(c_nFrames, segmentLength, holdBack);
+	CHECK(timestamps.GetNumberOfElements() == expected.GetNumberOfElements());
+
+	bool sameOrder = true;
+	for(uint32 i = 0; i < Math::Min(timestamps.GetNumberOfElements(), expected.GetNumberOfElements()); i++)
+		sameOrder = sameOrder && (timestamps[i] == expected[i]);
+	CHECK(sameOrder);
+}
+
+//Functions
+void CheckSegmentParallelNode()
+{
+	for(uint32 segmentLength : {4, 100, 250})
+	{
+		for(uint32 nWorkers : {1, 4})
+		{
+			for(bool holdBack : {false, true})
+			{
+				CheckSegmentOrder(segmentLength, nWorkers, holdBack, 1);
+				CheckSegmentOrder(segmentLength, nWorkers, holdBack, 3);
+			}
+		}
+	}
+}
\ No newline at end of file
@@ -0,0 +1,283 @@
+/*
+ * Copyright (c) 2023-2024 Amir Czwink (amir130@hotmail.de)
+ *
+ * This file is part of AVTools.
+ *
+ * AVTools is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * AVTools is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with AVTools.  If not, see <http://www.gnu.org/licenses/>.
+ */
+//Local
+#include "Checks.hpp"
+#include "../FilterGraph.hpp"
+#include "../SinkNode.hpp"
+#include "../SourceNode.hpp"
+
+//Constants
+static const uint32 c_nSourceStreams = 3;
+static const uint32 c_nPackets = 600;
+
+//Local classes
+/**
+ * Reads c_nPackets packets round robin from its streams. Packet i belongs to stream i % c_nSourceStreams and its payload is i.
+ */
+class ScriptedDemuxer : public Demuxer
+{
+public:
+	//Members
+	/**
+	 * Where the payload of each packet was put
+	 */
+	DynamicArray<const uint8*> payloadAddresses;
+
+	//Constructor
+	inline ScriptedDemuxer(const ContainerFormat& format, SeekableInputStream& inputStream) : Demuxer(format, inputStream)
+	{
+		for(uint32 i = 0; i < c_nSourceStreams; i++)
+			this->AddStream(new Stream(DataType::Audio));
+		this->nReadPackets = 0;
+	}
+
+	//Methods
+	void ReadHeader() override
+	{
+	}
+
+	UniquePointer<IPacket> ReadFrame() override
+	{
+		if(this->nReadPackets == c_nPackets)
+			return nullptr;
+
+		const uint32 index = this->nReadPackets++;
+		Packet* packet = new Packet;
+		packet->Allocate(sizeof(index));
+		MemCopy(packet->GetData(), &index, sizeof(index));
+		packet->streamIndex = index % c_nSourceStreams;
+		packet->pts = index / c_nSourceStreams;
+		packet->containsKeyframe = true;
+		this->payloadAddresses.Push(packet->GetData());
+		return packet;
+	}
+
+private:
+	//State
+	uint32 nReadPackets;
+};
+
+/**
+ * Records the stream index and payload of every packet that it gets
+ */
+class RecordingMuxer : public Muxer
+{
+public:
+	//Members
+	DynamicArray<uint32> streamIndices;
+	DynamicArray<uint32> payloads;
+	DynamicArray<const uint8*> payloadAddresses;
+	uint32 nHeadersWritten;
+	/**
+	 * Number of packets that were written when the muxer was finalized, Unsigned<uint32>::Max() if it wasn't
+	 */
+	uint32 nPacketsBeforeFinalize;
+
+	//Constructor
+	inline RecordingMuxer(const ContainerFormat& format, SeekableOutputStream& outputStream) : Muxer(format, outputStream)
+	{
+		this->nHeadersWritten = 0;
+		this->nPacketsBeforeFinalize = Unsigned<uint32>::Max();
+	}
+
+	//Methods
+	void Finalize() override
+	{
+		this->nPacketsBeforeFinalize = this->payloads.GetNumberOfElements();
+	}
+
+	void WriteHeader() override
+	{
+		this->nHeadersWritten++;
+	}
+
+	void WritePacket(const IPacket& packet) override
+	{
+		uint32 payload;
+		MemCopy(&payload, packet.GetData(), sizeof(payload));
+
+		this->streamIndices.Push(packet.GetStreamIndex());
+		this->payloads.Push(payload);
+		this->payloadAddresses.Push(packet.GetData());
+	}
+};
+
+class NullOutputStream : public SeekableOutputStream
+{
+public:
+	//Methods
+	void Flush() override
+	{
+	}
+
+	uint64 QueryCurrentOffset() const override
+	{
+		return 0;
+	}
+
+	void SeekTo(uint64 offset) override
+	{
+	}
+
+	uint32 WriteBytes(const void* source, uint32 size) override
+	{
+		return size;
+	}
+};
+
+//Local types
+struct CopyResult
+{
+	DynamicArray<uint32> streamIndices;
+	DynamicArray<uint32> payloads;
+	/**
+	 * Whether the muxer got every packet payload at the address where the demuxer put it, i.e. nothing was copied
+	 */
+	bool payloadsShared;
+	uint32 nHeadersWritten;
+	uint32 nPacketsBeforeFinalize;
+	NodeStatistics sourceStatistics;
+	NodeStatistics sinkStatistics;
+};
+
+//Local functions
+/**
+ * Copies the selected source streams into the muxer, either through the graph or with the source connected directly to the sink.
+ * The k-th selected stream becomes stream k of the muxer.
+ */
+static CopyResult CopyStreams(const DynamicArray<uint32>& selectedStreams, bool direct, uint32 nThreads)
+{
+	const ContainerFormat& format = *FormatRegistry::Instance().FindFormatByFileExtension(u8"mkv");
+	BufferInputStream inputStream(nullptr, 0);
+	NullOutputStream* outputStream = new NullOutputStream;
+	RecordingMuxer* muxer = new RecordingMuxer(format, *outputStream);
+
+	FilterGraph filterGraph;
+	ScriptedDemuxer* demuxer = new ScriptedDemuxer(format, inputStream);
+	SourceNode* sourceNode = new SourceNode(nullptr, demuxer);
+	SinkNode* sinkNode = new SinkNode(&format, outputStream, muxer);
+	filterGraph.AddNode(sourceNode);
+	filterGraph.AddNode(sinkNode);
+
+	BinaryTreeSet<uint32> sourceStreamIndices;
+	BinaryTreeMap<uint32, uint32> muxerStreamIndices;
+	for(uint32 i = 0; i < selectedStreams.GetNumberOfElements(); i++)
+	{
+		muxer->AddStream(new Stream(DataType::Audio));
+		sourceStreamIndices.Insert(selectedStreams[i]);
+		muxerStreamIndices[selectedStreams[i]] = i;
+		if(!direct)
+			sourceNode->ConnectOutputPortTo(selectedStreams[i], sinkNode, i);
+	}
+	sourceNode->SelectStreams(sourceStreamIndices);
+	if(direct)
+		sourceNode->ConnectDirectly(sinkNode, muxerStreamIndices);
+
+	if(nThreads > 1)
+		filterGraph.RunParallel(nThreads);
+	else
+		filterGraph.Run();
+
+	CopyResult result;
+	result.streamIndices = muxer->streamIndices;
+	result.payloads = muxer->payloads;
+	result.payloadsShared = true;
+	for(uint32 i = 0; i < muxer->payloads.GetNumberOfElements(); i++)
+		result.payloadsShared = result.payloadsShared && (muxer->payloadAddresses[i] == demuxer->payloadAddresses[muxer->payloads[i]]);
+	result.nHeadersWritten = muxer->nHeadersWritten;
+	result.nPacketsBeforeFinalize = muxer->nPacketsBeforeFinalize;
+	result.sourceStatistics = sourceNode->GetStatistics();
+	result.sinkStatistics = sinkNode->GetStatistics();
+	return result;
+}
+
+/**
+ * Packets must reach the muxer in the order in which they were read, with the index of the muxer stream instead of the source stream
+ */
+static void CheckStreamIndexMapping(const DynamicArray<uint32>& selectedStreams, bool direct, uint32 nThreads)
+{
+	DynamicArray<uint32> expectedStreamIndices, expectedPayloads;
+	for(uint32 i = 0; i < c_nPackets; i++)
+	{
+		for(uint32 k = 0; k < selectedStreams.GetNumberOfElements(); k++)
+		{
+			if(selectedStreams[k] == (i % c_nSourceStreams))
+			{
+				expectedStreamIndices.Push(k);
+				expectedPayloads.Push(i);
+			}
+		}
+	}
+
+	CopyResult result = CopyStreams(selectedStreams, direct, nThreads);
+	CHECK(result.payloads.GetNumberOfElements() == expectedPayloads.GetNumberOfElements());
+
+	bool same = true;
+	for(uint32 i = 0; i < Math::Min(result.payloads.GetNumberOfElements(), expectedPayloads.GetNumberOfElements()); i++)
+		same = same && (result.streamIndices[i] == expectedStreamIndices[i]) && (result.payloads[i] == expectedPayloads[i]);
+	CHECK(same);
+}
+
+/**
+ * With the source connected directly, every packet must be written by reference, exactly once, in the order in which it was read,
+ * between a single header and the finalization
+ */
+static void CheckDirectStreamCopy(uint32 nThreads)
+{
+	DynamicArray<uint32> allStreams;
+	for(uint32 i = 0; i < c_nSourceStreams; i++)
+		allStreams.Push(i);
+
+	CopyResult result = CopyStreams(allStreams, true, nThreads);
+	CHECK(result.payloads.GetNumberOfElements() == c_nPackets);
+
+	bool inOrder = true;
+	for(uint32 i = 0; i < result.payloads.GetNumberOfElements(); i++)
+		inOrder = inOrder && (result.payloads[i] == i) && (result.streamIndices[i] == (i % c_nSourceStreams));
+	CHECK(inOrder);
+	CHECK(result.payloadsShared);
+
+	CHECK(result.nHeadersWritten == 1);
+	CHECK(result.nPacketsBeforeFinalize == c_nPackets);
+
+	//the packets never entered a queue, but are still counted on both ends
+	CHECK(result.sourceStatistics.nEntitiesOut == c_nPackets);
+	CHECK(result.sinkStatistics.nEntitiesIn == c_nPackets);
+	CHECK(result.sinkStatistics.nBytesIn == c_nPackets * sizeof(uint32));
+}
+
+//Functions
+void CheckSinkNode()
+{
+	//like --map 0:2, and two streams of which the second one moves down
+	DynamicArray<uint32> lastStream, outerStreams;
+	lastStream.Push(2);
+	outerStreams.Push(0);
+	outerStreams.Push(2);
+
+	for(bool direct : {false, true})
+	{
+		CheckStreamIndexMapping(lastStream, direct, 1);
+		CheckStreamIndexMapping(outerStreams, direct, 1);
+		CheckStreamIndexMapping(outerStreams, direct, 3);
+	}
+
+	CheckDirectStreamCopy(1);
+	CheckDirectStreamCopy(3);
+}
\ No newline at end of file
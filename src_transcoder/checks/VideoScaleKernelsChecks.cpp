@@ -0,0 +1,79 @@
+/*
+ * Copyright (c) 2023-2024 Amir Czwink (amir130@hotmail.de)
+ *
+ * This file is part of AVTools.
+ *
+ * AVTools is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * AVTools is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with AVTools.  If not, see <http://www.gnu.org/licenses/>.
+ */
+//Global
+#include <cmath>
+#include <cstring>
+//Local
+#include "Checks.hpp"
+#include "../VideoScaleKernels.hpp"
+
+//Local functions
+/**
+ * The dispatched kernel must produce the same bits as the scalar one, for every number of taps and all tails
+ */
+static void CheckFilterRow()
+{
+	const VideoScaleKernels& scalar = VideoScaleKernels::GetScalar();
+	const VideoScaleKernels& dispatched = VideoScaleKernels::Get();
+	const uint32 targetLengths[] = { 1, 3, 4, 7, 8, 9, 15, 17, 640, 1283 };
+
+	bool isBitExact = true;
+	for(uint32 nTaps = 1; nTaps <= 24; nTaps++)
+	{
+		for(uint32 nTargetSamples : targetLengths)
+		{
+			const uint32 nSourceSamples = 2 * nTargetSamples + nTaps;
+
+			DynamicArray<float32> source, weights, expected, filtered;
+			DynamicArray<uint32> offsets;
+			source.Resize(nSourceSamples);
+			weights.Resize(nTaps * nTargetSamples);
+			offsets.Resize(nTargetSamples);
+			expected.Resize(nTargetSamples);
+			filtered.Resize(nTargetSamples);
+
+			for(uint32 i = 0; i < nSourceSamples; i++)
+				source[i] = float32(127.5 + 127.5 * sin(i * 0.37));
+			for(uint32 i = 0; i < weights.GetNumberOfElements(); i++)
+				weights[i] = float32(cos(i * 0.11) - 0.3);
+			//a downscale by two, the last taps end at the last source sample
+			for(uint32 i = 0; i < nTargetSamples; i++)
+				offsets[i] = (i * (nSourceSamples - nTaps)) / nTargetSamples;
+
+			scalar.filterRow(&source[0], &offsets[0], &weights[0], nTaps, &expected[0], nTargetSamples);
+			dispatched.filterRow(&source[0], &offsets[0], &weights[0], nTaps, &filtered[0], nTargetSamples);
+			isBitExact = isBitExact && (memcmp(&expected[0], &filtered[0], nTargetSamples * sizeof(float32)) == 0);
+		}
+	}
+	CHECK(isBitExact);
+
+	//two outputs with two taps each, the weights are stored tap by tap
+	const float32 source[] = { 1, 2, 3, 4 };
+	const uint32 offsets[] = { 0, 2 };
+	const float32 weights[] = { 0.5f, 0.25f, 2, 4 };
+	float32 target[2];
+	scalar.filterRow(source, offsets, weights, 2, target, 2);
+	CHECK((target[0] == 0.5f * 1 + 2 * 2) && (target[1] == 0.25f * 3 + 4 * 4));
+}
+
+//Functions
+void CheckVideoScaleKernels()
+{
+	CheckFilterRow();
+}
\ No newline at end of file
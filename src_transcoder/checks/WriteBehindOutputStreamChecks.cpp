@@ -0,0 +1,163 @@
+/*
+ * Copyright (c) 2023-2024 Amir Czwink (amir130@hotmail.de)
+ *
+ * This file is part of AVTools.
+ *
+ * AVTools is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * AVTools is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with AVTools.  If not, see <http://www.gnu.org/licenses/>.
+ */
+//Global
+#include <cstring>
+//Local
+#include "Checks.hpp"
+#include "../WriteBehindOutputStream.hpp"
+
+//Local classes
+/**
+ * Keeps everything in memory and remembers where each write started and how long it was
+ */
+class MemoryOutputStream : public SeekableOutputStream
+{
+public:
+	//Members
+	DynamicArray<uint8> data;
+	DynamicArray<uint64> writeOffsets;
+	DynamicArray<uint32> writeSizes;
+	uint32 nFlushes;
+
+	//Constructor
+	inline MemoryOutputStream()
+	{
+		this->offset = 0;
+		this->nFlushes = 0;
+	}
+
+	//Methods
+	void Flush() override
+	{
+		this->nFlushes++;
+	}
+
+	uint64 QueryCurrentOffset() const override
+	{
+		return this->offset;
+	}
+
+	void SeekTo(uint64 offset) override
+	{
+		this->offset = offset;
+	}
+
+	uint32 WriteBytes(const void* source, uint32 size) override
+	{
+		this->writeOffsets.Push(this->offset);
+		this->writeSizes.Push(size);
+
+		if(this->offset + size > this->data.GetNumberOfElements())
+			this->data.Resize(uint32(this->offset + size));
+		MemCopy(&this->data[uint32(this->offset)], source, size);
+		this->offset += size;
+		return size;
+	}
+
+private:
+	//State
+	uint64 offset;
+};
+
+//Local functions
+static inline bool HaveSameContent(const MemoryOutputStream& a, const MemoryOutputStream& b)
+{
+	return (a.data.GetNumberOfElements() == b.data.GetNumberOfElements()) && (memcmp(&a.data[0], &b.data[0], a.data.GetNumberOfElements()) == 0);
+}
+
+static void CheckAlignedChunks()
+{
+	const uint32 c_chunkSize = 4096;
+
+	MemoryOutputStream* target = new MemoryOutputStream;
+	WriteBehindOutputStream stream(target, c_chunkSize, 4);
+
+	uint8 buffer[1000];
+	for(uint32 i = 0; i < sizeof(buffer); i++)
+		buffer[i] = uint8(i);
+	for(uint32 i = 0; i < 100; i++)
+		stream.WriteBytes(buffer, 1 + (i * 37) % sizeof(buffer));
+	stream.Flush();
+
+	//sequential output reaches the target in full chunks at multiples of the chunk size, only the last one may be shorter
+	const uint32 nWrites = target->writeSizes.GetNumberOfElements();
+	bool isAligned = nWrites > 1;
+	for(uint32 i = 0; i < nWrites; i++)
+	{
+		isAligned = isAligned && (target->writeOffsets[i] == uint64(i) * c_chunkSize);
+		if(i + 1 < nWrites)
+			isAligned = isAligned && (target->writeSizes[i] == c_chunkSize);
+	}
+	CHECK(isAligned);
+	CHECK(target->nFlushes == 1);
+	CHECK(stream.QueryCurrentOffset() == target->data.GetNumberOfElements());
+}
+
+/**
+ * Random writes, seeks back into already written data (like a muxer patching its header) and flushes
+ * must leave exactly the same bytes as writing straight to the target
+ */
+static void CheckSeekBacks()
+{
+	MemoryOutputStream expected;
+	MemoryOutputStream* target = new MemoryOutputStream;
+	WriteBehindOutputStream stream(target, 4096, 3);
+
+	uint8 buffer[10000];
+	uint32 random = 12345;
+	bool offsetsMatch = true, contentMatches = true;
+	for(uint32 i = 0; i < 2000; i++)
+	{
+		random = random * 1103515245 + 12345;
+		const uint32 operation = (random >> 16) % 10;
+		if(operation < 7)
+		{
+			const uint32 size = 1 + (random >> 8) % sizeof(buffer);
+			for(uint32 j = 0; j < size; j++)
+				buffer[j] = uint8(i + j);
+			stream.WriteBytes(buffer, size);
+			expected.WriteBytes(buffer, size);
+		}
+		else if(operation < 9)
+		{
+			const uint64 end = expected.data.GetNumberOfElements();
+			const uint64 offset = (end == 0) ? 0 : (end - 1 - (random >> 4) % Math::Min(end, uint64(20000)));
+			stream.SeekTo(offset);
+			expected.SeekTo(offset);
+		}
+		else
+		{
+			stream.Flush();
+			contentMatches = contentMatches && HaveSameContent(expected, *target);
+		}
+		offsetsMatch = offsetsMatch && (stream.QueryCurrentOffset() == expected.QueryCurrentOffset());
+	}
+	stream.Flush();
+
+	CHECK(offsetsMatch);
+	CHECK(contentMatches);
+	CHECK(HaveSameContent(expected, *target));
+}
+
+//Functions
+void CheckWriteBehindOutputStream()
+{
+	CheckAlignedChunks();
+	CheckSeekBacks();
+}
\ No newline at end of file
@@ -17,68 +17,80 @@
  * along with AVTools.  If not, see <http://www.gnu.org/licenses/>.
  */
 //Local
-#include "SinkNode.hpp"
-#include "SourceNode.hpp"
-#include "FilterGraph.hpp"
-#include "FilterGraphBuilder.hpp"
-
-static bool ParseAudioFilter(const String& filter, FilterGraphBuilder& builder, const BinaryTreeMap<String, CodingFormatId>& codecStringMap)
-{
-	if(filter == u8"decode")
-	{
-		builder.InsertDecoder(DataType::Audio);
-	}
-	else if(filter.StartsWith(u8"encode="))
-	{
-		String codec = filter.SubString(7);
-		builder.InsertEncoder(DataType::Audio, codecStringMap.Get(codec));
-	}
-	else
-		return false;
-	return true;
-}
-
-static bool ParseFilters(const FixedArray<String>& args, FilterGraphBuilder& builder, const BinaryTreeMap<String, CodingFormatId>& codecStringMap)
-{
-	for(uint32 i = 1; i < args.GetNumberOfElements() - 1; i++)
-	{
-		const auto& arg = args[i];
-
-		if(arg == u8"--f:a")
-		{
-			if(!ParseAudioFilter(args[i+1], builder, codecStringMap))
-				return false;
-			i++;
-		}
-	}
-
-	return true;
-}
+#include "BatchTranscoder.hpp"
+#include "Transcoder.hpp"
 
 static void PrintManual()
 {
 	stdOut
 			<< u8"Usage: " << endl
-			<< u8"  transcoder" << " inputFile outputFile" << endl << endl;
+			<< u8"  transcoder" << " inputFile [options] outputFile" << endl
+			<< u8"  transcoder" << " inputFile [options] --tee [filters] outputFile [--tee [filters] outputFile]..." << endl
+			<< u8"  transcoder" << " --batch manifestFile [--jobs N]" << endl << endl
+			<< u8"Options:" << endl
+			<< u8"  --end time\t\tstop transcoding at time, given as [[hh:]mm:]ss[.fraction]" << endl
+			<< u8"  --explain\t\tprint the filter graph before and after it was optimized (identity nodes removed, adjacent conversions fused, reencoding to the same format replaced by stream copy)" << endl
+			<< u8"  --f:a filter\t\tadd an audio filter (decode, encode=codec, rate=sampleRate, remix=channels[:weights])" << endl
+			<< u8"  --f:v filter\t\tadd a video filter (decode, decode=threads, encode=codec[:threads], format=pixelFormat[:threads], scale=WxH[:kernel[:threads]])" << endl
+			<< u8"  --map 0:N\t\ttranscode stream N of the input, can be repeated once per stream type (default: the first stream of each type). All other streams are dropped right after reading" << endl
+			<< u8"  --mmap\t\t\tread the input file through a memory mapping, pipes and special files are read as usual" << endl
+			<< u8"  --queue-bytes N\tlimit every port queue to N bytes, 0 for unlimited (default: 64 MiB). The limit is global, ports can't be configured individually" << endl
+			<< u8"  --queue-entities N\tlimit every port queue to N packets or frames, 0 for unlimited (default: 64). The limit is global, ports can't be configured individually" << endl
+			<< u8"  --read-ahead N\tprefetch the input on a background thread into a window of N bytes, 0 to read synchronously (default: 0)" << endl
+			<< u8"  --start time\t\tstart transcoding at time, given as [[hh:]mm:]ss[.fraction]. The output begins with the preceding keyframe" << endl
+			<< u8"  --stats\t\tprint per node statistics and the peak amount of queued data (not the memory usage of the process) after transcoding" << endl
+			<< u8"  --stats-json path\twrite per node statistics as JSON to path" << endl
+			<< u8"  --trace path\t\twrite a timeline of the run in the Chrome trace-event format to path" << endl
+			<< u8"  --threads N\t\trun the filter graph on N worker threads (default: 1)" << endl
+			<< u8"  --write-behind N\twrite the output on a background thread in chunks, buffering up to N bytes, 0 to write synchronously (default: 0)" << endl << endl
+			<< u8"Multiple outputs:" << endl
+			<< u8"  Filters in front of the first --tee run once, their output is shared by all outputs (e.g. decode once, encode several times)." << endl
+			<< u8"  Every --tee starts a branch with its own filters that ends with its output file." << endl << endl
+			<< u8"Pixel formats: bgr24, rgb24, yuv420p, yuv422p, yuv444p" << endl
+			<< u8"Scaling kernels: bilinear, bicubic (default), lanczos" << endl << endl
+			<< u8"Batch mode:" << endl
+			<< u8"  Every line of the manifest describes one job as tab separated fields: inputFile [options] outputFile" << endl
+			<< u8"  --jobs N\t\ttranscode N jobs concurrently (default: 1)" << endl << endl;
 }
 
 int32 Main(const String& programName, const FixedArray<String>& args)
 {
     PrintManual();
 
-    BinaryTreeMap<String, CodingFormatId> codecStringMap;
-    codecStringMap.Insert(u8"pcm_f32le", CodingFormatId::PCM_Float32LE);
+    if((args.GetNumberOfElements() >= 2) && (args[0] == u8"--batch"))
+    {
+    	uint32 nConcurrentJobs = 1;
+    	for(uint32 i = 2; i < args.GetNumberOfElements(); i++)
+    	{
+    		if((args[i] == u8"--jobs") && (i + 1 < args.GetNumberOfElements()))
+    		{
+    			nConcurrentJobs = args[i+1].ToUInt32();
+    			i++;
+    		}
+    		else
+    		{
+    			stdErr << "Unknown batch option '" << args[i] << "'." << endl;
+    			return EXIT_FAILURE;
+    		}
+    	}
+    	if(nConcurrentJobs == 0)
+    	{
+    		stdErr << "--jobs needs a number of jobs greater than zero." << endl;
+    		return EXIT_FAILURE;
+    	}
 
-    FilterGraph filterGraph;
-	FilterGraphBuilder builder(filterGraph);
+    	BatchTranscoder batchTranscoder;
+    	if(!batchTranscoder.LoadManifest(args[1]))
+    		return EXIT_FAILURE;
+    	batchTranscoder.Run(nConcurrentJobs);
+    	batchTranscoder.PrintReport();
+    	return EXIT_SUCCESS;
+    }
 
-	if(!builder.LoadSource(args[0]))
-	    return EXIT_FAILURE;
-	if(!ParseFilters(args, builder, codecStringMap))
-		return EXIT_FAILURE;
-    if(!builder.LoadSink(args[args.GetNumberOfElements() - 1]))
-        return EXIT_FAILURE;
+    TranscoderOptions options;
+    if(!ParseOptions(args, options))
+    	return EXIT_FAILURE;
 
-	filterGraph.Run();
-	return EXIT_SUCCESS;
+	TranscodingResult result = Transcode(args, options, true);
+	return result.succeeded ? EXIT_SUCCESS : EXIT_FAILURE;
 }
\ No newline at end of file